@@ -51,6 +51,9 @@ struct GA_auth_handler;
 /** A notification handler */
 typedef void (*GA_notification_handler)(void* context, GA_json* details);
 
+/** A batch notification handler */
+typedef void (*GA_batch_notification_handler)(void* context, GA_json* batch);
+
 /**
  * Set the global configuration and run one-time initialization code. This function must
  * be called once and only once before calling any other functions. When used in a
@@ -376,6 +379,19 @@ GDK_API int GA_get_available_currencies(struct GA_session* session, GA_json** cu
  */
 GDK_API int GA_convert_amount(struct GA_session* session, const GA_json* value_details, GA_json** output);
 
+/**
+ * Convert many satoshi amounts to BTC denominations and fiat in one call.
+ *
+ * The fiat rate is read once and applied to every amount, and only the
+ * requested denominations are returned.
+ *
+ * :param session: The session to use.
+ * :param details: :ref:`convert-amounts` giving the values to convert.
+ * :param output: Destination for the converted values :ref:`convert-amounts-result`.
+ *|     Returned GA_json should be freed using `GA_destroy_json`.
+ */
+GDK_API int GA_convert_amounts(struct GA_session* session, const GA_json* details, GA_json** output);
+
 /**
  * Set a PIN for the user wallet.
  *
@@ -579,6 +595,26 @@ GDK_API int GA_get_settings(struct GA_session* session, GA_json** settings);
  */
 GDK_API int GA_set_notification_handler(struct GA_session* session, GA_notification_handler handler, void* context);
 
+/**
+ * Set a handler to be called with batches of notifications as they arrive.
+ *
+ * :param session: The server session to receive notifications for.
+ * :param handler: The handler to receive :ref:`notification-batch` batches.
+ * :param context: A context pointer to be passed to the handler.
+ *
+ * This function must be called before `GA_connect`. If set, it is used in
+ * place of any handler set with `GA_set_notification_handler`.
+ * Notifications are queued while the handler is running and delivered in
+ * order in the next batch. Superseded block and ticker notifications are
+ * coalesced so that only the newest is delivered, and if the handler falls
+ * too far behind the oldest notifications are dropped. The number of
+ * notifications coalesced or dropped is reported with each batch.
+ * The GA_json object passed to the caller must be destroyed by the caller
+ * using `GA_destroy_json`.
+ */
+GDK_API int GA_set_batch_notification_handler(
+    struct GA_session* session, GA_batch_notification_handler handler, void* context);
+
 GDK_API int GA_convert_json_to_string(const GA_json* json, char** output);
 
 GDK_API int GA_convert_string_to_json(const char* input, GA_json** output);
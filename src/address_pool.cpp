@@ -0,0 +1,90 @@
+#include "address_pool.hpp"
+#include "assertion.hpp"
+
+namespace ga {
+namespace sdk {
+
+    address_pool::address_pool()
+        : m_epoch(0)
+    {
+    }
+
+    uint64_t address_pool::epoch(const key_t& key) const
+    {
+        const auto p = m_type_epochs.find(key.second);
+        return m_epoch + (p == m_type_epochs.end() ? 0 : p->second);
+    }
+
+    nlohmann::json address_pool::take(const key_t& key, uint32_t pool_size, uint32_t& refill_count)
+    {
+        refill_count = 0;
+        auto& pool = m_pools[key];
+        nlohmann::json address;
+        if (!pool.empty()) {
+            address = std::move(pool.front());
+            pool.pop_front();
+        }
+        if (pool.size() <= pool_size / 2 && m_refills.insert(key).second) {
+            refill_count = pool_size - pool.size();
+        }
+        return address;
+    }
+
+    void address_pool::add(const key_t& key, nlohmann::json addresses, uint64_t epoch)
+    {
+        GDK_RUNTIME_ASSERT(addresses.is_array());
+        if (epoch != address_pool::epoch(key)) {
+            return; // Cleared since the addresses were requested
+        }
+        auto& pool = m_pools[key];
+        std::move(addresses.begin(), addresses.end(), std::back_inserter(pool));
+    }
+
+    void address_pool::refill_done(const key_t& key) { m_refills.erase(key); }
+
+    void address_pool::clear(const std::string& addr_type)
+    {
+        for (auto& pool : m_pools) {
+            if (pool.first.second == addr_type) {
+                pool.second.clear();
+            }
+        }
+        ++m_type_epochs[addr_type]; // Discard the results of any refills in progress
+    }
+
+    void address_pool::clear()
+    {
+        m_pools.clear();
+        ++m_epoch; // Discard the results of any refills in progress
+    }
+
+    std::size_t address_pool::size(const key_t& key) const
+    {
+        const auto p = m_pools.find(key);
+        return p == m_pools.end() ? 0 : p->second.size();
+    }
+
+    nlohmann::json address_pool::get_all() const
+    {
+        nlohmann::json ret = nlohmann::json::array();
+        for (const auto& pool : m_pools) {
+            if (!pool.second.empty()) {
+                ret.push_back({ { "subaccount", pool.first.first }, { "address_type", pool.first.second },
+                    { "addresses", nlohmann::json(pool.second) } });
+            }
+        }
+        return ret;
+    }
+
+    void address_pool::restore(const nlohmann::json& saved)
+    {
+        for (const auto& item : saved) {
+            const key_t key{ item.at("subaccount"), item.at("address_type") };
+            const auto& addresses = item.at("addresses");
+            auto& pool = m_pools[key];
+            pool.insert(pool.begin(), addresses.begin(), addresses.end());
+        }
+    }
+
+} // namespace sdk
+} // namespace ga
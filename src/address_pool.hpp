@@ -0,0 +1,72 @@
+#ifndef GDK_ADDRESS_POOL_HPP
+#define GDK_ADDRESS_POOL_HPP
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+namespace ga {
+namespace sdk {
+
+    // Pools of pre-fetched receive addresses, keyed by (subaccount, address type).
+    // Addresses are handed out oldest first, so that pointers are used in the
+    // order the server issued them.
+    // Not thread safe; callers must serialize access.
+    class address_pool {
+    public:
+        using key_t = std::pair<uint32_t, std::string>; // subaccount, address type
+
+        address_pool();
+
+        // Identifies the current contents of the pool for key. Callers must
+        // read this before fetching addresses and pass it to add(), so that
+        // addresses fetched before the pool was cleared are discarded.
+        uint64_t epoch(const key_t& key) const;
+
+        // Remove and return the oldest pooled address, or null if the pool is
+        // empty. If this leaves pool_size / 2 or fewer addresses (including
+        // when the pool was empty) and no refill is in progress, refill_count
+        // is set to the number of addresses to refill with and the caller
+        // must call refill_done() once it finishes. Otherwise refill_count is
+        // set to 0, and a caller finding the pool empty should fetch only the
+        // address it needs.
+        nlohmann::json take(const key_t& key, uint32_t pool_size, uint32_t& refill_count);
+
+        // Append fetched addresses to the pool, unless it was cleared since epoch
+        void add(const key_t& key, nlohmann::json addresses, uint64_t epoch);
+
+        // Mark a refill started by take() as finished, whether or not it succeeded
+        void refill_done(const key_t& key);
+
+        // Discard the pooled addresses of an address type, e.g. when its scripts change
+        void clear(const std::string& addr_type);
+
+        void clear();
+
+        std::size_t size(const key_t& key) const;
+
+        // Return all pooled addresses, for saving and passing to restore() later
+        nlohmann::json get_all() const;
+
+        // Restore addresses returned from get_all(). They are placed before any
+        // already pooled, as they were issued earlier.
+        void restore(const nlohmann::json& saved);
+
+    private:
+        std::map<key_t, std::deque<nlohmann::json>> m_pools;
+        std::set<key_t> m_refills; // Refills in progress
+        std::map<std::string, uint64_t> m_type_epochs; // Incremented when pools of a type are cleared
+        uint64_t m_epoch; // Incremented when all pools are cleared
+    };
+
+} // namespace sdk
+} // namespace ga
+
+#endif
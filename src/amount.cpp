@@ -1,6 +1,9 @@
+#include <algorithm>
+#include <array>
 #include <cctype>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <stdexcept>
 
 #include "boost_wrapper.hpp"
@@ -24,15 +27,159 @@ namespace sdk {
         static constexpr int64_t SATOSHI_MAX = static_cast<int64_t>(WALLY_BTC_MAX) * WALLY_SATOSHI_PER_BTC;
         static const conversion_type COIN_VALUE_100("100");
         static const conversion_type COIN_VALUE_DECIMAL("100000000");
-        static const conversion_type COIN_VALUE_DECIMAL_MBTC("100000");
-        static const conversion_type COIN_VALUE_DECIMAL_UBTC("100");
         static const std::vector<std::string> NON_SATOSHI_KEYS{ "btc", "mbtc", "ubtc", "bits", "sats", "fiat",
             "fiat_currency", "fiat_rate", "is_current" };
 
+        // Denominations that convert_amounts can return
+        enum denomination : uint32_t {
+            DENOM_SATOSHI = 0x1,
+            DENOM_BTC = 0x2,
+            DENOM_MBTC = 0x4,
+            DENOM_UBTC = 0x8,
+            DENOM_BITS = 0x10,
+            DENOM_SATS = 0x20,
+            DENOM_FIAT = 0x40,
+        };
+        static const std::array<std::pair<const char*, uint32_t>, 7> DENOMINATIONS{ { { "satoshi", DENOM_SATOSHI },
+            { "btc", DENOM_BTC }, { "mbtc", DENOM_MBTC }, { "ubtc", DENOM_UBTC }, { "bits", DENOM_BITS },
+            { "sats", DENOM_SATS }, { "fiat", DENOM_FIAT } } };
+
         template <typename T> static std::string fmt(const T& fiat, size_t dp = 2)
         {
             return fiat_type(fiat).str(dp, std::ios_base::fixed | std::ios_base::showpoint);
         }
+
+        // Conversions are performed with integer arithmetic where the inputs
+        // are plain decimal strings and the results fit in 64 bits. Anything
+        // else falls back to multiprecision decimal arithmetic, which gives
+        // identical results for the inputs handled by the integer code.
+        static constexpr uint32_t MAX_DECIMAL_DIGITS = 18;
+
+        static const std::array<uint64_t, 20> POW10 = [] {
+            std::array<uint64_t, 20> pow10;
+            pow10[0] = 1;
+            for (size_t i = 1; i < pow10.size(); ++i) {
+                pow10[i] = pow10[i - 1] * 10;
+            }
+            return pow10;
+        }();
+
+        // A non-negative decimal value of mantissa / 10^dp
+        struct decimal_t {
+            uint64_t mantissa;
+            uint32_t dp;
+        };
+
+        // Parse a plain decimal string such as "123" or "0.0123". Strings
+        // with signs, exponents, whitespace or too many digits are rejected
+        static boost::optional<decimal_t> parse_decimal(const std::string& str)
+        {
+            decimal_t d{ 0, 0 };
+            uint32_t num_digits = 0;
+            bool seen_point = false;
+            for (size_t i = 0; i < str.size(); ++i) {
+                const char c = str[i];
+                if (c == '.') {
+                    if (seen_point || i == 0 || i + 1 == str.size()) {
+                        return boost::none;
+                    }
+                    seen_point = true;
+                } else if (c >= '0' && c <= '9') {
+                    if ((d.mantissa != 0 || c != '0') && ++num_digits > MAX_DECIMAL_DIGITS) {
+                        return boost::none;
+                    }
+                    d.mantissa = d.mantissa * 10 + static_cast<uint64_t>(c - '0');
+                    d.dp += seen_point;
+                } else {
+                    return boost::none;
+                }
+            }
+            if (str.empty() || d.dp > MAX_DECIMAL_DIGITS) {
+                return boost::none;
+            }
+            return d;
+        }
+
+        // Convert a decimal string into units of 10^-unit_dp, truncating
+        static boost::optional<int64_t> decimal_to_units(const std::string& str, uint32_t unit_dp)
+        {
+            const auto d = parse_decimal(str);
+            if (!d || unit_dp > MAX_DECIMAL_DIGITS) {
+                return boost::none;
+            }
+            if (unit_dp < d->dp) {
+                return static_cast<int64_t>(d->mantissa / POW10[d->dp - unit_dp]);
+            }
+            const uint64_t scale = POW10[unit_dp - d->dp];
+            if (d->mantissa > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) / scale) {
+                return boost::none;
+            }
+            return static_cast<int64_t>(d->mantissa * scale);
+        }
+
+        // Format a number of units of 10^-dp with dp decimal places
+        static std::string format_units(uint64_t units, uint32_t dp)
+        {
+            GDK_RUNTIME_ASSERT(dp != 0);
+            std::string str = std::to_string(units);
+            if (str.size() <= dp) {
+                str.insert(0, dp + 1 - str.size(), '0');
+            }
+            str.insert(str.size() - dp, 1, '.');
+            return str;
+        }
+
+        // Compute the fiat value of satoshi in cents, rounding half to even
+        // as multiprecision formatting does
+        static boost::optional<uint64_t> satoshi_to_fiat_cents(uint64_t satoshi, const decimal_t& rate)
+        {
+            // cents = satoshi * rate / 10^6 = satoshi * mantissa / 10^(6 + dp),
+            // computed by splitting satoshi to avoid overflow
+            const uint32_t divisor_dp = 6 + rate.dp;
+            if (divisor_dp >= POW10.size()) {
+                return boost::none;
+            }
+            const uint64_t divisor = POW10[divisor_dp];
+            const uint64_t high = satoshi / divisor;
+            const uint64_t low = satoshi % divisor;
+            const uint64_t max = std::numeric_limits<uint64_t>::max();
+            if (rate.mantissa != 0 && (high > max / rate.mantissa || low > max / rate.mantissa)) {
+                return boost::none;
+            }
+            const uint64_t part = low * rate.mantissa;
+            const uint64_t remainder = part % divisor;
+            uint64_t cents = high * rate.mantissa;
+            if (cents > max - part / divisor - 1) {
+                return boost::none;
+            }
+            cents += part / divisor;
+            if (remainder > divisor - remainder || (remainder == divisor - remainder && cents % 2)) {
+                ++cents;
+            }
+            return cents;
+        }
+
+        static std::string satoshi_to_fiat(
+            int64_t satoshi, const std::string& fiat_rate, const boost::optional<decimal_t>& rate)
+        {
+            const auto cents = rate ? satoshi_to_fiat_cents(satoshi, *rate) : boost::none;
+            if (cents) {
+                return format_units(*cents, 2);
+            }
+            return fmt(fiat_type(conversion_type(fiat_rate) * conversion_type(satoshi) / COIN_VALUE_DECIMAL));
+        }
+
+        static conversion_type pow10_decimal(int precision) { return conversion_type(std::pow(10, precision)); }
+
+        // Convert a decimal string with 'precision' decimal places to satoshi
+        static int64_t units_to_satoshi(const std::string& str, int precision)
+        {
+            const auto units = precision < 0 ? boost::none : decimal_to_units(str, precision);
+            if (units) {
+                return *units;
+            }
+            return (conversion_type(str) * pow10_decimal(precision)).convert_to<amount::value_type>();
+        }
     } // namespace
 
     amount::amount(const nlohmann::json& json_value)
@@ -73,27 +220,22 @@ namespace sdk {
 
         const bool is_current = !fiat_rate.empty() && !fiat_currency.empty();
 
-        const conversion_type COIN_VALUE_WITH_PRECISION(std::pow(10, precision));
         int64_t satoshi;
 
         // Compute satoshi from our input
         if (satoshi_p != end_p) {
             satoshi = *satoshi_p;
         } else if (btc_p != end_p) {
-            const std::string btc_str = *btc_p;
-            satoshi = (conversion_type(btc_str) * COIN_VALUE_DECIMAL).convert_to<value_type>();
+            satoshi = units_to_satoshi(btc_p->get<std::string>(), 8);
         } else if (mbtc_p != end_p) {
-            const std::string mbtc_str = *mbtc_p;
-            satoshi = (conversion_type(mbtc_str) * COIN_VALUE_DECIMAL_MBTC).convert_to<value_type>();
+            satoshi = units_to_satoshi(mbtc_p->get<std::string>(), 5);
         } else if (ubtc_p != end_p || bits_p != end_p) {
             const std::string ubtc_str = *(ubtc_p == end_p ? bits_p : ubtc_p);
-            satoshi = (conversion_type(ubtc_str) * COIN_VALUE_DECIMAL_UBTC).convert_to<value_type>();
+            satoshi = units_to_satoshi(ubtc_str, 2);
         } else if (sats_p != end_p) {
-            const std::string sats_str = *sats_p;
-            satoshi = (conversion_type(sats_str)).convert_to<value_type>();
+            satoshi = units_to_satoshi(sats_p->get<std::string>(), 0);
         } else if (asset_p != end_p) {
-            const std::string asset_str = *asset_p;
-            satoshi = (conversion_type(asset_str) * COIN_VALUE_WITH_PRECISION).convert_to<value_type>();
+            satoshi = units_to_satoshi(asset_p->get<std::string>(), precision);
         } else {
             if (fiat_rate_used.empty()) {
                 throw user_error(res::id_your_favourite_exchange_rate_is);
@@ -113,10 +255,9 @@ namespace sdk {
         }
 
         // Then compute the other denominations and fiat amount
-        const conversion_type satoshi_conv = conversion_type(satoshi);
-        const std::string btc = fmt(btc_type(satoshi_conv / COIN_VALUE_DECIMAL), 8);
-        const std::string mbtc = fmt(btc_type(satoshi_conv / COIN_VALUE_DECIMAL_MBTC), 5);
-        const std::string ubtc = fmt(btc_type(satoshi_conv / COIN_VALUE_DECIMAL_UBTC), 2);
+        const std::string btc = format_units(satoshi, 8);
+        const std::string mbtc = format_units(satoshi, 5);
+        const std::string ubtc = format_units(satoshi, 2);
         const std::string sats = std::to_string(satoshi);
 
         nlohmann::json result = { { "satoshi", satoshi }, { "btc", btc }, { "mbtc", mbtc }, { "ubtc", ubtc },
@@ -125,20 +266,109 @@ namespace sdk {
 
         if (!fiat_rate_used.empty()) {
             result["fiat_rate"] = fiat_rate_used;
-            result["fiat"]
-                = fmt(fiat_type(conversion_type(fiat_rate_used) * conversion_type(satoshi) / COIN_VALUE_DECIMAL));
+            result["fiat"] = satoshi_to_fiat(satoshi, fiat_rate_used, parse_decimal(fiat_rate_used));
         }
 
         if (have_asset_info) {
             if (precision == 0) {
                 result[asset_id] = sats;
+            } else if (precision > 0 && static_cast<uint32_t>(precision) <= MAX_DECIMAL_DIGITS) {
+                result[asset_id] = format_units(satoshi, precision);
             } else {
-                result[asset_id] = fmt(btc_type(satoshi_conv / COIN_VALUE_WITH_PRECISION), precision);
+                result[asset_id] = fmt(btc_type(conversion_type(satoshi) / pow10_decimal(precision)), precision);
             }
         }
         return result;
     }
 
+    nlohmann::json amount::convert_amounts(
+        const nlohmann::json& details, const std::string& fiat_currency, const std::string& fiat_rate)
+    {
+        // Collect the satoshi values to convert
+        std::vector<int64_t> values;
+        const auto satoshi_p = details.find("satoshi");
+        if (satoshi_p != details.end()) {
+            GDK_RUNTIME_ASSERT(satoshi_p->is_array());
+            values.reserve(satoshi_p->size());
+            for (const auto& satoshi : *satoshi_p) {
+                values.push_back(satoshi.get<int64_t>());
+            }
+        } else {
+            // Read the values from an array of items within a source document
+            const auto& items = details.at("source").at(nlohmann::json::json_pointer(details.value("path", "")));
+            GDK_RUNTIME_ASSERT(items.is_array());
+            const std::string key = details.value("key", "satoshi");
+            values.reserve(items.size());
+            for (const auto& item : items) {
+                values.push_back(item.is_object() ? item.at(key).get<int64_t>() : item.get<int64_t>());
+            }
+        }
+
+        uint32_t requested = 0;
+        const auto denominations_p = details.find("denominations");
+        if (denominations_p == details.end()) {
+            requested = ~requested;
+        } else {
+            for (const auto& name : *denominations_p) {
+                const auto p = std::find_if(DENOMINATIONS.begin(), DENOMINATIONS.end(),
+                    [&name](const auto& d) { return name == d.first; });
+                GDK_RUNTIME_ASSERT_MSG(p != DENOMINATIONS.end(), "unknown denomination " + name.dump());
+                requested |= p->second;
+            }
+        }
+
+        // As with convert(), fall back to any fiat values provided if the
+        // fiat rate or currency is not available
+        const std::string old_fiat_rate = details.value("fiat_rate", std::string());
+        const std::string& fiat_rate_used(fiat_rate.empty() ? old_fiat_rate : fiat_rate);
+        const std::string old_fiat_ccy = details.value("fiat_currency", std::string());
+        const std::string& fiat_ccy_used(fiat_currency.empty() ? old_fiat_ccy : fiat_currency);
+        const bool is_current = !fiat_rate.empty() && !fiat_currency.empty();
+        const auto rate = parse_decimal(fiat_rate_used);
+
+        nlohmann::json::array_t amounts;
+        amounts.reserve(values.size());
+        for (const int64_t satoshi : values) {
+            if (satoshi < 0 || satoshi > SATOSHI_MAX) {
+                throw user_error(res::id_invalid_amount);
+            }
+            nlohmann::json result = nlohmann::json::object();
+            if (requested & DENOM_SATOSHI) {
+                result["satoshi"] = satoshi;
+            }
+            if (requested & DENOM_BTC) {
+                result["btc"] = format_units(satoshi, 8);
+            }
+            if (requested & DENOM_MBTC) {
+                result["mbtc"] = format_units(satoshi, 5);
+            }
+            if (requested & (DENOM_UBTC | DENOM_BITS)) {
+                std::string ubtc = format_units(satoshi, 2);
+                if (requested & DENOM_BITS) {
+                    result["bits"] = ubtc;
+                }
+                if (requested & DENOM_UBTC) {
+                    result["ubtc"] = std::move(ubtc);
+                }
+            }
+            if (requested & DENOM_SATS) {
+                result["sats"] = std::to_string(satoshi);
+            }
+            if (requested & DENOM_FIAT) {
+                if (fiat_rate_used.empty()) {
+                    result["fiat"] = nullptr;
+                } else {
+                    result["fiat"] = satoshi_to_fiat(satoshi, fiat_rate_used, rate);
+                }
+            }
+            amounts.emplace_back(std::move(result));
+        }
+
+        return { { "amounts", std::move(amounts) }, { "fiat_currency", fiat_ccy_used },
+            { "fiat_rate", fiat_rate_used.empty() ? nlohmann::json() : nlohmann::json(fiat_rate_used) },
+            { "is_current", is_current } };
+    }
+
     void amount::strip_non_satoshi_keys(nlohmann::json& amount_json)
     {
         for (const auto& key : NON_SATOSHI_KEYS) {
@@ -34,6 +34,10 @@ namespace sdk {
         static nlohmann::json convert(
             const nlohmann::json& amount_json, const std::string& fiat_currency, const std::string& fiat_rate);
 
+        // Convert many satoshi amounts to the requested denominations only
+        static nlohmann::json convert_amounts(
+            const nlohmann::json& details, const std::string& fiat_currency, const std::string& fiat_rate);
+
         // Remove all conversion keys except satoshi
         static void strip_non_satoshi_keys(nlohmann::json& amount_json);
 
@@ -0,0 +1,172 @@
+#include <algorithm>
+#include <exception>
+
+#include "executor.hpp"
+#include "assertion.hpp"
+#include "logging.hpp"
+#include "utils.hpp"
+
+namespace ga {
+namespace sdk {
+
+    namespace {
+        static const std::size_t DEFAULT_IO_THREADS = 2; // Number of shared io threads
+        static const std::size_t DEFAULT_POOL_THREADS = 8; // Number of shared pool threads
+
+        static std::unique_ptr<shared_executor> s_shared_executor;
+    } // namespace
+
+    shared_executor::shared_executor(std::size_t io_threads, std::size_t pool_threads)
+        : m_next_io_context(0)
+        , m_pool(pool_threads)
+    {
+        GDK_RUNTIME_ASSERT(io_threads != 0 && pool_threads != 0);
+
+        m_io_contexts.reserve(io_threads);
+        m_work_guards.reserve(io_threads);
+        m_io_threads.reserve(io_threads);
+        for (std::size_t i = 0; i < io_threads; ++i) {
+            m_io_contexts.emplace_back(std::make_unique<boost::asio::io_context>(1));
+            auto& io = *m_io_contexts.back();
+            m_work_guards.emplace_back(boost::asio::make_work_guard(io));
+            m_io_threads.emplace_back([&io] { io.run(); });
+        }
+        GDK_LOG_SEV(log_level::info) << "shared executor: " << io_threads << " io threads, " << pool_threads
+                                     << " pool threads";
+    }
+
+    shared_executor::~shared_executor()
+    {
+        no_std_exception_escape([this] {
+            for (auto& guard : m_work_guards) {
+                guard.reset();
+            }
+            for (auto& t : m_io_threads) {
+                t.join();
+            }
+            m_pool.join();
+        });
+    }
+
+    boost::asio::io_context& shared_executor::next_io_context()
+    {
+        std::lock_guard<std::mutex> _(m_mutex);
+        auto& io = *m_io_contexts[m_next_io_context];
+        m_next_io_context = (m_next_io_context + 1) % m_io_contexts.size();
+        return io;
+    }
+
+    void init_shared_executor(const nlohmann::json& config)
+    {
+        const auto p = config.find("executor");
+        if (p == config.end() || !p->value("shared", false)) {
+            return;
+        }
+        const std::size_t io_threads = p->value("io_threads", DEFAULT_IO_THREADS);
+        const std::size_t pool_threads = p->value("pool_threads", DEFAULT_POOL_THREADS);
+        s_shared_executor = std::make_unique<shared_executor>(io_threads, pool_threads);
+    }
+
+    shared_executor* get_shared_executor() { return s_shared_executor.get(); }
+
+    void parallel_for(
+        std::size_t n, std::size_t min_per_thread, const std::function<void(std::size_t, std::size_t)>& fn)
+    {
+        GDK_RUNTIME_ASSERT(min_per_thread != 0);
+        const std::size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+        const std::size_t num_threads = std::min(max_threads, n / min_per_thread);
+        if (num_threads < 2) {
+            if (n != 0) {
+                fn(0, n);
+            }
+            return;
+        }
+
+        const std::size_t per_thread = (n + num_threads - 1) / num_threads;
+        std::vector<std::exception_ptr> errors(num_threads);
+        auto run = [&](std::size_t i) {
+            try {
+                fn(i * per_thread, std::min(n, (i + 1) * per_thread));
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        threads.reserve(num_threads - 1);
+        for (std::size_t i = 1; i < num_threads && i * per_thread < n; ++i) {
+            threads.emplace_back(run, i);
+        }
+        run(0); // The calling thread takes the first range
+        for (auto& t : threads) {
+            t.join();
+        }
+        for (const auto& e : errors) {
+            if (e) {
+                std::rethrow_exception(e);
+            }
+        }
+    }
+
+    pending_ops::pending_ops()
+        : m_pending(0)
+    {
+    }
+
+    void pending_ops::wait()
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        m_cv.wait(locker, [this] { return m_pending == 0; });
+    }
+
+    void pending_ops::enter()
+    {
+        std::lock_guard<std::mutex> _(m_mutex);
+        ++m_pending;
+    }
+
+    void pending_ops::leave()
+    {
+        std::lock_guard<std::mutex> _(m_mutex);
+        if (--m_pending == 0) {
+            m_cv.notify_all();
+        }
+    }
+
+    task_group::task_group(boost::asio::thread_pool& pool)
+        : m_pool(pool)
+        , m_strand(pool.get_executor())
+        , m_pending(0)
+        , m_stopped(false)
+    {
+    }
+
+    task_group::~task_group() { join(); }
+
+    void task_group::join()
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        m_stopped = true;
+        m_cv.wait(locker, [this] { return m_pending == 0; });
+    }
+
+    bool task_group::enter()
+    {
+        std::lock_guard<std::mutex> _(m_mutex);
+        if (m_stopped) {
+            return false;
+        }
+        ++m_pending;
+        return true;
+    }
+
+    void task_group::leave()
+    {
+        std::lock_guard<std::mutex> _(m_mutex);
+        if (--m_pending == 0) {
+            m_cv.notify_all();
+        }
+    }
+
+} // namespace sdk
+} // namespace ga
@@ -0,0 +1,148 @@
+#ifndef GDK_EXECUTOR_HPP
+#define GDK_EXECUTOR_HPP
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "boost_wrapper.hpp"
+#include "gsl_wrapper.hpp"
+
+namespace ga {
+namespace sdk {
+
+    // Process-wide io threads and task pool, shared by all sessions.
+    // Enabled through the "executor" element of the GA_init config, otherwise
+    // each session owns its own io thread and task pool.
+    class shared_executor {
+    public:
+        shared_executor(std::size_t io_threads, std::size_t pool_threads);
+        ~shared_executor();
+
+        shared_executor(const shared_executor&) = delete;
+        shared_executor& operator=(const shared_executor&) = delete;
+        shared_executor(shared_executor&&) = delete;
+        shared_executor& operator=(shared_executor&&) = delete;
+
+        // Each io context is run by a single thread, so handlers for all
+        // objects bound to it are serialized exactly as with a per-session
+        // io thread. Contexts are handed out round-robin.
+        boost::asio::io_context& next_io_context();
+
+        boost::asio::thread_pool& pool() { return m_pool; }
+
+    private:
+        using work_guard_t = boost::asio::executor_work_guard<boost::asio::io_context::executor_type>;
+
+        std::vector<std::unique_ptr<boost::asio::io_context>> m_io_contexts;
+        std::vector<work_guard_t> m_work_guards;
+        std::vector<std::thread> m_io_threads;
+        std::mutex m_mutex;
+        std::size_t m_next_io_context;
+        boost::asio::thread_pool m_pool;
+    };
+
+    // Create the process-wide executor if enabled in the GA_init config
+    void init_shared_executor(const nlohmann::json& config);
+
+    // Returns the process-wide executor, or nullptr if it is not enabled
+    shared_executor* get_shared_executor();
+
+    // Call fn(begin, end) over contiguous ranges covering [0, n), from
+    // dedicated worker threads when there are at least 2 * min_per_thread
+    // items, blocking until all calls have returned. Uses its own threads
+    // rather than a pool so that callers can never deadlock waiting on pool
+    // threads. The first exception thrown by any call is rethrown.
+    void parallel_for(
+        std::size_t n, std::size_t min_per_thread, const std::function<void(std::size_t, std::size_t)>& fn);
+
+    // Counts the outstanding asynchronous operations whose handlers refer to
+    // an object, so that it can wait for them to complete before it is
+    // destroyed.
+    class pending_ops {
+    public:
+        pending_ops();
+        ~pending_ops() = default;
+
+        pending_ops(const pending_ops&) = delete;
+        pending_ops& operator=(const pending_ops&) = delete;
+        pending_ops(pending_ops&&) = delete;
+        pending_ops& operator=(pending_ops&&) = delete;
+
+        // Wrap a completion handler. The operation remains outstanding until
+        // every copy of the handler has been invoked or discarded.
+        template <typename F> auto wrap(F&& fn)
+        {
+            enter();
+            std::shared_ptr<void> op(nullptr, [this](void*) { leave(); });
+            return [op = std::move(op), fn = std::forward<F>(fn)](
+                       auto&&... args) mutable { fn(std::forward<decltype(args)>(args)...); };
+        }
+
+        // Wait for all outstanding operations to complete
+        void wait();
+
+    private:
+        void enter();
+        void leave();
+
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::size_t m_pending;
+    };
+
+    // Tracks the tasks a session posts to a (possibly shared) thread pool,
+    // so that the session can wait for its own tasks only when it is destroyed.
+    class task_group {
+    public:
+        explicit task_group(boost::asio::thread_pool& pool);
+        ~task_group();
+
+        task_group(const task_group&) = delete;
+        task_group& operator=(const task_group&) = delete;
+        task_group(task_group&&) = delete;
+        task_group& operator=(task_group&&) = delete;
+
+        // Run fn on the pool, concurrently with other tasks
+        template <typename F> void post(F&& fn) { post_to(m_pool.get_executor(), std::forward<F>(fn)); }
+
+        // Run fn on the pool, in order with other ordered tasks from this group
+        template <typename F> void post_ordered(F&& fn) { post_to(m_strand, std::forward<F>(fn)); }
+
+        // Stop accepting new tasks and wait for the outstanding ones to finish
+        void join();
+
+    private:
+        template <typename Executor, typename F> void post_to(const Executor& executor, F&& fn)
+        {
+            if (!enter()) {
+                return;
+            }
+            boost::asio::post(executor, [this, fn = std::forward<F>(fn)]() mutable {
+                const auto _leave = gsl::finally([this] { leave(); });
+                fn();
+            });
+        }
+
+        bool enter();
+        void leave();
+
+        boost::asio::thread_pool& m_pool;
+        boost::asio::strand<boost::asio::thread_pool::executor_type> m_strand;
+        std::mutex m_mutex;
+        std::condition_variable m_cv;
+        std::size_t m_pending;
+        bool m_stopped;
+    };
+
+} // namespace sdk
+} // namespace ga
+
+#endif
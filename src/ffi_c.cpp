@@ -327,6 +327,12 @@ GDK_DEFINE_C_FUNCTION_3(
         session->set_notification_handler(handler, context);
     })
 
+GDK_DEFINE_C_FUNCTION_3(GA_set_batch_notification_handler, struct GA_session*, session,
+    GA_batch_notification_handler, handler, void*, context, {
+        GDK_RUNTIME_ASSERT(handler);
+        session->set_batch_notification_handler(handler, context);
+    })
+
 GDK_DEFINE_C_FUNCTION_2(GA_remove_account, struct GA_session*, session, struct GA_auth_handler**, call,
     { *call = make_call(new ga::sdk::remove_account_call(*session)); });
 
@@ -385,6 +391,9 @@ GDK_DEFINE_C_FUNCTION_2(GA_get_available_currencies, struct GA_session*, session
 GDK_DEFINE_C_FUNCTION_3(GA_convert_amount, struct GA_session*, session, const GA_json*, value_details, GA_json**,
     output, { *json_cast(output) = new nlohmann::json(session->convert_amount(*json_cast(value_details))); })
 
+GDK_DEFINE_C_FUNCTION_3(GA_convert_amounts, struct GA_session*, session, const GA_json*, details, GA_json**, output,
+    { *json_cast(output) = new nlohmann::json(session->convert_amounts(*json_cast(details))); })
+
 GDK_DEFINE_C_FUNCTION_5(GA_set_pin, struct GA_session*, session, const char*, mnemonic, const char*, pin, const char*,
     device_id, GA_json**, pin_data,
     { *json_cast(pin_data) = new nlohmann::json(session->set_pin(mnemonic, pin, device_id)); })
@@ -49,7 +49,7 @@ namespace sdk {
         {
             // TODO: These values should be identical/re-used if the same data
             // is being signed repeatedly (eg. being re-tried following a failure).
-            const auto host_entropy = get_random_bytes<WALLY_S2C_DATA_LEN>();
+            const auto host_entropy = get_fast_random_bytes<WALLY_S2C_DATA_LEN>();
             const auto host_commitment = ae_host_commit_from_bytes(host_entropy);
             data["ae_host_entropy"] = b2h(host_entropy);
             data["ae_host_commitment"] = b2h(host_commitment);
@@ -513,12 +513,12 @@ namespace sdk {
                 // BTC: Provide the previous txs data for validation, even
                 // for segwit, in order to mitigate the segwit fee attack.
                 // (Liquid txs are segwit+explicit fee and so not affected)
+                std::vector<std::string> txhashes;
+                txhashes.reserve(signing_inputs.size());
                 for (const auto& input : signing_inputs) {
-                    const std::string txhash = input.at("txhash");
-                    if (prev_txs.find(txhash) == prev_txs.end()) {
-                        prev_txs.emplace(txhash, m_session->get_transaction_details(txhash).at("transaction"));
-                    }
+                    txhashes.emplace_back(input.at("txhash"));
                 }
+                prev_txs = m_session->get_transactions_hex(txhashes);
             }
             m_twofactor_data["signing_address_types"] = std::vector<std::string>(addr_types.begin(), addr_types.end());
             m_twofactor_data["signing_inputs"] = signing_inputs;
@@ -553,14 +553,19 @@ namespace sdk {
             const auto& abfs = get_sized_array(hw_reply, "assetblinders", outputs.size());
             const auto& vbfs = get_sized_array(hw_reply, "amountblinders", outputs.size());
 
+            std::vector<output_blinders> blinders;
+            blinders.reserve(outputs.size());
             size_t i = 0;
             for (const auto& out : outputs) {
-                if (!out.at("is_fee")) {
-                    blind_output(*m_session, transaction_details, tx, i, out, h2b<33>(asset_commitments[i]),
-                        h2b<33>(value_commitments[i]), h2b_rev<32>(abfs[i]), h2b_rev<32>(vbfs[i]));
+                // The fee output is always the last output
+                if (out.at("is_fee")) {
+                    break;
                 }
+                blinders.emplace_back(output_blinders{ h2b<33>(asset_commitments[i]), h2b<33>(value_commitments[i]),
+                    h2b_rev<32>(abfs[i]), h2b_rev<32>(vbfs[i]) });
                 ++i;
             }
+            blind_outputs(m_net_params, transaction_details, tx, blinders);
         }
 
         // If we are using the Anti-Exfil protocol we verify the signatures
@@ -612,6 +617,13 @@ namespace sdk {
         m_result = m_session->get_receive_address(m_details);
 
         if (m_net_params.is_liquid() && !m_net_params.is_electrum()) {
+            if (m_result.contains("blinding_key")) {
+                // The session pre-computed the blinding key, so we are done
+                const std::string blinding_key_hex = m_result["blinding_key"];
+                blind_address(m_result, m_net_params.blinded_prefix(), blinding_key_hex);
+                m_state = state_type::done;
+                return;
+            }
             // Ask the caller to provide the blinding key
             signal_hw_request(hw_request::get_blinding_public_keys);
             m_twofactor_data["scripts"].push_back(m_result.at("blinding_script"));
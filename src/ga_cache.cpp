@@ -1,8 +1,18 @@
 #include <algorithm>
 #include <array>
+#include <cerrno>
+#include <cstdio>
 #include <fstream>
 #include <vector>
 
+#include <fcntl.h>
+#include <sys/stat.h>
+#if defined _WIN32 || defined WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 #include "assertion.hpp"
 #include "ga_cache.hpp"
 #include "logging.hpp"
@@ -11,13 +21,22 @@
 #include "session.hpp"
 #include "sqlite3/sqlite3.h"
 #include "utils.hpp"
+#include <zlib/zlib.h>
 
 namespace ga {
 namespace sdk {
 
     namespace {
 
-        constexpr int VERSION = 1;
+        constexpr int VERSION = 2;
+        constexpr size_t CHUNK_SIZE = 256 * 1024;
+        constexpr std::array<unsigned char, 4> CHUNK_FILE_MAGIC = { { 'G', 'D', 'K', 'C' } };
+        constexpr size_t CHUNK_FILE_HEADER_LEN = CHUNK_FILE_MAGIC.size() + sizeof(uint64_t);
+        constexpr size_t CHUNK_HEADER_LEN = sizeof(uint32_t) + 1 + sizeof(uint32_t);
+        constexpr size_t CHUNK_OVERHEAD = 12 + 16; // AES-GCM IV and tag
+        constexpr unsigned char CHUNK_FLAG_FINAL = 0x1;
+        constexpr unsigned char CHUNK_FLAG_ZLIB = 0x2;
+        constexpr uint64_t MAX_DB_SIZE = 1024 * 1024 * 1024; // Default sqlite memdb limit
         constexpr const char* KV_SELECT = "SELECT value FROM KeyValue WHERE key = ?1;";
 
         static cache::sqlite3_ptr get_new_memory_db()
@@ -28,12 +47,15 @@ namespace sdk {
             return cache::sqlite3_ptr{ tmpdb, [](sqlite3* p) { sqlite3_close(p); } };
         }
 
-        static auto get_db()
+        // (Re-)initialize db as an empty, resizable serialized database.
+        // Keeping the DB in serialized form means we can load it from and
+        // save it to disk without making intermediate copies.
+        static void init_db(cache::sqlite3_ptr& db)
         {
-            // Verify thread safety in the event that sqlite has been upgraded
-            GDK_RUNTIME_ASSERT(sqlite3_threadsafe());
+            const int rc = sqlite3_deserialize(db.get(), "main", nullptr, 0, 0,
+                SQLITE_DESERIALIZE_FREEONCLOSE | SQLITE_DESERIALIZE_RESIZEABLE);
+            GDK_RUNTIME_ASSERT(rc == SQLITE_OK);
 
-            auto db = get_new_memory_db();
             const auto exec_check = [&db](const char* sql) {
                 char* err_msg = nullptr;
                 const int rc = sqlite3_exec(db.get(), sql, 0, 0, &err_msg);
@@ -49,7 +71,15 @@ namespace sdk {
 
             exec_check("CREATE TABLE LiquidBlindingNonce(pubkey BLOB NOT NULL, script BLOB NOT NULL, nonce BLOB NOT "
                        "NULL, PRIMARY KEY(pubkey, script));");
+        }
+
+        static auto get_db()
+        {
+            // Verify thread safety in the event that sqlite has been upgraded
+            GDK_RUNTIME_ASSERT(sqlite3_threadsafe());
 
+            auto db = get_new_memory_db();
+            init_db(db);
             return db;
         }
 
@@ -86,46 +116,248 @@ namespace sdk {
             return gsl::finally([&stmt] { stmt_check_clean(stmt); });
         }
 
-        static void save_db_file(byte_span_t key, byte_span_t data, const std::string& path)
+        using sqlite3_buffer_ptr = std::unique_ptr<unsigned char, decltype(&::sqlite3_free)>;
+
+        static void put_u32(unsigned char* dst, uint32_t v)
+        {
+            for (size_t i = 0; i < sizeof(v); ++i) {
+                dst[i] = static_cast<unsigned char>(v >> (i * 8));
+            }
+        }
+
+        static uint32_t get_u32(const unsigned char* src)
+        {
+            uint32_t v = 0;
+            for (size_t i = 0; i < sizeof(v); ++i) {
+                v |= static_cast<uint32_t>(src[i]) << (i * 8);
+            }
+            return v;
+        }
+
+        static void put_u64(unsigned char* dst, uint64_t v)
+        {
+            put_u32(dst, static_cast<uint32_t>(v));
+            put_u32(dst + sizeof(uint32_t), static_cast<uint32_t>(v >> 32));
+        }
+
+        static uint64_t get_u64(const unsigned char* src)
+        {
+            return static_cast<uint64_t>(get_u32(src)) | static_cast<uint64_t>(get_u32(src + sizeof(uint32_t))) << 32;
+        }
+
+        // Write all of data to fd, returning false on error
+        static bool write_all(int fd, byte_span_t data)
+        {
+            const unsigned char* p = data.data();
+            size_t remaining = data.size();
+            while (remaining != 0) {
+                const auto written = ::write(fd, p, remaining);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                p += written;
+                remaining -= static_cast<size_t>(written);
+            }
+            return true;
+        }
+
+        // Flush fd's data to disk, returning false on error
+        static bool sync_file(int fd)
+        {
+#if defined _WIN32 || defined WIN32
+            return _commit(fd) == 0;
+#else
+            return fsync(fd) == 0;
+#endif
+        }
+
+        static bool read_all(std::ifstream& f, gsl::span<unsigned char> data)
+        {
+            f.read(reinterpret_cast<char*>(data.data()), data.size());
+            return static_cast<size_t>(f.gcount()) == static_cast<size_t>(data.size());
+        }
+
+        // The DB file is stored as a header followed by a sequence of chunks.
+        // The header is (magic, total db size), each chunk is stored as
+        // (encrypted length, aes_gcm_encrypt(chunk header || payload)) where
+        // the chunk header is (chunk index, flags, uncompressed payload length).
+        // Including the index and final flag in the authenticated data means
+        // chunks cannot be reordered, dropped or truncated undetected.
+        // Returns false if the file could not be written.
+        static bool write_db_file(int fd, byte_span_t key, byte_span_t data)
+        {
+            std::array<unsigned char, CHUNK_FILE_HEADER_LEN> file_header;
+            std::copy(CHUNK_FILE_MAGIC.begin(), CHUNK_FILE_MAGIC.end(), file_header.begin());
+            put_u64(file_header.data() + CHUNK_FILE_MAGIC.size(), data.size());
+            if (!write_all(fd, file_header)) {
+                return false;
+            }
+
+            std::vector<unsigned char> plaintext(CHUNK_HEADER_LEN + compressBound(CHUNK_SIZE));
+            const auto _wipe = gsl::finally([&plaintext] { bzero_and_free(plaintext); });
+            std::vector<unsigned char> record;
+
+            const size_t data_len = data.size();
+            uint32_t index = 0;
+            for (size_t offset = 0; offset < data_len; offset += CHUNK_SIZE, ++index) {
+                const size_t raw_len = std::min(CHUNK_SIZE, data_len - offset);
+                const unsigned char* raw = data.data() + offset;
+                unsigned char flags = offset + raw_len == data_len ? CHUNK_FLAG_FINAL : 0;
+
+                // Compress the chunk, storing it uncompressed if that doesn't help
+                unsigned char* payload = plaintext.data() + CHUNK_HEADER_LEN;
+                uLongf payload_len = plaintext.size() - CHUNK_HEADER_LEN;
+                const int z_result = compress2(payload, &payload_len, raw, raw_len, Z_BEST_SPEED);
+                if (z_result == Z_OK && payload_len < raw_len) {
+                    flags |= CHUNK_FLAG_ZLIB;
+                } else {
+                    std::copy(raw, raw + raw_len, payload);
+                    payload_len = raw_len;
+                }
+
+                put_u32(plaintext.data(), index);
+                plaintext[sizeof(uint32_t)] = flags;
+                put_u32(plaintext.data() + sizeof(uint32_t) + 1, raw_len);
+
+                const auto chunk = gsl::make_span(plaintext.data(), CHUNK_HEADER_LEN + payload_len);
+                const size_t encrypted_len = aes_gcm_encrypt_get_length(chunk);
+                record.resize(sizeof(uint32_t) + encrypted_len);
+                put_u32(record.data(), encrypted_len);
+                const auto encrypted = gsl::make_span(record).subspan(sizeof(uint32_t));
+                GDK_RUNTIME_ASSERT(aes_gcm_encrypt(key, chunk, encrypted) == encrypted_len);
+                if (!write_all(fd, record)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Write the DB file to a temporary file, then replace the previous
+        // file with it once it is complete and synced to disk. Returns false,
+        // leaving the previous file in place, if the file could not be written.
+        static bool save_db_file(byte_span_t key, byte_span_t data, const std::string& path)
         {
             GDK_RUNTIME_ASSERT(!key.empty() && !data.empty());
-            std::ofstream f(path, f.out | f.binary);
-            if (f.is_open()) {
-                const size_t encrypted_len = aes_gcm_encrypt_get_length(data);
-                std::vector<unsigned char> cyphertext(encrypted_len);
-                GDK_RUNTIME_ASSERT(aes_gcm_encrypt(key, data, cyphertext) == encrypted_len);
-
-                for (size_t written = 0; written != encrypted_len; written = f.tellp()) {
-                    auto p = reinterpret_cast<const char*>(&cyphertext[written]);
-                    f.write(p, encrypted_len - written);
+            const std::string tmp_path = path + ".tmp";
+#ifdef O_BINARY
+            const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, S_IRUSR | S_IWUSR);
+#else
+            const int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+#endif
+            if (fd == -1) {
+                GDK_LOG_SEV(log_level::warning) << "Failed to create db file " << tmp_path;
+                return false;
+            }
+            bool written = false;
+            try {
+                written = write_db_file(fd, key, data) && sync_file(fd);
+            } catch (const std::exception& e) {
+                GDK_LOG_SEV(log_level::warning) << "Failed to write db file: " << e.what();
+            }
+            written = ::close(fd) == 0 && written;
+
+            if (!written || std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+                GDK_LOG_SEV(log_level::warning) << "Failed to " << (written ? "replace" : "write") << " db file "
+                                                << path;
+                unlink(tmp_path.c_str());
+                return false;
+            }
+            return true;
+        }
+
+        // Load a chunked DB file, returning a buffer allocated with sqlite3_malloc64
+        static std::pair<sqlite3_buffer_ptr, size_t> load_db_file(byte_span_t key, const std::string& path)
+        {
+            GDK_RUNTIME_ASSERT(!key.empty());
+            sqlite3_buffer_ptr db_data{ nullptr, sqlite3_free };
+            std::ifstream f(path, f.in | f.binary);
+            if (!f.is_open()) {
+                GDK_LOG_SEV(log_level::info) << "Load db, no file or bad file " << path;
+                return { std::move(db_data), 0 };
+            }
+
+            std::array<unsigned char, CHUNK_FILE_HEADER_LEN> file_header;
+            GDK_RUNTIME_ASSERT(read_all(f, file_header));
+            GDK_RUNTIME_ASSERT(std::equal(CHUNK_FILE_MAGIC.begin(), CHUNK_FILE_MAGIC.end(), file_header.begin()));
+            const uint64_t db_len = get_u64(file_header.data() + CHUNK_FILE_MAGIC.size());
+            GDK_RUNTIME_ASSERT(db_len != 0 && db_len <= MAX_DB_SIZE);
+
+            db_data.reset(static_cast<unsigned char*>(sqlite3_malloc64(db_len)));
+            GDK_RUNTIME_ASSERT(db_data != nullptr);
+
+            const size_t max_encrypted_len = CHUNK_HEADER_LEN + compressBound(CHUNK_SIZE) + CHUNK_OVERHEAD;
+            std::vector<unsigned char> cyphertext;
+            cyphertext.reserve(max_encrypted_len);
+            std::vector<unsigned char> plaintext;
+            plaintext.reserve(max_encrypted_len);
+            const auto _wipe = gsl::finally([&plaintext] { bzero_and_free(plaintext); });
+
+            uint64_t offset = 0;
+            bool is_final = false;
+            for (uint32_t index = 0; !is_final; ++index) {
+                std::array<unsigned char, sizeof(uint32_t)> len_bytes;
+                GDK_RUNTIME_ASSERT(read_all(f, len_bytes));
+                const size_t encrypted_len = get_u32(len_bytes.data());
+                GDK_RUNTIME_ASSERT(encrypted_len > CHUNK_HEADER_LEN + CHUNK_OVERHEAD);
+                GDK_RUNTIME_ASSERT(encrypted_len <= max_encrypted_len);
+                cyphertext.resize(encrypted_len);
+                GDK_RUNTIME_ASSERT(read_all(f, cyphertext));
+
+                plaintext.resize(aes_gcm_decrypt_get_length(cyphertext));
+                GDK_RUNTIME_ASSERT(aes_gcm_decrypt(key, cyphertext, plaintext) == plaintext.size());
+
+                GDK_RUNTIME_ASSERT(get_u32(plaintext.data()) == index);
+                const unsigned char flags = plaintext[sizeof(uint32_t)];
+                const size_t raw_len = get_u32(plaintext.data() + sizeof(uint32_t) + 1);
+                GDK_RUNTIME_ASSERT(raw_len != 0 && raw_len <= CHUNK_SIZE && raw_len <= db_len - offset);
+                is_final = (flags & CHUNK_FLAG_FINAL) != 0;
+
+                const unsigned char* payload = plaintext.data() + CHUNK_HEADER_LEN;
+                const size_t payload_len = plaintext.size() - CHUNK_HEADER_LEN;
+                unsigned char* dst = db_data.get() + offset;
+                if (flags & CHUNK_FLAG_ZLIB) {
+                    uLongf decompressed_len = raw_len;
+                    uLong compressed_len = payload_len;
+                    const int z_result = uncompress2(dst, &decompressed_len, payload, &compressed_len);
+                    GDK_RUNTIME_ASSERT(z_result == Z_OK && decompressed_len == raw_len);
+                    GDK_RUNTIME_ASSERT(compressed_len == payload_len);
+                } else {
+                    GDK_RUNTIME_ASSERT(payload_len == raw_len);
+                    std::copy(payload, payload + payload_len, dst);
                 }
+                offset += raw_len;
             }
+            // The final chunk must complete the DB, with no trailing data
+            GDK_RUNTIME_ASSERT(offset == db_len);
+            GDK_RUNTIME_ASSERT(f.peek() == std::ifstream::traits_type::eof());
+            return { std::move(db_data), db_len };
         }
 
-        static std::vector<unsigned char> load_db_file(byte_span_t key, const std::string& path)
+        // Load a pre-chunking (version 1) DB file, encrypted as a single blob
+        static std::pair<sqlite3_buffer_ptr, size_t> load_db_file_v1(byte_span_t key, const std::string& path)
         {
             GDK_RUNTIME_ASSERT(!key.empty());
+            sqlite3_buffer_ptr db_data{ nullptr, sqlite3_free };
             std::ifstream f(path, f.in | f.binary);
             if (!f.is_open()) {
                 GDK_LOG_SEV(log_level::info) << "Load db, no file or bad file " << path;
-                return std::vector<unsigned char>();
+                return { std::move(db_data), 0 };
             }
 
             f.seekg(0, f.end);
             std::vector<unsigned char> cyphertext(f.tellg());
             f.seekg(0, f.beg);
-
-            size_t read = 0;
-            while (read != cyphertext.size()) {
-                auto p = reinterpret_cast<char*>(&cyphertext[read]);
-                f.read(p, cyphertext.size() - read);
-                read += f.gcount();
-            }
+            GDK_RUNTIME_ASSERT(read_all(f, cyphertext));
 
             const size_t decrypted_len = aes_gcm_decrypt_get_length(cyphertext);
-            std::vector<unsigned char> plaintext(decrypted_len);
+            db_data.reset(static_cast<unsigned char*>(sqlite3_malloc64(decrypted_len)));
+            GDK_RUNTIME_ASSERT(db_data != nullptr);
+            const auto plaintext = gsl::make_span(db_data.get(), decrypted_len);
             GDK_RUNTIME_ASSERT(aes_gcm_decrypt(key, cyphertext, plaintext) == decrypted_len);
-            return plaintext;
+            return { std::move(db_data), decrypted_len };
         }
 
         static std::string get_persistent_storage_file(
@@ -149,35 +381,30 @@ namespace sdk {
             }
         }
 
-        static bool load_db_impl(byte_span_t key, const std::string& path, cache::sqlite3_ptr& db)
+        static bool load_db_impl(byte_span_t key, const std::string& path, int version, cache::sqlite3_ptr& db)
         {
-            std::vector<unsigned char> plaintext;
+            std::pair<sqlite3_buffer_ptr, size_t> loaded{ sqlite3_buffer_ptr{ nullptr, sqlite3_free }, 0 };
             try {
-                plaintext = load_db_file(key, path);
+                loaded = version == 1 ? load_db_file_v1(key, path) : load_db_file(key, path);
             } catch (const std::exception& ex) {
                 GDK_LOG_SEV(log_level::info) << "Bad decryption for file " << path << " error " << ex.what();
                 unlink(path.c_str());
             }
 
-            if (plaintext.empty()) {
+            if (!loaded.first) {
                 return false;
             }
 
-            const auto tmpdb = get_new_memory_db();
-            const int rc = sqlite3_deserialize(
-                tmpdb.get(), "main", plaintext.data(), plaintext.size(), plaintext.size(), SQLITE_DESERIALIZE_READONLY);
+            // Hand the decrypted buffer directly to sqlite, which takes
+            // ownership of it (including freeing it on failure)
+            const size_t len = loaded.second;
+            const int rc = sqlite3_deserialize(db.get(), "main", loaded.first.release(), len, len,
+                SQLITE_DESERIALIZE_FREEONCLOSE | SQLITE_DESERIALIZE_RESIZEABLE);
 
             if (rc != SQLITE_OK) {
                 GDK_LOG_SEV(log_level::info) << "Bad sqlite3_deserialize for file " << path << " RC " << rc;
                 unlink(path.c_str());
-                return false;
-            }
-
-            auto backup = sqlite3_backup_init(db.get(), "main", tmpdb.get(), "main");
-            bool ok = backup != nullptr && sqlite3_backup_step(backup, -1) == SQLITE_DONE;
-            ok = ok && sqlite3_backup_finish(backup) == SQLITE_OK;
-            if (!ok) {
-                db_log_error(db.get());
+                init_db(db); // Restore an empty DB
                 return false;
             }
             GDK_LOG_SEV(log_level::info) << path << " loaded correctly";
@@ -245,38 +472,50 @@ namespace sdk {
         , m_encryption_key()
         , m_require_write(false)
         , m_db(get_db())
-        , m_stmt_liquid_blinding_nonce_search(
-              get_stmt(m_is_liquid, m_db, "SELECT nonce FROM LiquidBlindingNonce WHERE pubkey = ?1 AND script = ?2;"))
-        , m_stmt_liquid_blinding_nonce_insert(get_stmt(
-              m_is_liquid, m_db, "INSERT INTO LiquidBlindingNonce (pubkey, script, nonce) VALUES (?1, ?2, ?3);"))
-        , m_stmt_liquid_output_search(get_stmt(
-              m_is_liquid, m_db, "SELECT assetid, satoshi, abf, vbf FROM LiquidOutput WHERE txid = ?1 AND vout = ?2;"))
-        , m_stmt_liquid_output_insert(get_stmt(m_is_liquid, m_db,
-              "INSERT INTO LiquidOutput (txid, vout, assetid, satoshi, abf, vbf) VALUES (?1, ?2, ?3, ?4, ?5, ?6);"))
-        , m_stmt_key_value_upsert(get_stmt(
-              true, m_db, "INSERT INTO KeyValue(key, value) VALUES (?1, ?2) ON CONFLICT(key) DO UPDATE SET value=?2;"))
-        , m_stmt_key_value_search(get_stmt(true, m_db, KV_SELECT))
-        , m_stmt_key_value_delete(get_stmt(true, m_db, "DELETE FROM KeyValue WHERE key = ?1;"))
     {
+        prepare_statements();
     }
 
     cache::~cache() {}
 
+    void cache::prepare_statements()
+    {
+        m_stmt_liquid_blinding_nonce_search = get_stmt(
+            m_is_liquid, m_db, "SELECT nonce FROM LiquidBlindingNonce WHERE pubkey = ?1 AND script = ?2;");
+        m_stmt_liquid_blinding_nonce_insert = get_stmt(
+            m_is_liquid, m_db, "INSERT INTO LiquidBlindingNonce (pubkey, script, nonce) VALUES (?1, ?2, ?3);");
+        m_stmt_liquid_output_search = get_stmt(
+            m_is_liquid, m_db, "SELECT assetid, satoshi, abf, vbf FROM LiquidOutput WHERE txid = ?1 AND vout = ?2;");
+        m_stmt_liquid_output_insert = get_stmt(m_is_liquid, m_db,
+            "INSERT INTO LiquidOutput (txid, vout, assetid, satoshi, abf, vbf) VALUES (?1, ?2, ?3, ?4, ?5, ?6);");
+        m_stmt_key_value_upsert = get_stmt(
+            true, m_db, "INSERT INTO KeyValue(key, value) VALUES (?1, ?2) ON CONFLICT(key) DO UPDATE SET value=?2;");
+        m_stmt_key_value_search = get_stmt(true, m_db, KV_SELECT);
+        m_stmt_key_value_delete = get_stmt(true, m_db, "DELETE FROM KeyValue WHERE key = ?1;");
+    }
+
     void cache::save_db()
     {
         if (m_db_name.empty() || !m_require_write) {
             return;
         }
         sqlite3_int64 db_size;
-        void* db = sqlite3_serialize(m_db.get(), "main", &db_size, 0);
-        const auto _stmt_clean = gsl::finally([&db] { sqlite3_free(db); });
+        // Our DB is held in serialized form, so we can normally save it
+        // without copying. Fall back to a copy if that isn't possible.
+        void* db = sqlite3_serialize(m_db.get(), "main", &db_size, SQLITE_SERIALIZE_NOCOPY);
+        void* db_copy = nullptr;
+        if (db == nullptr) {
+            db = db_copy = sqlite3_serialize(m_db.get(), "main", &db_size, 0);
+        }
+        const auto _stmt_clean = gsl::finally([&db_copy] { sqlite3_free(db_copy); });
         if (db == nullptr || db_size < 1) {
             return;
         }
         const auto data = gsl::make_span(reinterpret_cast<const unsigned char*>(db), db_size);
         const auto path = get_persistent_storage_file(m_data_dir, m_db_name, VERSION);
-        save_db_file(m_encryption_key, data, path);
-        m_require_write = false;
+        if (save_db_file(m_encryption_key, data, path)) {
+            m_require_write = false;
+        }
     }
 
     void cache::load_db(byte_span_t encryption_key, const uint32_t type)
@@ -297,14 +536,43 @@ namespace sdk {
         m_encryption_key = sha256(encryption_key);
 
         const auto path = get_persistent_storage_file(m_data_dir, m_db_name, VERSION);
-        if (!load_db_impl(m_encryption_key, path, m_db)) {
+        // Finalize our statements while the DB is replaced, since the
+        // loaded DB is deserialized directly into m_db
+        m_stmt_liquid_blinding_nonce_search.reset();
+        m_stmt_liquid_blinding_nonce_insert.reset();
+        m_stmt_liquid_output_search.reset();
+        m_stmt_liquid_output_insert.reset();
+        m_stmt_key_value_upsert.reset();
+        m_stmt_key_value_search.reset();
+        m_stmt_key_value_delete.reset();
+        bool loaded = load_db_impl(m_encryption_key, path, VERSION, m_db);
+        bool migrated = false;
+        if (!loaded && VERSION == 2) {
+            // Version 2 only changed the file format, so a version 1 DB can
+            // be loaded as is and re-saved in the new format
+            const auto prev_path = get_persistent_storage_file(m_data_dir, m_db_name, 1);
+            loaded = migrated = load_db_impl(m_encryption_key, prev_path, 1, m_db);
+        }
+        prepare_statements();
+
+        if (migrated) {
+            m_require_write = true;
+            save_db();
+            if (!m_require_write) {
+                // Saved, so the version 1 file is no longer needed
+                GDK_LOG_SEV(log_level::info) << "Migrated version 1 db file";
+                clean_up_old_db(m_data_dir, m_db_name);
+            }
+        }
+
+        if (!loaded) {
             // Failed to load the latest version.
             if (VERSION > 1) {
                 // Try to carry forward our client blob from the previous version
                 try {
                     const auto prev_path = get_persistent_storage_file(m_data_dir, m_db_name, VERSION - 1);
                     auto db{ get_db() };
-                    if (load_db_impl(m_encryption_key, prev_path, db)) {
+                    if (load_db_impl(m_encryption_key, prev_path, VERSION - 1, db)) {
                         auto stmt{ get_stmt(true, db, KV_SELECT) };
                         const auto _{ stmt_clean(stmt) };
                         const char* blob_key = "client_blob";
@@ -325,7 +593,7 @@ namespace sdk {
             clean_up_old_db(m_data_dir, m_db_name);
         } else {
             // Loaded DB successfully
-            if (VERSION == 1) {
+            if (VERSION == 2) {
                 if (m_is_liquid) {
                     // Remove old assets keys if present. Note we don't bother
                     // marking dirty here, since that would force a write on every
@@ -39,6 +39,8 @@ namespace sdk {
         void load_db(byte_span_t encryption_key, const uint32_t type);
 
     private:
+        void prepare_statements();
+
         const std::string m_network_name;
         const bool m_is_liquid;
         uint32_t m_type; // Set on first call to load_db
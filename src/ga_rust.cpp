@@ -13,6 +13,7 @@
 #include "ga_strings.hpp"
 #include "ga_tor.hpp"
 #include "logging.hpp"
+#include "memory.hpp"
 #include "session.hpp"
 #include "utils.hpp"
 
@@ -109,17 +110,21 @@ namespace sdk {
 
     nlohmann::json ga_rust::call_session(const std::string& method, const nlohmann::json& input) const
     {
-        char* output = nullptr;
-        int res = GDKRUST_call_session(m_session, method.c_str(), input.dump().c_str(), &output);
+        // Pass CBOR rather than JSON text to avoid encoding and decoding
+        // large payloads as strings on both sides
+        const auto input_cbor = nlohmann::json::to_cbor(input);
+        unsigned char* output = nullptr;
+        size_t output_len = 0;
+        int res = GDKRUST_call_session_cbor(
+            m_session, method.c_str(), input_cbor.data(), input_cbor.size(), &output, &output_len);
         if (!output) {
-            // output was not set by calling `std::ffi::CString::into_raw`;
-            // avoid calling GDKRUST_destroy_string.
+            // output was not set by rust; avoid calling GDKRUST_destroy_buffer.
             const auto cppjson = nlohmann::json();
             check_code(res, cppjson);
             return cppjson;
         }
-        const nlohmann::json cppjson = nlohmann::json::parse(output);
-        GDKRUST_destroy_string(output);
+        const auto _free = gsl::finally([output, output_len] { GDKRUST_destroy_buffer(output, output_len); });
+        const nlohmann::json cppjson = nlohmann::json::from_cbor(output, output + output_len);
         check_code(res, cppjson);
         return cppjson;
     }
@@ -420,10 +425,15 @@ namespace sdk {
         GDK_LOG_SEV(log_level::debug) << "ga_rust::create_transaction:" << details.dump();
         nlohmann::json result(details);
 
+        if (result.contains("payouts")) {
+            result["error"] = "payouts are not supported for singlesig wallets";
+            return result;
+        }
+
         auto addressees_p = result.find("addressees");
         if (addressees_p != result.end()) {
             for (auto& addressee : *addressees_p) {
-                // TODO: unify handling with add_tx_addressee
+                // TODO: unify handling with parse_tx_addressee
                 nlohmann::json uri_params;
                 try {
                     uri_params = parse_bitcoin_uri(addressee.at("address"), m_net_params.bip21_prefix());
@@ -526,6 +536,18 @@ namespace sdk {
         return amount::convert(amount_json, currency, rate);
     }
 
+    nlohmann::json ga_rust::convert_amounts(const nlohmann::json& details) const
+    {
+        // Fetch the rate once for all amounts
+        auto currency = details.value("fiat_currency", "USD");
+        auto fallback_rate = details.value("fiat_rate", "");
+        auto currency_query = nlohmann::json({ { "currencies", currency } });
+        auto xrates = call_session("exchange_rates", currency_query)["currencies"];
+        auto fetched_rate = xrates.value(currency, "");
+        auto rate = fetched_rate.empty() ? fallback_rate : fetched_rate;
+        return amount::convert_amounts(details, currency, rate);
+    }
+
     amount ga_rust::get_min_fee_rate() const { throw std::runtime_error("get_min_fee_rate not implemented"); }
     amount ga_rust::get_default_fee_rate() const { throw std::runtime_error("get_default_fee_rate not implemented"); }
     uint32_t ga_rust::get_block_height() const { throw std::runtime_error("get_block_height not implemented"); }
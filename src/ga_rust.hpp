@@ -112,6 +112,7 @@ namespace sdk {
         void ack_system_message(const std::string& message_hash_hex, const std::string& sig_der_hex);
 
         nlohmann::json convert_amount(const nlohmann::json& amount_json) const;
+        nlohmann::json convert_amounts(const nlohmann::json& details) const;
 
         void upload_confidential_addresses(uint32_t subaccount, const std::vector<std::string>& confidential_addresses);
 
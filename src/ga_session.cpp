@@ -1,6 +1,7 @@
 #include <array>
 #include <cstdio>
 #include <fstream>
+#include <future>
 #include <map>
 #include <string>
 #include <thread>
@@ -31,6 +32,7 @@
 #include "transaction_utils.hpp"
 #include "tx_list_cache.hpp"
 #include "utils.hpp"
+#include "utxo_cache.hpp"
 #include "version.h"
 #include "xpub_hdkey.hpp"
 
@@ -142,8 +144,19 @@ namespace sdk {
         static const uint32_t DEFAULT_KEEPINTERVAL = 1; // tcp heartbeat frequency in seconds
         static const uint32_t DEFAULT_KEEPCNT = 2; // tcp unanswered heartbeats
         static const uint32_t DEFAULT_DISCONNECT_WAIT = 2; // maximum wait time on disconnect in seconds
+        static const uint32_t DEFAULT_CLOSE_IO_WAIT = 10; // maximum wait time on closing io in seconds
         static const uint32_t DEFAULT_THREADPOOL_SIZE = 4; // Number of asio pool threads
 
+        // Number of the newest txs to search for a newly notified tx. If it
+        // isn't found the cached UTXOs it affects are removed instead
+        static const uint32_t UTXO_DELTA_TX_WINDOW = 10;
+
+        // Depth of the largest re-org we expect to have missed while disconnected
+        static const uint32_t MAX_REORG_BLOCKS = 144;
+
+        // Maximum number of pre-fetched receive addresses per subaccount and type
+        static const uint32_t MAX_ADDRESS_POOL_SIZE = 100;
+
         static const std::string ZEROS(64, '0');
 
         // Multi-call categories
@@ -467,7 +480,7 @@ namespace sdk {
     uint32_t websocket_rng_type::operator()() const
     {
         uint32_t b;
-        get_random_bytes(sizeof(b), &b, sizeof(b));
+        get_fast_random_bytes(sizeof(b), &b, sizeof(b));
         return b;
     }
 
@@ -494,10 +507,12 @@ namespace sdk {
         : session_impl(net_params, defaults)
         , m_proxy(socksify(net_params.value("proxy", std::string{})))
         , m_has_network_proxy(!m_proxy.empty())
-        , m_io()
+        , m_own_io(get_shared_executor() ? nullptr : new boost::asio::io_context())
+        , m_io(m_own_io ? *m_own_io : get_shared_executor()->next_io_context())
         , m_ping_timer(m_io)
         , m_network_control(new network_control_context())
-        , m_pool(DEFAULT_THREADPOOL_SIZE)
+        , m_own_pool(get_shared_executor() ? nullptr : new boost::asio::thread_pool(DEFAULT_THREADPOOL_SIZE))
+        , m_pool(m_own_pool ? *m_own_pool : get_shared_executor()->pool())
         , m_blob()
         , m_blob_hmac()
         , m_blob_outdated(false)
@@ -510,13 +525,12 @@ namespace sdk {
         , m_system_message_ack_id(0)
         , m_watch_only(true)
         , m_is_locked(false)
-        , m_tx_last_notification(std::chrono::system_clock::now())
         , m_multi_call_category(0)
         , m_cache(m_net_params, net_params.at("name"))
         , m_user_agent(std::string(GDK_COMMIT) + " " + m_net_params.user_agent())
         , m_wamp_call_options()
         , m_wamp_call_prefix("com.greenaddress.")
-        , m_controller(new event_loop_controller(m_io))
+        , m_controller(m_own_io ? new event_loop_controller(m_io) : nullptr)
     {
         constexpr uint32_t wamp_timeout_secs = 10;
         m_wamp_call_options.set_timeout(std::chrono::seconds(wamp_timeout_secs));
@@ -528,15 +542,65 @@ namespace sdk {
     ga_session::~ga_session()
     {
         no_std_exception_escape([this] {
+            // Waiting for the io thread from one of its own handlers would deadlock
+            GDK_RUNTIME_ASSERT(!m_io.get_executor().running_in_this_thread());
             stop_reconnect();
             m_pool.join();
             unsubscribe();
             reset_all_session_data();
             disconnect();
-            m_controller->reset();
+            if (m_controller) {
+                m_controller->reset();
+            } else {
+                close_io();
+            }
         });
     }
 
+    // A shared io context outlives the session, so its pending operations
+    // must be stopped explicitly: close the connection and cancel the ping
+    // timer from the io thread, then wait until every handler that refers to
+    // the session has completed. Gives up if this takes too long, e.g. if a
+    // stuck handler keeps the connection alive
+    void ga_session::close_io()
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(DEFAULT_CLOSE_IO_WAIT);
+        for (;;) {
+            auto closed = std::make_shared<std::promise<bool>>();
+            auto f = closed->get_future();
+            boost::asio::post(m_io, [this, closed] {
+                no_std_exception_escape([this] {
+                    m_ping_timer.cancel();
+                    auto close_socket = [this](auto& clnt) {
+                        websocketpp::lib::error_code ec;
+                        const auto con = clnt.get_con_from_hdl(m_connection_hdl, ec);
+                        if (!ec) {
+                            boost::system::error_code ignored;
+                            con->get_raw_socket().close(ignored);
+                        }
+                    };
+                    if (m_net_params.is_tls_connection()) {
+                        close_socket(*boost::get<std::unique_ptr<client_tls>>(m_client));
+                    } else {
+                        close_socket(*boost::get<std::unique_ptr<client>>(m_client));
+                    }
+                });
+                // The connection is released once none of its operations
+                // remain queued
+                closed->set_value(m_connection_hdl.expired());
+            });
+            const bool is_ready = f.wait_until(deadline) == std::future_status::ready;
+            if (is_ready && f.get()) {
+                break;
+            }
+            if (!is_ready || std::chrono::steady_clock::now() >= deadline) {
+                GDK_LOG_SEV(log_level::error) << "timed out closing session io, pending handlers may remain";
+                return;
+            }
+        }
+        m_io_ops.wait();
+    }
+
     bool ga_session::is_connected() const { return m_transport && m_transport->is_connected(); }
 
     std::string ga_session::get_tor_socks5()
@@ -618,6 +682,8 @@ namespace sdk {
         if (!m_net_params.is_tls_connection()) {
             m_client = std::make_unique<client>();
             boost::get<std::unique_ptr<client>>(m_client)->init_asio(&m_io);
+            boost::get<std::unique_ptr<client>>(m_client)->set_tcp_pre_init_handler(
+                [this](websocketpp::connection_hdl hdl) { m_connection_hdl = hdl; });
             return;
         }
 
@@ -625,6 +691,8 @@ namespace sdk {
         boost::get<std::unique_ptr<client_tls>>(m_client)->init_asio(&m_io);
         const auto host_name = websocketpp::uri(m_net_params.gait_wamp_url()).get_host();
 
+        boost::get<std::unique_ptr<client_tls>>(m_client)->set_tcp_pre_init_handler(
+            [this](websocketpp::connection_hdl hdl) { m_connection_hdl = hdl; });
         boost::get<std::unique_ptr<client_tls>>(m_client)->set_tls_init_handler(
             [this, host_name](const websocketpp::connection_hdl) {
                 return tls_init_handler_impl(
@@ -636,6 +704,7 @@ namespace sdk {
     {
         if (m_net_params.use_tor() && !m_has_network_proxy) {
             m_tor_ctrl = tor_controller::get_shared_ref();
+            m_tor_ctrl->prefetch_onion(m_net_params.get_connection_string());
             m_proxy = m_tor_ctrl->wait_for_socks5(DEFAULT_TOR_SOCKS_WAIT, [&](std::shared_ptr<tor_bootstrap_phase> p) {
                 nlohmann::json tor_json({ { "tag", p->tag }, { "summary", p->summary }, { "progress", p->progress } });
                 emit_notification({ { "event", "tor" }, { "tor", std::move(tor_json) } }, true);
@@ -766,9 +835,9 @@ namespace sdk {
             m_ping_fail_handler();
         }
 
-        using websocketpp::lib::placeholders::_1;
         m_ping_timer.expires_from_now(boost::posix_time::seconds(DEFAULT_PING));
-        m_ping_timer.async_wait(boost::bind(&ga_session::ping_timer_handler, this, _1));
+        m_ping_timer.async_wait(
+            m_io_ops.wrap([this](const boost::system::error_code& ec) { ping_timer_handler(ec); }));
     }
 
     void ga_session::set_heartbeat_timeout_handler(heartbeat_t handler) { m_heartbeat_handler = std::move(handler); }
@@ -778,7 +847,7 @@ namespace sdk {
     void ga_session::emit_notification(nlohmann::json details, bool async)
     {
         if (async) {
-            asio::post(m_pool, [this, details] { emit_notification(details, false); });
+            m_pool.post_ordered([this, details] { emit_notification(details, false); });
         } else {
             session_impl::emit_notification(details, false);
         }
@@ -809,7 +878,7 @@ namespace sdk {
         m_ping_timer.cancel();
         m_network_control->reset();
 
-        boost::asio::post(m_pool, [this] {
+        m_pool.post([this] {
             const auto thread_id = std::this_thread::get_id();
 
             GDK_LOG_SEV(log_level::info) << "reconnect thread " << std::hex << thread_id << " started.";
@@ -878,9 +947,9 @@ namespace sdk {
     void ga_session::start_ping_timer()
     {
         GDK_LOG_SEV(log_level::debug) << "starting ping timer...";
-        using websocketpp::lib::placeholders::_1;
         m_ping_timer.expires_from_now(boost::posix_time::seconds(DEFAULT_PING));
-        m_ping_timer.async_wait(boost::bind(&ga_session::ping_timer_handler, this, _1));
+        m_ping_timer.async_wait(
+            m_io_ops.wrap([this](const boost::system::error_code& ec) { ping_timer_handler(ec); }));
     }
 
     void ga_session::disconnect()
@@ -1059,7 +1128,7 @@ namespace sdk {
                 auto body = refresh_http_data(pages[i], keys[i], refresh);
                 if (i == 0) {
                     // Add the policy asset to asset data
-                    const auto policy_asset = m_net_params.policy_asset();
+                    const auto& policy_asset = m_net_params.policy_asset();
                     body[policy_asset] = { { "asset_id", policy_asset }, { "name", "btc" } };
                 }
                 result.emplace(keys[i], std::move(body));
@@ -1258,6 +1327,7 @@ namespace sdk {
         m_block_height = block_height;
 
         m_subaccounts.clear();
+        m_script_cache.clear();
         m_next_subaccount = 0;
         for (const auto& sa : m_login_data["subaccounts"]) {
             const uint32_t subaccount = sa["pointer"];
@@ -1333,7 +1403,7 @@ namespace sdk {
         m_login_data["wallet_hash_id"] = wallet_hash_id;
 
         // Check that csv blocks used are recoverable and provided by the server
-        const auto net_csv_buckets = m_net_params.csv_buckets();
+        const auto& net_csv_buckets = m_net_params.csv_buckets();
         for (uint32_t bucket : m_login_data["csv_times"]) {
             if (std::find(net_csv_buckets.begin(), net_csv_buckets.end(), bucket) != net_csv_buckets.end()) {
                 m_csv_buckets.insert(m_csv_buckets.end(), bucket);
@@ -1344,6 +1414,9 @@ namespace sdk {
         GDK_RUNTIME_ASSERT(std::find(m_csv_buckets.begin(), m_csv_buckets.end(), m_csv_blocks) != m_csv_buckets.end());
         if (!m_watch_only) {
             m_nlocktime = m_login_data["nlocktime_blocks"];
+            if (is_initial_login) {
+                load_address_pools(locker);
+            }
         }
 
         set_fee_estimates(locker, m_login_data["fee_estimates"]);
@@ -1490,40 +1563,18 @@ namespace sdk {
 
         if (!locker.owns_lock()) {
             // Try again: 'post' this to allow the competing thread to proceed.
-            asio::post(m_pool, [this, subaccounts, details] { on_new_transaction(subaccounts, details); });
+            m_pool.post_ordered([this, subaccounts, details] { on_new_transaction(subaccounts, details); });
             return;
         }
 
         no_std_exception_escape([&]() {
-            using namespace std::chrono_literals;
-
             GDK_RUNTIME_ASSERT(locker.owns_lock());
 
-            const auto now = std::chrono::system_clock::now();
-            if (now < m_tx_last_notification || now - m_tx_last_notification > 60s) {
-                // Time has adjusted, or more than 60s since last notification,
-                // clear any cached notifications to deliver new ones even if
-                // duplicates
-                m_tx_notifications.clear();
-            }
-
-            m_tx_last_notification = now;
-
-            const auto json_str = details.dump();
-            if (std::find(m_tx_notifications.begin(), m_tx_notifications.end(), json_str) != m_tx_notifications.end()) {
-                GDK_LOG_SEV(log_level::debug) << "eliding notification:" << json_str;
+            if (!m_tx_notifications.insert(details)) {
+                GDK_LOG_SEV(log_level::debug) << "eliding notification:" << details.dump();
                 return; // Elide duplicate notifications sent by the server
             }
 
-            m_tx_notifications.emplace_back(json_str); // Record this notification as delivered
-
-            if (m_tx_notifications.size() > 8u) {
-                // Limit the size of notifications to elide. It is extremely unlikely
-                // for unique transactions to be notified fast enough for this to occur,
-                // but we strongly bound the vector size just in case.
-                m_tx_notifications.erase(m_tx_notifications.begin()); // pop the oldest
-            }
-
             for (auto subaccount : subaccounts) {
                 const auto p = m_subaccounts.find(subaccount);
                 // TODO: Handle other logged in sessions creating subaccounts
@@ -1548,12 +1599,87 @@ namespace sdk {
             } else {
                 // TODO: figure out what type is for liquid
             }
-            unique_unlock unlocker(locker);
-            remove_cached_utxos(subaccounts);
-            emit_notification({ { "event", "transaction" }, { "transaction", std::move(details) } }, false);
+            // Updating the cached UTXOs makes WAMP calls, which would block the
+            // io thread this notification may be delivered on. Post it instead,
+            // notifying once the UTXOs are updated.
+            const std::string txhash = details.value("txhash", std::string{});
+            m_pool.post_ordered([this, subaccounts, txhash, details]() mutable {
+                no_std_exception_escape([&] {
+                    update_cached_utxos_from_tx(subaccounts, txhash);
+                    emit_notification({ { "event", "transaction" }, { "transaction", std::move(details) } }, false);
+                });
+            });
         });
     }
 
+    // Apply a new tx to the cached UTXOs of the given subaccounts, instead
+    // of refetching all of them. The tx is fetched once for all subaccounts;
+    // the cached UTXOs of any subaccount it can't be found or applied
+    // consistently for are removed, to be refetched on next use.
+    void ga_session::update_cached_utxos_from_tx(const std::vector<uint32_t>& subaccounts, const std::string& txhash)
+    {
+        std::vector<uint32_t> cached;
+        for (const uint32_t subaccount : subaccounts) {
+            if (get_cached_utxos(subaccount, 0) || get_cached_utxos(subaccount, 1)) {
+                cached.push_back(subaccount);
+            }
+        }
+        if (cached.empty()) {
+            return; // Nothing cached to update
+        }
+
+        nlohmann::json tx;
+        no_std_exception_escape([&] {
+            if (txhash.empty()) {
+                return;
+            }
+            // Fetch the new tx from the front of the tx list. This also
+            // refreshes the front of the tx list cache. The tx endpoints
+            // include those of every subaccount, so one fetch is enough
+            const auto txs = get_raw_transactions(cached.front(), 0, UTXO_DELTA_TX_WINDOW);
+            const auto tx_p = std::find_if(
+                txs.begin(), txs.end(), [&txhash](const auto& t) { return t.at("txhash") == txhash; });
+            if (tx_p != txs.end()) {
+                tx = *tx_p;
+            }
+        });
+
+        if (tx.is_null()) {
+            // The tx is no longer near the front of the tx list, e.g. due
+            // to a burst of new txs: we can't apply it, so invalidate
+            GDK_LOG_SEV(log_level::debug) << "tx " << txhash << " not found, removing cached utxos";
+            remove_cached_utxos(cached);
+            return;
+        }
+
+        for (const uint32_t subaccount : cached) {
+            bool updated = false;
+            no_std_exception_escape([&] {
+                std::vector<utxo_ref_t> spent;
+                nlohmann::json created = utxos_from_tx_endpoints(tx, subaccount, spent);
+                if (spent.empty() && created.empty()) {
+                    return; // No endpoints for this subaccount: can't apply
+                }
+
+                unique_pubkeys_and_scripts_t missing;
+                if (cleanup_utxos(created, txhash, missing)) {
+                    locker_t locker(m_mutex);
+                    m_cache.save_db(); // Cache was updated; save it
+                }
+                if (!missing.empty()) {
+                    return; // Unblinding requires the caller to provide nonces
+                }
+                process_unspent_outputs(created);
+                updated = update_cached_utxos(subaccount, spent, created);
+            });
+
+            if (!updated) {
+                GDK_LOG_SEV(log_level::debug) << "removing cached utxos for subaccount " << subaccount;
+                remove_cached_utxos(std::vector<uint32_t>{ subaccount });
+            }
+        }
+    }
+
     void ga_session::on_new_block(nlohmann::json details)
     {
         auto locker_p{ get_multi_call_locker(MC_TX_CACHE, false) };
@@ -1561,7 +1687,7 @@ namespace sdk {
 
         if (!locker.owns_lock()) {
             // Try again: 'post' this to allow the competing thread to proceed.
-            asio::post(m_pool, [this, details] { on_new_block(details); });
+            m_pool.post_ordered([this, details] { on_new_block(details); });
             return;
         }
 
@@ -1579,6 +1705,9 @@ namespace sdk {
             if (block_height > m_block_height) {
                 m_block_height = block_height;
             }
+            if (block_height == m_block_height || details.value("diverged_count", 0)) {
+                m_block_hash = json_get_value(details, "block_hash");
+            }
 
             unique_unlock unlocker(locker);
             if (details.value("diverged_count", 0)) {
@@ -1654,8 +1783,8 @@ namespace sdk {
             reset_all_session_data();
             throw login_error(res::id_login_failed);
         } else if (!is_initial_login) {
-            // Re-login. Discard all cached data which may be out of date
-            reset_cached_session_data(locker);
+            // Re-login. Discard any cached data which may be out of date
+            reset_cached_session_data(locker, login_data);
         }
 
         const bool is_wallet_locked = json_get_value(login_data, "reset_2fa_active", false);
@@ -1854,23 +1983,51 @@ namespace sdk {
         m_cache.save_db(); // No-op if unchanged
     }
 
-    void ga_session::reset_cached_session_data(session_impl::locker_t& locker)
+    void ga_session::reset_cached_session_data(session_impl::locker_t& locker, const nlohmann::json& login_data)
     {
         GDK_RUNTIME_ASSERT(locker.owns_lock());
-        // FIXME: Reduce the amount of cached data we discard here.
-        // For example, if we haven't missed any blocks since we were
-        // last logged in, then we only need to clear mempool data
-        // (as we may have missed a mempool tx notification)
+        const uint32_t block_height = login_data.at("block_height");
+        const std::string block_hash = login_data.at("block_hash");
+        const std::string prev_block_hash = json_get_value(login_data, "prev_block_hash");
+
+        // We may have missed mempool tx notifications while disconnected,
+        // which can spend any of our cached UTXOs
         remove_cached_utxos(std::vector<uint32_t>());
-        swap_with_default(m_tx_notifications);
-        m_tx_list_caches.purge_all();
         m_nlocktimes.reset();
+
+        if (m_block_hash.empty()) {
+            // We don't know where we were on the chain; discard everything
+            GDK_LOG_SEV(log_level::info) << "reconnect: unknown previous tip, discarding cached txs";
+            m_tx_notifications.clear();
+            m_tx_list_caches.purge_all();
+            return;
+        }
+
+        const bool is_same_tip = block_height == m_block_height && block_hash == m_block_hash;
+        const bool is_next_block = block_height == m_block_height + 1 && prev_block_hash == m_block_hash;
+        if (is_same_tip || is_next_block) {
+            // No blocks were missed, or the chain extends our previous tip:
+            // only mempool data (and the front of the tx list) may have changed
+            GDK_LOG_SEV(log_level::info) << "reconnect: chain unchanged, discarding mempool txs";
+            m_tx_list_caches.on_reconnect(m_block_height + 1);
+            return;
+        }
+
+        // We missed multiple blocks or the chain diverged from our previous
+        // tip. We can't tell where any fork occurred, so discard the txs in
+        // the largest expected re-org below our previous tip
+        const uint32_t fork_height = m_block_height > MAX_REORG_BLOCKS ? m_block_height - MAX_REORG_BLOCKS : 0;
+        GDK_LOG_SEV(log_level::info) << "reconnect: chain moved from " << m_block_height << " to " << block_height
+                                     << ", discarding cached txs from block " << fork_height;
+        m_tx_notifications.clear();
+        m_tx_list_caches.on_reconnect(fork_height);
     }
 
     void ga_session::reset_all_session_data()
     {
         try {
             locker_t locker(m_mutex);
+            save_address_pools(locker);
             m_signer.reset();
             remove_cached_utxos(std::vector<uint32_t>());
             swap_with_default(m_login_data);
@@ -1884,15 +2041,18 @@ namespace sdk {
             swap_with_default(m_limits_data);
             swap_with_default(m_twofactor_config);
             swap_with_default(m_subaccounts);
+            m_script_cache.clear();
+            m_raw_tx_cache.clear();
+            m_address_pool.clear();
             m_ga_pubkeys.reset();
             m_user_pubkeys.reset();
             m_recovery_pubkeys.reset();
             const auto now = std::chrono::system_clock::now();
             m_fee_estimates_ts = now;
-            swap_with_default(m_tx_notifications);
-            m_tx_last_notification = now;
+            m_tx_notifications.clear();
             m_tx_list_caches.purge_all();
             m_nlocktimes.reset();
+            m_block_hash.clear();
         } catch (const std::exception& ex) {
         }
     }
@@ -2018,8 +2178,8 @@ namespace sdk {
             reset_all_session_data();
             throw login_error(res::id_user_not_found_or_invalid);
         } else if (!is_initial_login) {
-            // Re-login. Discard all cached data which may be out of date
-            reset_cached_session_data(locker);
+            // Re-login. Discard any cached data which may be out of date
+            reset_cached_session_data(locker, login_data);
         }
 
         constexpr bool watch_only = true;
@@ -2060,6 +2220,7 @@ namespace sdk {
 
         GDK_RUNTIME_ASSERT(!m_subaccounts.empty());
         GDK_RUNTIME_ASSERT(bip32_xpubs.size() == m_subaccounts.size());
+        m_script_cache.clear(); // User keys may be replaced below
 
         size_t i = 0;
         for (const auto& sa : m_subaccounts) {
@@ -2152,6 +2313,18 @@ namespace sdk {
         return convert_amount(locker, amount_json);
     }
 
+    nlohmann::json ga_session::convert_amounts(const nlohmann::json& details) const
+    {
+        std::string fiat_currency, fiat_rate;
+        {
+            // Snapshot the fiat state so the conversions run unlocked
+            locker_t locker(m_mutex);
+            fiat_currency = m_fiat_currency;
+            fiat_rate = m_fiat_rate;
+        }
+        return amount::convert_amounts(details, fiat_currency, fiat_rate);
+    }
+
     nlohmann::json ga_session::convert_amount(locker_t& locker, const nlohmann::json& amount_json) const
     {
         GDK_RUNTIME_ASSERT(locker.owns_lock());
@@ -2253,6 +2426,7 @@ namespace sdk {
             { "type", type }, { "recovery_pub_key", recovery_pub_key }, { "recovery_chain_code", recovery_chain_code },
             { "recovery_xpub", recovery_xpub }, { "required_ca", required_ca }, { "hidden", is_hidden } };
         m_subaccounts[subaccount] = sa;
+        m_script_cache.invalidate(subaccount);
 
         if (subaccount != 0) {
             // Add user and recovery pubkeys for the subaccount
@@ -2814,7 +2988,7 @@ namespace sdk {
                     if (verify_result == 0) {
                         // Cannot verify because tx height > headers height
                         is_cached = false; // only one blocking header download call per cycle
-                        asio::post(m_pool, [verify_params] {
+                        m_pool.post([verify_params] {
                             // Starts a separate thread to download headers
                             while (true) {
                                 const auto verify_result = spv_verify_tx(verify_params);
@@ -2951,6 +3125,7 @@ namespace sdk {
             locker_t locker(m_mutex);
             m_cache.save_db(); // Cache was updated; save it
         }
+        cache_scripts(utxos);
 
         // Compute the locktime of our UTXOs locally where we can
         bool need_nlocktime_info = false;
@@ -3009,24 +3184,7 @@ namespace sdk {
             }
         }
 
-        // Sort the UTXOs such that the oldest are first, with the default
-        // UTXO selection strategy this reduces the number of re-deposits
-        // users have to do by recycling UTXOs that are closer to expiry.
-        // This also reduces the chance of spending unconfirmed outputs by
-        // pushing them to the end of the selection array.
-        std::for_each(std::begin(asset_utxos), std::end(asset_utxos), [](nlohmann::json& utxos) {
-            std::sort(std::begin(utxos), std::end(utxos), [](const nlohmann::json& lhs, const nlohmann::json& rhs) {
-                const uint32_t lbh = lhs["block_height"];
-                const uint32_t rbh = rhs["block_height"];
-                if (lbh == 0) {
-                    return false;
-                }
-                if (rbh == 0) {
-                    return true;
-                }
-                return lbh < rbh;
-            });
-        });
+        sort_asset_utxos(asset_utxos);
 
         utxos.swap(asset_utxos);
     }
@@ -3076,7 +3234,7 @@ namespace sdk {
     nlohmann::json ga_session::get_transaction_details(const std::string& txhash) const
     {
         try {
-            const std::string tx_data = wamp_cast(wamp_call("txs.get_raw_output", txhash));
+            const std::string tx_data = get_transactions_hex({ txhash }).at(txhash);
             const auto tx = tx_from_hex(tx_data, tx_flags(m_net_params.is_liquid()));
             nlohmann::json ret = { { "txhash", txhash } };
             update_tx_size_info(m_net_params, tx, ret);
@@ -3086,6 +3244,54 @@ namespace sdk {
         }
     }
 
+    // Idempotent
+    // Transactions are served from the raw tx cache where possible. The
+    // server has no call to fetch multiple transactions, so any missing ones
+    // are fetched with pipelined calls rather than a round trip each.
+    nlohmann::json ga_session::get_transactions_hex(const std::vector<std::string>& txhashes) const
+    {
+        nlohmann::json result = nlohmann::json::object();
+        std::vector<std::string> missing;
+        {
+            locker_t locker(m_mutex);
+            for (const auto& txhash : txhashes) {
+                if (result.contains(txhash)) {
+                    continue; // Duplicate
+                }
+                if (const auto cached = m_raw_tx_cache.find(txhash)) {
+                    result.emplace(txhash, *cached);
+                } else {
+                    result.emplace(txhash, nullptr);
+                    missing.emplace_back(txhash);
+                }
+            }
+        }
+
+        // Limit the calls in flight so as not to flood the server
+        constexpr size_t max_calls = 32;
+        const std::string method{ m_wamp_call_prefix + "txs.get_raw_output" };
+        std::vector<boost::future<autobahn::wamp_call_result>> calls;
+        for (size_t i = 0; i < missing.size(); i += max_calls) {
+            const size_t num_calls = std::min(max_calls, missing.size() - i);
+            calls.clear();
+            for (size_t j = i; j < i + num_calls; ++j) {
+                calls.emplace_back(m_session->call(method, std::make_tuple(missing[j]), m_wamp_call_options));
+            }
+            std::vector<std::string> fetched;
+            fetched.reserve(num_calls);
+            for (auto& call : calls) {
+                fetched.emplace_back(wamp_cast(wamp_process_call(call)));
+            }
+
+            locker_t locker(m_mutex);
+            for (size_t j = 0; j < num_calls; ++j) {
+                m_raw_tx_cache.insert(missing[i + j], fetched[j]);
+                result[missing[i + j]] = std::move(fetched[j]);
+            }
+        }
+        return result;
+    }
+
     static script_type set_addr_script_type(nlohmann::json& address, const std::string& addr_type)
     {
         // Add the script type, to allow addresses to be used interchangeably with utxos
@@ -3103,68 +3309,92 @@ namespace sdk {
 
     void ga_session::update_address_info(nlohmann::json& address, bool is_historic)
     {
+        auto addresses = nlohmann::json::array({ std::move(address) });
+        update_addresses_info(addresses, is_historic);
+        address = std::move(addresses[0]);
+    }
+
+    // Verify a page of addresses from the server in a single pass:
+    // Scripts are derived once per address from subaccount xpubs fetched
+    // once per page, and verified on worker threads for large pages.
+    void ga_session::update_addresses_info(nlohmann::json& addresses, bool is_historic)
+    {
+        // The minimum number of addresses to give each worker thread
+        constexpr size_t MIN_ADDRESSES_PER_THREAD = 32;
+
+        struct subaccount_keys {
+            xpub_hdkey ga;
+            xpub_hdkey user;
+            boost::optional<xpub_hdkey> recovery;
+        };
+
+        for (auto& address : addresses) {
+            json_rename_key(address, "ad", "address"); // Returned by wamp call get_my_addresses
+            json_add_if_missing(address, "branch", 1); // FIXME: Remove when all servers updated
+            json_rename_key(address, "addr_type", "address_type");
+            const std::string addr_type = address["address_type"];
+            set_addr_script_type(address, addr_type);
+        }
+
         bool watch_only;
         uint32_t csv_blocks;
         std::vector<uint32_t> csv_buckets;
+        const size_t num_addresses = addresses.size();
+        std::vector<boost::optional<script_cache::entry>> entries(num_addresses);
+        std::vector<size_t> to_derive;
+        std::map<uint32_t, subaccount_keys> keys;
+        uint64_t cache_generation;
         {
             locker_t locker(m_mutex);
+            cache_generation = m_script_cache.generation();
             watch_only = m_watch_only;
             csv_blocks = m_csv_blocks;
             csv_buckets = is_historic ? m_csv_buckets : std::vector<uint32_t>();
-        }
-
-        json_rename_key(address, "ad", "address"); // Returned by wamp call get_my_addresses
-        json_add_if_missing(address, "branch", 1); // FIXME: Remove when all servers updated
-        json_rename_key(address, "addr_type", "address_type");
-
-        const std::string addr_type = address["address_type"];
-        const script_type addr_script_type = set_addr_script_type(address, addr_type);
 
-        if (!address.contains("script") && !watch_only) {
-            // FIXME: get_my_addresses doesn't return script yet. This is
-            // inefficient until the server is updated.
-            address["script"] = b2h(output_script_from_utxo(address));
-        }
-        const auto server_script = h2b(address["script"]);
-        const auto server_address = get_address_from_script(m_net_params, server_script, addr_type);
-
-        if (!watch_only) {
-            // Compute the address locally to verify the servers data
-            const auto script = output_script_from_utxo(address);
-            const auto user_address = get_address_from_script(m_net_params, script, addr_type);
-            GDK_RUNTIME_ASSERT(server_address == user_address);
-            if (address.contains("address")) {
-                GDK_RUNTIME_ASSERT(user_address == address["address"]);
+            if (!watch_only) {
+                // Take cached scripts, and the xpubs to derive the rest from
+                for (size_t i = 0; i < num_addresses; ++i) {
+                    const auto& address = addresses[i];
+                    if (const auto cached = m_script_cache.find(m_net_params, address)) {
+                        entries[i] = *cached;
+                        continue;
+                    }
+                    to_derive.push_back(i);
+                    const uint32_t subaccount = json_get_value(address, "subaccount", 0u);
+                    if (keys.find(subaccount) == keys.end()) {
+                        boost::optional<xpub_hdkey> recovery;
+                        if (get_recovery_pubkeys().have_subaccount(subaccount)) {
+                            recovery = get_recovery_pubkeys().get_subaccount(subaccount);
+                        }
+                        keys.emplace(subaccount,
+                            subaccount_keys{ get_ga_pubkeys().get_subaccount(subaccount),
+                                get_user_pubkeys().get_subaccount(subaccount), std::move(recovery) });
+                    }
+                }
             }
         }
-        address["address"] = server_address;
 
-        if (addr_type == address_type::csv) {
-            // Make sure the csv value used is in our csv buckets. If isn't,
-            // coins held in such scripts may not be recoverable.
-            uint32_t addr_csv_blocks = get_csv_blocks_from_csv_redeem_script(server_script);
-            if (is_historic) {
-                // For historic addresses only check csvtime is in our bucket
-                // list, since the user may have changed their settings.
-                GDK_RUNTIME_ASSERT(
-                    std::find(csv_buckets.begin(), csv_buckets.end(), addr_csv_blocks) != csv_buckets.end());
-            } else {
-                // For new addresses, ensure that the csvtime is the users
-                // current csv_blocks setting. This also ensures it is
-                // one of the bucket values as a side effect.
-                GDK_RUNTIME_ASSERT(addr_csv_blocks == csv_blocks);
+        parallel_for(num_addresses, MIN_ADDRESSES_PER_THREAD, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                auto& address = addresses[i];
+                if (!watch_only && !entries[i]) {
+                    const auto& k = keys.at(json_get_value(address, "subaccount", 0u));
+                    entries[i] = script_cache::make_entry(
+                        m_net_params, k.ga, k.user, k.recovery ? &k.recovery.get() : nullptr, address);
+                }
+                const auto user_script = watch_only ? nullptr : &entries[i]->script;
+                verify_address(m_net_params, address, user_script, is_historic, csv_blocks, csv_buckets);
             }
-        }
-
-        if (m_net_params.is_liquid()) {
-            // we treat the script as a segwit wrapped script, which is the only supported type on Liquid at the moment
-            GDK_RUNTIME_ASSERT(addr_script_type == script_type::ga_p2sh_p2wsh_csv_fortified_out
-                || addr_script_type == script_type::ga_p2sh_p2wsh_fortified_out);
+        });
 
-            const auto witness_program = witness_program_from_bytes(server_script, WALLY_SCRIPT_SHA256);
-            const auto p2sh = scriptpubkey_p2sh_from_hash160(hash160(witness_program));
-            address["blinding_script"] = b2h(p2sh);
-            // The blinding key will be added later once fetched from the sessions signer
+        if (!to_derive.empty()) {
+            // Cache the newly derived scripts, unless subaccounts changed meanwhile
+            locker_t locker(m_mutex);
+            if (m_script_cache.generation() == cache_generation) {
+                for (const auto i : to_derive) {
+                    m_script_cache.insert(m_net_params, addresses[i], std::move(*entries[i]));
+                }
+            }
         }
     }
 
@@ -3175,7 +3405,10 @@ namespace sdk {
 
         for (auto& address : addresses) {
             address["subaccount"] = subaccount;
-            update_address_info(address, true);
+        }
+        update_addresses_info(addresses, true);
+
+        for (auto& address : addresses) {
             json_rename_key(address, "num_tx", "tx_count");
             seen_pointer = address["pointer"];
         }
@@ -3186,19 +3419,145 @@ namespace sdk {
     {
         const uint32_t subaccount = details.value("subaccount", 0);
         const std::string addr_type_ = details.value("address_type", std::string{});
+        const uint32_t pool_size = std::min(details.value("pool_size", 0u), MAX_ADDRESS_POOL_SIZE);
 
         const std::string addr_type = addr_type_.empty() ? get_default_address_type(subaccount) : addr_type_;
         GDK_RUNTIME_ASSERT_MSG(
             addr_type == address_type::p2sh || addr_type == address_type::p2wsh || addr_type == address_type::csv,
             "Unknown address type");
 
-        constexpr bool return_pointer = true;
-        auto address = wamp_cast_json(wamp_call("vault.fund", subaccount, return_pointer, addr_type));
-        update_address_info(address, false);
-        GDK_RUNTIME_ASSERT(address["address_type"] == addr_type);
+        if (pool_size == 0) {
+            return std::move(fetch_receive_addresses(subaccount, addr_type, 1).at(0));
+        }
+
+        const address_pool::key_t key{ subaccount, addr_type };
+        nlohmann::json address;
+        uint32_t refill_count;
+        uint64_t epoch;
+        {
+            locker_t locker(m_mutex);
+            epoch = m_address_pool.epoch(key);
+            address = m_address_pool.take(key, pool_size, refill_count);
+        }
+
+        if (address.is_null()) {
+            // Pool is empty: fetch an address for the caller, along with a
+            // full pool unless another caller is already refilling it
+            const auto refill_done = gsl::finally([this, &key, refill_count] {
+                if (refill_count != 0) {
+                    locker_t locker(m_mutex);
+                    m_address_pool.refill_done(key);
+                }
+            });
+            auto addresses = fetch_receive_addresses(subaccount, addr_type, refill_count + 1);
+            address = std::move(addresses[0]);
+            addresses.erase(addresses.begin());
+            if (refill_count != 0) {
+                locker_t locker(m_mutex);
+                m_address_pool.add(key, std::move(addresses), epoch);
+            }
+        } else if (refill_count != 0) {
+            m_pool.post([this, subaccount, addr_type, refill_count, epoch] {
+                refill_address_pool(subaccount, addr_type, refill_count, epoch);
+            });
+        }
         return address;
     }
 
+    // Generate new addresses, verifying them as a batch. The server has no
+    // call to generate multiple addresses, so the calls are pipelined instead.
+    nlohmann::json ga_session::fetch_receive_addresses(
+        uint32_t subaccount, const std::string& addr_type, uint32_t count)
+    {
+        constexpr bool return_pointer = true;
+        const std::string method{ m_wamp_call_prefix + "vault.fund" };
+        std::vector<boost::future<autobahn::wamp_call_result>> calls;
+        calls.reserve(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            calls.emplace_back(m_session->call(
+                method, std::make_tuple(subaccount, return_pointer, addr_type), m_wamp_call_options));
+        }
+        nlohmann::json addresses = nlohmann::json::array();
+        for (auto& call : calls) {
+            addresses.push_back(wamp_cast_json(wamp_process_call(call)));
+        }
+
+        update_addresses_info(addresses, false);
+
+        std::shared_ptr<signer> signer;
+        if (m_net_params.is_liquid()) {
+            signer = get_signer();
+        }
+        for (auto& address : addresses) {
+            GDK_RUNTIME_ASSERT(address["address_type"] == addr_type);
+            if (signer && signer->has_master_blinding_key()) {
+                // Pre-compute the blinding key, saving the caller a round trip
+                const auto blinding_script = h2b(address.at("blinding_script"));
+                address["blinding_key"] = b2h(signer->get_blinding_pubkey_from_script(blinding_script));
+            }
+        }
+        return addresses;
+    }
+
+    void ga_session::refill_address_pool(
+        uint32_t subaccount, const std::string& addr_type, uint32_t count, uint64_t epoch)
+    {
+        const address_pool::key_t key{ subaccount, addr_type };
+        nlohmann::json addresses;
+        try {
+            addresses = fetch_receive_addresses(subaccount, addr_type, count);
+        } catch (const std::exception& e) {
+            // The pool will be refilled on demand instead
+            GDK_LOG_SEV(log_level::warning) << "address pool refill failed: " << e.what();
+        }
+
+        locker_t locker(m_mutex);
+        m_address_pool.refill_done(key);
+        if (addresses.is_array()) {
+            m_address_pool.add(key, std::move(addresses), epoch);
+        }
+    }
+
+    // Save any unused pooled addresses, so that their pointers are not skipped
+    // when the wallet next logs in
+    void ga_session::save_address_pools(locker_t& locker)
+    {
+        GDK_RUNTIME_ASSERT(locker.owns_lock());
+        auto pools = m_address_pool.get_all();
+        if (pools.empty()) {
+            return;
+        }
+        const nlohmann::json saved = { { "csv_blocks", m_csv_blocks }, { "pools", std::move(pools) } };
+        m_cache.upsert_key_value("address_pools", nlohmann::json::to_msgpack(saved));
+        m_cache.save_db();
+    }
+
+    void ga_session::load_address_pools(locker_t& locker)
+    {
+        GDK_RUNTIME_ASSERT(locker.owns_lock());
+        bool found = false;
+        m_cache.get_key_value("address_pools", { [this, &found](const auto& db_blob) {
+            if (db_blob) {
+                found = true;
+                try {
+                    const auto saved = nlohmann::json::from_msgpack(db_blob.get().begin(), db_blob.get().end());
+                    m_address_pool.restore(saved.at("pools"));
+                    if (saved.at("csv_blocks") != m_csv_blocks) {
+                        // Saved csv addresses use the old value
+                        m_address_pool.clear(address_type::csv);
+                    }
+                } catch (const std::exception& e) {
+                    GDK_LOG_SEV(log_level::warning) << "Error reading address pools: " << e.what();
+                }
+            }
+        } });
+        if (found) {
+            // Remove the saved addresses so they can't be handed out twice
+            m_cache.clear_key_value("address_pools");
+            m_cache.save_db();
+        }
+    }
+
     // Idempotent
     nlohmann::json ga_session::get_available_currencies() const
     {
@@ -3582,8 +3941,9 @@ namespace sdk {
     std::vector<unsigned char> ga_session::output_script_from_utxo(const nlohmann::json& utxo)
     {
         locker_t locker(m_mutex);
-        return ::ga::sdk::output_script_from_utxo(
-            m_net_params, get_ga_pubkeys(), get_user_pubkeys(), get_recovery_pubkeys(), utxo);
+        return m_script_cache
+            .get(m_net_params, get_ga_pubkeys(), get_user_pubkeys(), get_recovery_pubkeys(), utxo)
+            .script;
     }
 
     std::vector<pub_key_t> ga_session::pubkeys_from_utxo(const nlohmann::json& utxo)
@@ -3591,11 +3951,29 @@ namespace sdk {
         const uint32_t subaccount = utxo.at("subaccount");
         const uint32_t pointer = utxo.at("pointer");
         locker_t locker(m_mutex);
-        // TODO: consider returning the recovery key (2of3) as well
+        if (utxo.contains("script_type")) {
+            // TODO: consider returning the recovery key (2of3) as well
+            const auto& pubkeys
+                = m_script_cache
+                      .get(m_net_params, get_ga_pubkeys(), get_user_pubkeys(), get_recovery_pubkeys(), utxo)
+                      .pubkeys;
+            return std::vector<pub_key_t>(pubkeys.begin(), pubkeys.begin() + 2);
+        }
         return std::vector<pub_key_t>(
             { get_ga_pubkeys().derive(subaccount, pointer), get_user_pubkeys().derive(subaccount, pointer) });
     }
 
+    // Pre-compute the scripts for UTXOs or addresses that will be used
+    // together, taking the session lock only once
+    void ga_session::cache_scripts(const nlohmann::json& utxos)
+    {
+        locker_t locker(m_mutex);
+        if (m_watch_only || !m_user_pubkeys) {
+            return; // Can't derive user keys
+        }
+        m_script_cache.fill(m_net_params, get_ga_pubkeys(), get_user_pubkeys(), get_recovery_pubkeys(), utxos);
+    }
+
     nlohmann::json ga_session::create_transaction(const nlohmann::json& details)
     {
         try {
@@ -3690,6 +4068,7 @@ namespace sdk {
         GDK_RUNTIME_ASSERT(wamp_cast<bool>(result));
 
         m_csv_blocks = value;
+        m_address_pool.clear(address_type::csv); // Pooled csv addresses use the old value
     }
 
     void ga_session::set_nlocktime(const nlohmann::json& locktime_details, const nlohmann::json& twofactor_data)
@@ -8,13 +8,18 @@
 #include <string>
 #include <vector>
 
+#include "address_pool.hpp"
 #include "amount.hpp"
 #include "client_blob.hpp"
+#include "executor.hpp"
 #include "ga_cache.hpp"
 #include "ga_wally.hpp"
+#include "notifications.hpp"
+#include "script_cache.hpp"
 #include "session_impl.hpp"
 #include "signer.hpp"
 #include "threading.hpp"
+#include "tx_cache.hpp"
 #include "tx_list_cache.hpp"
 
 using namespace std::literals;
@@ -128,6 +133,7 @@ namespace sdk {
             const std::string& private_key, const std::string& password, uint32_t unused);
         nlohmann::json set_unspent_outputs_status(const nlohmann::json& details, const nlohmann::json& twofactor_data);
         nlohmann::json get_transaction_details(const std::string& txhash) const;
+        nlohmann::json get_transactions_hex(const std::vector<std::string>& txhashes) const;
         tx_list_cache::container_type get_raw_transactions(uint32_t subaccount, uint32_t first, uint32_t count);
 
         nlohmann::json create_transaction(const nlohmann::json& details);
@@ -152,6 +158,7 @@ namespace sdk {
         void ack_system_message(const std::string& message_hash_hex, const std::string& sig_der_hex);
 
         nlohmann::json convert_amount(const nlohmann::json& amount_json) const;
+        nlohmann::json convert_amounts(const nlohmann::json& details) const;
 
         bool set_blinding_nonce(
             const std::string& pubkey_hex, const std::string& script_hex, const std::string& nonce_hex);
@@ -176,6 +183,7 @@ namespace sdk {
 
         std::vector<unsigned char> output_script_from_utxo(const nlohmann::json& utxo);
         std::vector<pub_key_t> pubkeys_from_utxo(const nlohmann::json& utxo);
+        void cache_scripts(const nlohmann::json& utxos);
 
         std::pair<std::string, bool> get_cached_master_blinding_key();
         void set_cached_master_blinding_key(const std::string& master_blinding_key_hex);
@@ -183,7 +191,7 @@ namespace sdk {
         void encache_signer_xpubs(std::shared_ptr<signer> signer);
 
     private:
-        void reset_cached_session_data(locker_t& locker);
+        void reset_cached_session_data(locker_t& locker, const nlohmann::json& login_data);
         void reset_all_session_data();
 
         bool is_connected() const;
@@ -223,6 +231,7 @@ namespace sdk {
 
         std::unique_ptr<locker_t> get_multi_call_locker(uint32_t category_flags, bool wait_for_lock);
         void on_new_transaction(const std::vector<uint32_t>& subaccounts, nlohmann::json details);
+        void update_cached_utxos_from_tx(const std::vector<uint32_t>& subaccounts, const std::string& txhash);
         void on_new_block(nlohmann::json details);
         void on_new_tickers(nlohmann::json details);
         void change_settings_pricing_source(locker_t& locker, const std::string& currency, const std::string& exchange);
@@ -242,6 +251,11 @@ namespace sdk {
         nlohmann::json refresh_http_data(const std::string& page, const std::string& key, bool refresh);
 
         void update_address_info(nlohmann::json& address, bool is_historic);
+        void update_addresses_info(nlohmann::json& addresses, bool is_historic);
+        nlohmann::json fetch_receive_addresses(uint32_t subaccount, const std::string& addr_type, uint32_t count);
+        void refill_address_pool(uint32_t subaccount, const std::string& addr_type, uint32_t count, uint64_t epoch);
+        void save_address_pools(locker_t& locker);
+        void load_address_pools(locker_t& locker);
         std::shared_ptr<nlocktime_t> update_nlocktime_info();
 
         void set_local_encryption_keys(locker_t& locker, const pub_key_t& public_key, std::shared_ptr<signer> signer);
@@ -283,11 +297,13 @@ namespace sdk {
         std::vector<unsigned char> get_pin_password(const std::string& pin, const std::string& pin_identifier);
 
         void ping_timer_handler(const boost::system::error_code& ec);
+        void close_io();
 
         std::string m_proxy;
         const bool m_has_network_proxy;
 
-        boost::asio::io_context m_io;
+        std::unique_ptr<boost::asio::io_context> m_own_io; // Unset when using the shared executor
+        boost::asio::io_context& m_io;
         boost::variant<std::unique_ptr<client>, std::unique_ptr<client_tls>> m_client;
         transport_t m_transport;
         wamp_session_ptr m_session;
@@ -296,9 +312,12 @@ namespace sdk {
         ping_fail_t m_ping_fail_handler;
 
         boost::asio::deadline_timer m_ping_timer;
+        websocketpp::connection_hdl m_connection_hdl; // Only accessed from the io thread
+        pending_ops m_io_ops; // Handlers on m_io that refer to this session
 
         std::unique_ptr<network_control_context> m_network_control;
-        boost::asio::thread_pool m_pool;
+        std::unique_ptr<boost::asio::thread_pool> m_own_pool; // Unset when using the shared executor
+        task_group m_pool;
 
         nlohmann::json m_login_data;
         boost::optional<pbkdf2_hmac512_t> m_local_encryption_key;
@@ -329,17 +348,21 @@ namespace sdk {
         std::vector<uint32_t> m_fee_estimates;
         std::chrono::system_clock::time_point m_fee_estimates_ts;
         uint32_t m_block_height;
+        std::string m_block_hash; // Hash of the tip at m_block_height, if known
 
         uint32_t m_system_message_id; // Next system message
         uint32_t m_system_message_ack_id; // Currently returned message id to ack
         std::string m_system_message_ack; // Currently returned message to ack
         bool m_watch_only;
         bool m_is_locked;
-        std::vector<std::string> m_tx_notifications;
-        std::chrono::system_clock::time_point m_tx_last_notification;
+        tx_notification_filter m_tx_notifications;
 
         uint32_t m_multi_call_category;
         tx_list_caches m_tx_list_caches;
+        script_cache m_script_cache;
+        mutable raw_tx_cache m_raw_tx_cache;
+
+        address_pool m_address_pool; // Pre-fetched receive addresses
         std::shared_ptr<nlocktime_t> m_nlocktimes;
 
         std::shared_ptr<tor_controller> m_tor_ctrl;
@@ -646,6 +646,9 @@ namespace sdk {
         const std::string id_password{ "id_password" }; // Password
         const std::string id_password_protected{ "id_password_protected" }; // Password protected
         const std::string id_paste{ "id_paste" }; // Paste
+        const std::string id_payouts_cannot_be_used_to{
+            "id_payouts_cannot_be_used_to"
+        }; // Payouts cannot be used to redeposit, bump or sweep
         const std::string id_pgp_key{ "id_pgp_key" }; // PGP key
         const std::string id_phone_call{ "id_phone_call" }; // Phone call
         const std::string id_phone_number{ "id_phone_number" }; // phone number
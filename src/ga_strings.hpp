@@ -404,6 +404,7 @@ namespace sdk {
         extern const std::string id_password;
         extern const std::string id_password_protected;
         extern const std::string id_paste;
+        extern const std::string id_payouts_cannot_be_used_to;
         extern const std::string id_pgp_key;
         extern const std::string id_phone_call;
         extern const std::string id_phone_number;
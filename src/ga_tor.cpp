@@ -14,6 +14,7 @@
 
 #include <condition_variable>
 #include <cstdio>
+#include <set>
 #include <stdlib.h>
 #include <string>
 #include <vector>
@@ -40,34 +41,6 @@ namespace sdk {
     std::mutex tor_controller::s_inst_mutex;
     std::weak_ptr<tor_controller> tor_controller::s_inst;
 
-    static std::string read_file(std::string fname)
-    {
-        std::FILE* fp = std::fopen(fname.c_str(), "rb");
-        std::string res;
-        if (fp) {
-            std::fseek(fp, 0, SEEK_END);
-
-            size_t size = std::ftell(fp);
-            res.resize(size);
-
-            std::rewind(fp);
-
-            size_t read = std::fread(&res[0], 1, res.size(), fp);
-            GDK_RUNTIME_ASSERT(read == size);
-
-            std::fclose(fp);
-        }
-        return res;
-    }
-
-    static void clear_file(std::string fname)
-    {
-        std::FILE* fp = std::fopen(fname.c_str(), "wb");
-        if (fp) {
-            std::fclose(fp);
-        }
-    }
-
     static std::pair<std::string, std::string> split_tor_reply_line(const std::string& s)
     {
         size_t ptr = 0;
@@ -174,11 +147,7 @@ namespace sdk {
     }
 
     static const int MAX_LINE_LENGTH = 100000;
-    static const int TOR_NONCE_SIZE = 32;
-    static const std::string TOR_SAFE_SERVERKEY = "Tor safe cookie authentication server-to-controller hash";
-    static const std::string TOR_SAFE_CLIENTKEY = "Tor safe cookie authentication controller-to-server hash";
-    static const std::string TOR_CONTROL_PORT_TAG("PORT=");
-    static const std::string LOCALHOST_SOCKS5_UNTIL_PORT("socks5://127.0.0.1:");
+    static const std::string ONION_SUFFIX(".onion");
 
     struct tor_control_reply {
         tor_control_reply();
@@ -192,10 +161,10 @@ namespace sdk {
         typedef std::function<void(tor_control_connection&)> ConnectionCB;
         typedef std::function<void(tor_control_connection&, const tor_control_reply&)> ReplyHandlerCB;
 
-        explicit tor_control_connection(struct event_base* base, const std::string& _tor_control_port);
+        explicit tor_control_connection(struct event_base* base);
         ~tor_control_connection();
 
-        bool connect(const ConnectionCB& connected, const ConnectionCB& disconnected);
+        bool connect(evutil_socket_t fd, const ConnectionCB& connected, const ConnectionCB& disconnected);
 
         void disconnect();
 
@@ -209,7 +178,6 @@ namespace sdk {
 
         struct event_base* m_base;
         struct bufferevent* m_b_conn;
-        const std::string& m_tor_control_port;
 
         tor_control_reply m_message;
 
@@ -220,12 +188,15 @@ namespace sdk {
     };
 
     struct tor_controller_impl {
-        tor_controller_impl(const std::string& socks5_port);
+        tor_controller_impl();
         ~tor_controller_impl();
 
         std::string wait_for_socks5(
             uint32_t timeout, std::function<void(std::shared_ptr<tor_bootstrap_phase>)> phase_cb);
 
+        void set_dormant(bool dormant);
+        void prefetch_onion(const std::string& onion_host);
+
     private:
         std::thread m_tor_run_thread;
         std::thread m_tor_control_thread;
@@ -233,37 +204,32 @@ namespace sdk {
         std::mutex m_init_mutex;
         struct event_base* m_base;
         std::string m_tor_datadir;
-        const std::string m_tor_control_file;
-        std::string m_tor_control_port;
+        std::vector<const char*> m_tor_argv;
         std::unique_ptr<tor_control_connection> m_conn;
         bool m_stopping;
 
-        std::vector<uint8_t> m_cookie;
-        std::array<uint8_t, TOR_NONCE_SIZE> m_client_nonce;
-
         // Tor's socks5 listener, empty if not ready yet
         std::string m_socks5;
 
         // Latest bootstrap phase
         std::shared_ptr<tor_bootstrap_phase> m_bootstrap_phase;
 
+        // Onion services to keep warm. Only accessed from the event loop thread
+        std::set<std::string> m_onions;
+        bool m_bootstrapped;
+
         // All the callbacks used to receive asynchronous replies from Tor. The "flow" is as follows:
         //
-        // We give `tor_control_connection` our `connected_cb` and `disconnected_cb`, so these are the two
-        // possible "entry points" that start the chain of callbacks on our side.
+        // Tor gives us a pre-authenticated control socket when it is configured, which we wrap in a
+        // `tor_control_connection`, passing our `connected_cb` and `disconnected_cb`.
         //
-        // `connected_cb`: As soon as the control connection is ready, our `connected_cb` gets called: first thing it
-        //     does is asking Tor which protocols it supports, and sets `protocolinfo_cb` as the handler for the reply
-        // `protocolinfo_cb`: This callback reads the AUTHCOOKIE from disk and starts the authentication challenge
-        //     protocol.
-        // `authchallenge_cb`: This callback does all the crypto stuff (HMACs, etc) and then tries to authenticate
-        // `auth_cb`: This callback receives the result of the authentication. It ensures that everything
-        //     went fine, and since Tor has been running in background for all this time, it asks for the current
-        //     bootstrap phase, to see whether it is already connected or not.
-        // `bootstrap_phase_cb`: This callback receives the result of a bootstrap phase query. It has two possible
-        //     outcomes:
-        //         if the "progress" has reached 100, it asks tor for the socks5 port and sets `socks_cb` as callback
-        //         otherwise it sleeps for 250ms and then asks for the bootstrap phase again
+        // `connected_cb`: Subscribes to STATUS_CLIENT events so Tor tells us about bootstrap progress, and sets
+        //     `events_cb` as the handler for the reply
+        // `events_cb`: Asks for the current bootstrap phase, in case Tor had already bootstrapped from its cached
+        //     state before we subscribed.
+        // `bootstrap_phase_cb`/`async_cb`: These receive the current bootstrap phase, either as a reply to our query
+        //     or as an asynchronous BOOTSTRAP event. Once "progress" reaches 100, we ask tor for the socks5 port
+        //     and set `socks_cb` as callback, then start fetching descriptors for our onion services.
         // `socks_cb`: This is the last callback, which copies the socks5 listener into our internal field and finally
         //     completes the "chain reaction.
         //
@@ -272,14 +238,18 @@ namespace sdk {
         // `stopped_cb` is called when the `HALT` command is acknowledged by Tor, meaning that it is shutting down
 
         void connected_cb(tor_control_connection& conn);
-        void protocolinfo_cb(tor_control_connection& conn, const tor_control_reply& reply);
-        void authchallenge_cb(tor_control_connection& conn, const tor_control_reply& reply);
-        void auth_cb(tor_control_connection& conn, const tor_control_reply& reply);
+        void events_cb(tor_control_connection& conn, const tor_control_reply& reply);
         void bootstrap_phase_cb(tor_control_connection& conn, const tor_control_reply& reply);
+        void async_cb(tor_control_connection& conn, const tor_control_reply& reply);
+        void update_bootstrap_phase(tor_control_connection& conn, std::map<std::string, std::string>& m);
         void socks_cb(const tor_control_reply& reply);
+        void fetch_onion_descriptors(tor_control_connection& conn);
 
         void disconnected_cb();
         void stopped_cb();
+
+        // Run fn on the event loop thread
+        void post(std::function<void()> fn);
     };
     tor_control_reply::tor_control_reply() { clear(); }
 
@@ -298,10 +268,9 @@ namespace sdk {
         progress = 0;
     }
 
-    tor_control_connection::tor_control_connection(struct event_base* _base, const std::string& _tor_control_port)
+    tor_control_connection::tor_control_connection(struct event_base* _base)
         : m_base(_base)
         , m_b_conn(nullptr)
-        , m_tor_control_port(_tor_control_port)
     {
     }
 
@@ -377,24 +346,16 @@ namespace sdk {
         }
     }
 
-    bool tor_control_connection::connect(const ConnectionCB& _connected, const ConnectionCB& _disconnected)
+    bool tor_control_connection::connect(
+        evutil_socket_t fd, const ConnectionCB& _connected, const ConnectionCB& _disconnected)
     {
         if (m_b_conn)
             disconnect();
 
-        // Parse target address:port
-        struct sockaddr_storage connect_to_addr;
-        int connect_to_addrlen = sizeof(connect_to_addr);
-        if (evutil_parse_sockaddr_port(
-                m_tor_control_port.c_str(), (struct sockaddr*)&connect_to_addr, &connect_to_addrlen)
-            < 0) {
-            GDK_LOG_SEV(log_level::info) << "tor: Error parsing socket address " << m_tor_control_port;
-            return false;
-        }
-        GDK_LOG_SEV(log_level::info) << "tor: connecting to controller " << m_tor_control_port;
+        GDK_LOG_SEV(log_level::info) << "tor: connecting to controller";
 
-        // Create a new socket, set up callbacks and enable notification bits
-        m_b_conn = bufferevent_socket_new(m_base, -1, BEV_OPT_CLOSE_ON_FREE);
+        // The socket is already connected, so set up callbacks and notification bits
+        m_b_conn = bufferevent_socket_new(m_base, fd, BEV_OPT_CLOSE_ON_FREE);
         if (!m_b_conn)
             return false;
         bufferevent_setcb(m_b_conn, tor_control_connection::readcb, nullptr, tor_control_connection::eventcb, this);
@@ -402,11 +363,7 @@ namespace sdk {
         this->m_connected = _connected;
         this->m_disconnected = _disconnected;
 
-        // Finally, connect to target
-        if (bufferevent_socket_connect(m_b_conn, (struct sockaddr*)&connect_to_addr, connect_to_addrlen) < 0) {
-            GDK_LOG_SEV(log_level::info) << "tor: Error connecting to address " << m_tor_control_port;
-            return false;
-        }
+        this->m_connected(*this);
         return true;
     }
 
@@ -443,75 +400,47 @@ namespace sdk {
         return event_base_new();
     }
 
-    static std::string get_tor_control_port(const std::string& tor_control_file)
-    {
-        std::string tor_control_port;
-        uint32_t attempts = 10;
-        do {
-            GDK_RUNTIME_ASSERT(attempts);
-            tor_control_port = read_file(tor_control_file);
-            if (tor_control_port.empty()) {
-                std::this_thread::sleep_for(100ms);
-                --attempts;
-            }
-        } while (tor_control_port.empty());
-
-        GDK_LOG_SEV(log_level::info) << "tor_control port " << tor_control_port;
-        GDK_RUNTIME_ASSERT(tor_control_port.size() > TOR_CONTROL_PORT_TAG.size());
-        tor_control_port.erase(0, TOR_CONTROL_PORT_TAG.size());
-        return tor_control_port;
-    }
-
-    static std::string get_tor_control_file(const std::string& tor_datadir)
-    {
-        std::string tor_control_file = tor_datadir + "/.torcontrol";
-
-        GDK_LOG_SEV(log_level::info) << "Using '" << tor_datadir << "' as Tor datadir";
-
-        clear_file(tor_control_file);
-        return tor_control_file;
-    }
-
-    tor_controller_impl::tor_controller_impl(const std::string& socks5_port)
+    tor_controller_impl::tor_controller_impl()
         : m_base(init_eb())
         , m_tor_datadir(std::string(gdk_config().at("datadir")) + "/tor")
-        , m_tor_control_file(get_tor_control_file(m_tor_datadir))
         , m_stopping(false)
+        , m_bootstrapped(false)
     {
         GDK_LOG_SEV(log_level::info) << "Starting up internal Tor";
-
-        const std::string conf_socks_port = socks5_port.empty() ? "auto" : socks5_port;
-
-        m_tor_run_thread = std::thread([&] {
-            tor_main_configuration_t* tor_conf = tor_main_configuration_new();
-            GDK_RUNTIME_ASSERT(tor_conf);
-            std::vector<const char*> argv_conf;
-            argv_conf.reserve(17);
-            argv_conf.push_back("tor");
-            argv_conf.push_back("__DisableSignalHandlers");
-            argv_conf.push_back("1");
-            argv_conf.push_back("SafeSocks");
-            argv_conf.push_back("1");
-            argv_conf.push_back("SocksPort");
-            argv_conf.push_back(conf_socks_port.c_str());
-            argv_conf.push_back("NoExec");
-            argv_conf.push_back("1");
-            argv_conf.push_back("ControlPortWriteToFile");
-            argv_conf.push_back(m_tor_control_file.c_str());
-            argv_conf.push_back("CookieAuthentication");
-            argv_conf.push_back("1");
-            argv_conf.push_back("ControlPort");
-            argv_conf.push_back("auto");
-            argv_conf.push_back("DataDirectory");
-            argv_conf.push_back(m_tor_datadir.c_str());
-#if not defined(NDEBUG)
-            argv_conf.push_back("Log");
-            argv_conf.push_back("notice"); // debug prints out way too much stuff and we don't really need them
-#endif
-            int conf_res
-                = tor_main_configuration_set_command_line(tor_conf, argv_conf.size(), (char**)argv_conf.data());
-            GDK_RUNTIME_ASSERT(!conf_res);
-
+        GDK_LOG_SEV(log_level::info) << "Using '" << m_tor_datadir << "' as Tor datadir";
+
+        tor_main_configuration_t* tor_conf = tor_main_configuration_new();
+        GDK_RUNTIME_ASSERT(tor_conf);
+
+        // Tor gives us a pre-authenticated controller socket, so there is no
+        // control port file to wait for or cookie to authenticate with
+        const tor_control_socket_t control_socket = tor_main_configuration_setup_control_socket(tor_conf);
+        GDK_RUNTIME_ASSERT(control_socket != INVALID_TOR_CONTROL_SOCKET);
+
+        // Note Tor does not copy the command line, so it must outlive tor_run_main
+        m_tor_argv.reserve(16);
+        m_tor_argv.push_back("tor");
+        m_tor_argv.push_back("__DisableSignalHandlers");
+        m_tor_argv.push_back("1");
+        m_tor_argv.push_back("SafeSocks");
+        m_tor_argv.push_back("1");
+        m_tor_argv.push_back("SocksPort");
+        m_tor_argv.push_back("auto");
+        m_tor_argv.push_back("NoExec");
+        m_tor_argv.push_back("1");
+        // Don't stay dormant if we were stopped while sleeping, since the
+        // dormant state is persisted in the data directory
+        m_tor_argv.push_back("DormantCanceledByStartup");
+        m_tor_argv.push_back("1");
+        m_tor_argv.push_back("DataDirectory");
+        m_tor_argv.push_back(m_tor_datadir.c_str());
+        m_tor_argv.push_back("Log");
+        m_tor_argv.push_back("notice"); // debug prints out way too much stuff and we don't really need them
+        const int conf_res
+            = tor_main_configuration_set_command_line(tor_conf, m_tor_argv.size(), (char**)m_tor_argv.data());
+        GDK_RUNTIME_ASSERT(!conf_res);
+
+        m_tor_run_thread = std::thread([this, tor_conf] {
             GDK_LOG_SEV(log_level::info) << "tor_run_main begins";
             tor_run_main(tor_conf);
             GDK_LOG_SEV(log_level::info) << "tor_run_main exited";
@@ -523,13 +452,15 @@ namespace sdk {
 
         GDK_LOG_SEV(log_level::info) << "Tor thread started";
 
-        m_tor_control_port = get_tor_control_port(m_tor_control_file);
-        m_conn = std::make_unique<tor_control_connection>(m_base, m_tor_control_port);
+        m_conn = std::make_unique<tor_control_connection>(m_base);
 
         m_bootstrap_phase = std::make_shared<tor_bootstrap_phase>();
 
-        GDK_RUNTIME_ASSERT(m_conn->connect(std::bind(&tor_controller_impl::connected_cb, this, std::placeholders::_1),
-            std::bind(&tor_controller_impl::disconnected_cb, this)));
+        m_conn->m_async_handler.connect(
+            std::bind(&tor_controller_impl::async_cb, this, std::placeholders::_1, std::placeholders::_2));
+        GDK_RUNTIME_ASSERT(
+            m_conn->connect(control_socket, std::bind(&tor_controller_impl::connected_cb, this, std::placeholders::_1),
+                std::bind(&tor_controller_impl::disconnected_cb, this)));
 
         m_tor_control_thread = std::thread([_m_base = this->m_base] {
             event_base_dispatch(_m_base);
@@ -564,95 +495,54 @@ namespace sdk {
 
     void tor_controller_impl::connected_cb(tor_control_connection& _conn)
     {
-        // First send a PROTOCOLINFO command to figure out what authentication is expected
-        if (!_conn.command("PROTOCOLINFO 1",
-                std::bind(&tor_controller_impl::protocolinfo_cb, this, std::placeholders::_1, std::placeholders::_2))) {
+        // Ask Tor to tell us about bootstrap progress, instead of polling for it
+        if (!_conn.command("SETEVENTS STATUS_CLIENT",
+                std::bind(&tor_controller_impl::events_cb, this, std::placeholders::_1, std::placeholders::_2))) {
             this->disconnected_cb();
         }
     }
 
-    void tor_controller_impl::protocolinfo_cb(tor_control_connection& _conn, const tor_control_reply& reply)
+    void tor_controller_impl::events_cb(tor_control_connection& _conn, const tor_control_reply& reply)
     {
         GDK_RUNTIME_ASSERT(reply.m_code == 250);
-        std::set<std::string> methods;
-        std::string cookiefile;
-        /*
-         * 250-AUTH METHODS=COOKIE,SAFECOOKIE COOKIEFILE="/home/x/.tor/control_auth_cookie"
-         * 250-AUTH METHODS=NULL
-         * 250-AUTH METHODS=HASHEDPASSWORD
-         */
-        for (const std::string& s : reply.m_lines) {
-            std::pair<std::string, std::string> l = split_tor_reply_line(s);
-            if (l.first == "AUTH") {
-                std::map<std::string, std::string> m = parse_tor_reply_mapping(l.second);
-                std::map<std::string, std::string>::iterator i;
-                if ((i = m.find("METHODS")) != m.end())
-                    boost::split(methods, i->second, boost::is_any_of(","));
-                if ((i = m.find("COOKIEFILE")) != m.end())
-                    cookiefile = i->second;
-            }
-        }
-        auto status_cookie = read_file(cookiefile.c_str());
-        m_cookie = std::vector<uint8_t>(status_cookie.begin(), status_cookie.end());
-        this->m_client_nonce = get_random_bytes<TOR_NONCE_SIZE>();
-        if (!_conn.command("AUTHCHALLENGE SAFECOOKIE " + b2h(m_client_nonce),
+        GDK_LOG_SEV(log_level::info) << "tor: ready, waiting for the circuit";
+
+        // Tor may have completed bootstrapping from its cached state before
+        // we subscribed, so fetch the current phase
+        if (!_conn.command("GETINFO status/bootstrap-phase",
                 std::bind(
-                    &tor_controller_impl::authchallenge_cb, this, std::placeholders::_1, std::placeholders::_2))) {
+                    &tor_controller_impl::bootstrap_phase_cb, this, std::placeholders::_1, std::placeholders::_2))) {
             this->disconnected_cb();
         }
     }
 
-    void tor_controller_impl::authchallenge_cb(tor_control_connection& _conn, const tor_control_reply& reply)
+    void tor_controller_impl::bootstrap_phase_cb(tor_control_connection& _conn, const tor_control_reply& reply)
     {
         GDK_RUNTIME_ASSERT(reply.m_code == 250);
-        GDK_LOG_SEV(log_level::info) << "tor: SAFECOOKIE authentication challenge successful";
 
         const auto l = split_tor_reply_line(reply.m_lines[0]);
-        GDK_RUNTIME_ASSERT(l.first == "AUTHCHALLENGE");
         auto m = parse_tor_reply_mapping(l.second);
-        GDK_RUNTIME_ASSERT(!m.empty());
-
-        const auto serverHash = h2b(m["SERVERHASH"]);
-        const auto serverNonce = h2b(m["SERVERNONCE"]);
-        GDK_RUNTIME_ASSERT(serverNonce.size() == HMAC_SHA256_LEN);
-
-        std::vector<uint8_t> data;
-        data.reserve(m_cookie.size() + this->m_client_nonce.size() + serverNonce.size());
-        data.insert(data.end(), m_cookie.begin(), m_cookie.end());
-        data.insert(data.end(), this->m_client_nonce.begin(), this->m_client_nonce.end());
-        data.insert(data.end(), serverNonce.begin(), serverNonce.end());
-
-        const auto computedServerHash = hmac_sha256(ustring_span(TOR_SAFE_SERVERKEY), data);
-        const auto hash_equals = std::equal(computedServerHash.begin(), computedServerHash.end(), serverHash.begin());
-
-        GDK_RUNTIME_ASSERT(hash_equals);
-
-        const auto computedClientHash = hmac_sha256(ustring_span(TOR_SAFE_CLIENTKEY), data);
-        if (!_conn.command("AUTHENTICATE " + b2h(computedClientHash),
-                std::bind(&tor_controller_impl::auth_cb, this, std::placeholders::_1, std::placeholders::_2))) {
-            this->disconnected_cb();
-        }
+        update_bootstrap_phase(_conn, m);
     }
 
-    void tor_controller_impl::auth_cb(tor_control_connection& _conn, const tor_control_reply& reply)
+    void tor_controller_impl::async_cb(tor_control_connection& _conn, const tor_control_reply& reply)
     {
-        GDK_RUNTIME_ASSERT(reply.m_code == 250);
-        GDK_LOG_SEV(log_level::info) << "tor: ready, waiting for the circuit";
-
-        if (!_conn.command("GETINFO status/bootstrap-phase",
-                std::bind(
-                    &tor_controller_impl::bootstrap_phase_cb, this, std::placeholders::_1, std::placeholders::_2))) {
-            this->disconnected_cb();
+        // 650 STATUS_CLIENT NOTICE BOOTSTRAP PROGRESS=80 TAG=ap_conn SUMMARY="..."
+        const auto l = split_tor_reply_line(reply.m_lines[0]);
+        if (l.first != "STATUS_CLIENT") {
+            return;
+        }
+        auto m = parse_tor_reply_mapping(l.second);
+        if (m.count("BOOTSTRAP") != 0 && m.count("PROGRESS") != 0) {
+            update_bootstrap_phase(_conn, m);
         }
     }
 
-    void tor_controller_impl::bootstrap_phase_cb(tor_control_connection& _conn, const tor_control_reply& reply)
+    void tor_controller_impl::update_bootstrap_phase(
+        tor_control_connection& _conn, std::map<std::string, std::string>& m)
     {
-        GDK_RUNTIME_ASSERT(reply.m_code == 250);
-
-        const auto l = split_tor_reply_line(reply.m_lines[0]);
-        auto m = parse_tor_reply_mapping(l.second);
         GDK_RUNTIME_ASSERT(!m.empty());
+        const uint32_t progress = std::stoi(m["PROGRESS"]);
 
         // Locking here to avoid race conditions on m_bootstrap_phase
         {
@@ -660,26 +550,32 @@ namespace sdk {
 
             m_bootstrap_phase->tag = m["TAG"];
             m_bootstrap_phase->summary = m["SUMMARY"];
-            m_bootstrap_phase->progress = std::stoi(m["PROGRESS"]);
+            m_bootstrap_phase->progress = progress;
         }
 
         // Notify that we updated it, so that ga_session can emit a new notification
         m_init_cv.notify_all();
 
-        if (m_bootstrap_phase->progress == 100) {
+        if (progress == 100 && !m_bootstrapped) {
             GDK_LOG_SEV(log_level::info) << "tor: the circuit is ready, we can finally use it!";
+            m_bootstrapped = true;
 
             if (!_conn.command("GETINFO net/listeners/socks",
                     std::bind(&tor_controller_impl::socks_cb, this, std::placeholders::_2))) {
                 this->disconnected_cb();
             }
-        } else {
-            std::this_thread::sleep_for(250ms);
-            if (!_conn.command("GETINFO status/bootstrap-phase",
-                    std::bind(&tor_controller_impl::bootstrap_phase_cb, this, std::placeholders::_1,
-                        std::placeholders::_2))) {
-                this->disconnected_cb();
-            }
+            fetch_onion_descriptors(_conn);
+        }
+    }
+
+    void tor_controller_impl::fetch_onion_descriptors(tor_control_connection& _conn)
+    {
+        // Fetch the descriptors for our onion services ahead of use, so
+        // that the first connection only needs to build its circuit
+        for (const auto& onion : m_onions) {
+            _conn.command("HSFETCH " + onion, [onion](tor_control_connection&, const tor_control_reply& reply) {
+                GDK_LOG_SEV(log_level::debug) << "tor: HSFETCH " << onion << " returned " << reply.m_code;
+            });
         }
     }
 
@@ -710,6 +606,43 @@ namespace sdk {
 
     void tor_controller_impl::stopped_cb() { GDK_LOG_SEV(log_level::info) << "tor: halt command received"; }
 
+    void tor_controller_impl::post(std::function<void()> fn)
+    {
+        auto fn_ptr = std::make_unique<std::function<void()>>(std::move(fn));
+        const auto run_fn = [](evutil_socket_t, short, void* arg) {
+            std::unique_ptr<std::function<void()>> fn(static_cast<std::function<void()>*>(arg));
+            no_std_exception_escape([&fn] { (*fn)(); });
+        };
+        if (m_base && event_base_once(m_base, -1, EV_TIMEOUT, run_fn, fn_ptr.get(), nullptr) == 0) {
+            fn_ptr.release(); // Owned by the event loop until run
+        }
+    }
+
+    void tor_controller_impl::set_dormant(bool dormant)
+    {
+        // Dormant mode stops network activity while keeping our consensus,
+        // descriptors and guards in memory, so waking up is almost instant
+        post([this, dormant] {
+            const std::string signal = dormant ? "DORMANT" : "ACTIVE";
+            GDK_LOG_SEV(log_level::info) << "tor: signalling " << signal;
+            m_conn->command("SIGNAL " + signal, [signal](tor_control_connection&, const tor_control_reply& reply) {
+                GDK_LOG_SEV(log_level::info) << "tor: SIGNAL " << signal << " returned " << reply.m_code;
+            });
+            if (!dormant && m_bootstrapped) {
+                fetch_onion_descriptors(*m_conn);
+            }
+        });
+    }
+
+    void tor_controller_impl::prefetch_onion(const std::string& onion_host)
+    {
+        post([this, onion_host] {
+            if (m_onions.insert(onion_host).second && m_bootstrapped) {
+                fetch_onion_descriptors(*m_conn);
+            }
+        });
+    }
+
     std::string tor_controller_impl::wait_for_socks5(
         uint32_t timeout, std::function<void(std::shared_ptr<tor_bootstrap_phase>)> phase_cb)
     {
@@ -738,7 +671,8 @@ namespace sdk {
     }
 
     tor_controller::tor_controller()
-        : m_ctrl(new tor_controller_impl(""))
+        : m_ctrl(new tor_controller_impl())
+        , m_dormant(false)
     {
     }
 
@@ -748,25 +682,39 @@ namespace sdk {
     {
         std::lock_guard<std::mutex> _(m_ctrl_mutex);
 
-        if (!m_ctrl) {
+        if (!m_ctrl || m_dormant) {
             return;
         }
 
-        const std::string socks5_str = m_ctrl->wait_for_socks5(0, nullptr);
-        m_socks5_port = socks5_str.empty() ? std::string{} : socks5_str.substr(LOCALHOST_SOCKS5_UNTIL_PORT.size());
-
-        m_ctrl.reset();
+        m_ctrl->set_dormant(true);
+        m_dormant = true;
     }
 
     void tor_controller::wakeup()
     {
         std::lock_guard<std::mutex> _(m_ctrl_mutex);
 
-        if (m_ctrl) {
+        if (!m_ctrl) {
+            m_ctrl = std::make_unique<tor_controller_impl>();
+        } else if (m_dormant) {
+            m_ctrl->set_dormant(false);
+        }
+        m_dormant = false;
+    }
+
+    void tor_controller::prefetch_onion(const std::string& url)
+    {
+        const auto parsed = parse_url(url);
+        if (!parsed.value("is_onion", false)) {
             return;
         }
+        std::string host = parsed.at("host");
+        host.erase(host.size() - ONION_SUFFIX.size());
 
-        m_ctrl = std::make_unique<tor_controller_impl>(m_socks5_port);
+        std::lock_guard<std::mutex> _(m_ctrl_mutex);
+        if (m_ctrl) {
+            m_ctrl->prefetch_onion(host);
+        }
     }
 
     std::shared_ptr<tor_controller> tor_controller::get_shared_ref()
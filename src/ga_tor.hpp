@@ -34,6 +34,9 @@ namespace sdk {
         void sleep();
         void wakeup();
 
+        // Keep the descriptor for the onion service at url warm
+        void prefetch_onion(const std::string& url);
+
         static std::shared_ptr<tor_controller> get_shared_ref();
         void tor_sleep_hint(const std::string& hint);
 
@@ -45,8 +48,7 @@ namespace sdk {
         static std::weak_ptr<tor_controller> s_inst;
         std::unique_ptr<tor_controller_impl> m_ctrl;
         std::mutex m_ctrl_mutex;
-
-        std::string m_socks5_port;
+        bool m_dormant;
     };
 
 } // namespace sdk
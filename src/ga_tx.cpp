@@ -7,6 +7,7 @@
 #include "amount.hpp"
 #include "boost_wrapper.hpp"
 #include "exception.hpp"
+#include "executor.hpp"
 #include "ga_session.hpp"
 #include "ga_strings.hpp"
 #include "ga_tx.hpp"
@@ -425,6 +426,14 @@ namespace sdk {
             // Let the caller know if addressees should not be modified
             result["addressees_read_only"] = is_redeposit || is_rbf || is_cpfp || is_sweep;
 
+            // Payouts are a compact alternative to addressees for sending to
+            // many recipients. When given, the addressees are set from them
+            const bool have_payouts = result.find("payouts") != result.end();
+            if (have_payouts && result["addressees_read_only"].get<bool>()) {
+                set_tx_error(result, res::id_payouts_cannot_be_used_to);
+                return;
+            }
+
             auto addressees_p = result.find("addressees");
             if (is_sweep) {
                 if (is_liquid) {
@@ -478,6 +487,13 @@ namespace sdk {
                 result.erase("used_utxos");
             }
 
+            // The outputs to send to, parsed once and reused in every iteration of the fee loop
+            std::vector<tx_payout> payouts;
+            if (have_payouts) {
+                payouts = parse_tx_payouts(net_params, session.get_dust_threshold(), result);
+                addressees_p = result.find("addressees");
+            }
+
             // We must have addressees to send to, and if sending everything, only one
             // Note that this error is set unconditionally and so overrides any others,
             // Since addressing transactions is normally done first by users
@@ -502,13 +518,19 @@ namespace sdk {
             if (!is_rbf) {
                 set_anti_snipe_locktime(tx, current_block_height);
             }
+            // The tx is only serialized into the result once it is complete
+            tx_size_tracker size_tracker;
 
             std::vector<nlohmann::json> used_utxos;
             used_utxos.reserve(utxos.size());
 
             std::set<std::string> asset_ids;
             bool have_assets = json_get_value(result, "addressees_have_assets", false);
-            if (num_addressees) {
+            if (have_payouts) {
+                for (const auto& payout : payouts) {
+                    asset_ids.insert(payout.asset_id);
+                }
+            } else if (num_addressees) {
                 for (auto& addressee : *addressees_p) {
                     const std::string asset_id_hex = validate_tx_addressee(net_params, result, addressee);
                     if (!json_get_value(result, "error").empty()) {
@@ -518,6 +540,14 @@ namespace sdk {
                     }
                     asset_ids.insert(asset_id_hex);
                 }
+                const amount dust_threshold = session.get_dust_threshold();
+                const auto convert_amount
+                    = [&session](const nlohmann::json& amount_json) { return session.convert_amount(amount_json); };
+                payouts.reserve(num_addressees);
+                for (auto& addressee : *addressees_p) {
+                    payouts.emplace_back(
+                        parse_tx_addressee(net_params, dust_threshold, convert_amount, result, addressee));
+                }
             }
 
             if (is_liquid) {
@@ -554,13 +584,11 @@ namespace sdk {
                 // Add all outputs and compute the total amount of satoshi to be sent
                 amount required_total{ 0 };
 
-                if (num_addressees) {
-                    for (auto& addressee : *addressees_p) {
-                        const auto addressee_asset_id = asset_id_from_json(net_params, addressee);
-                        if (addressee_asset_id == asset_id) {
-                            required_total += add_tx_addressee(session, net_params, result, tx, addressee);
-                            reordered_addressees.push_back(addressee);
-                        }
+                for (size_t i = 0; i < payouts.size(); ++i) {
+                    const auto& payout = payouts[i];
+                    if (payout.asset_id == asset_id) {
+                        required_total += add_tx_output(net_params, tx, payout.script, payout.satoshi, asset_id);
+                        reordered_addressees.push_back(addressees_p->at(i));
                     }
                 }
 
@@ -667,7 +695,7 @@ namespace sdk {
                         if (is_liquid) {
                             constexpr amount::value_type dummy_amount = 1;
                             if (!have_fee_output) {
-                                if (send_all && addressees_p->at(0).value("asset_id", policy_asset) == asset_id) {
+                                if (send_all && payouts.at(0).asset_id == asset_id) {
                                     // the output commitment will be corrected below. this is a placeholder for the
                                     // blinding.
                                     set_tx_output_commitment(tx, 0, asset_id, dummy_amount);
@@ -675,21 +703,22 @@ namespace sdk {
                                 fee_index = add_tx_fee_output(net_params, tx, dummy_amount);
                                 have_fee_output = true;
                             }
-                            update_tx_info(net_params, tx, result);
+                            update_tx_info(net_params, tx, size_tracker, result);
                             std::vector<nlohmann::json> used = json_get_value<decltype(used)>(result, "used_utxos");
                             used.insert(used.end(), current_used_utxos.begin(), current_used_utxos.end());
                             result["used_utxos"] = used;
-                            const auto blinded = blind_ga_transaction(session, result);
-                            const auto fee_tx = tx_from_hex(blinded["transaction"], tx_flags(is_liquid));
+                            const auto fee_tx = tx_clone(tx);
+                            blind_ga_transaction(session, result, fee_tx);
                             fee = get_tx_fee(fee_tx, min_fee_rate, user_fee_rate);
                         } else {
-                            fee = get_tx_fee(tx, min_fee_rate, user_fee_rate);
+                            size_tracker.update(tx);
+                            fee = get_tx_fee(size_tracker.vsize(), min_fee_rate, user_fee_rate);
                         }
 
                         fee += network_fee;
                     }
 
-                    if (send_all && addressees_p->at(0).value("asset_id", policy_asset) == asset_id) {
+                    if (send_all && payouts.at(0).asset_id == asset_id) {
                         if (available_total < fee + dust_threshold) {
                             // After paying the fee, we only have dust left, so
                             // the requested amount isn't payable
@@ -821,7 +850,7 @@ namespace sdk {
                 result["have_change"][asset_id] = have_change_output;
                 result["satoshi"][asset_id] = required_total.value();
 
-                update_tx_info(net_params, tx, result);
+                update_tx_info(net_params, tx, size_tracker, result);
 
                 if (is_rbf && json_get_value(result, "error").empty()) {
                     // Check if rbf requirements are met. When the user input a fee rate for the
@@ -849,6 +878,7 @@ namespace sdk {
             create_tx_outputs(policy_asset);
 
             result["addressees"] = reordered_addressees;
+            update_tx_size_info(net_params, tx, result);
 
             if (used_utxos.size() > 1u && json_get_value(result, "randomize_inputs", true)) {
                 randomise_inputs(tx, used_utxos);
@@ -1019,7 +1049,8 @@ namespace sdk {
         return result;
     }
 
-    nlohmann::json blind_ga_transaction(ga_session& session, const nlohmann::json& details)
+    std::vector<std::string> blind_ga_transaction(
+        ga_session& session, const nlohmann::json& details, const wally_tx_ptr& tx)
     {
         const auto& net_params = session.get_network_parameters();
         GDK_RUNTIME_ASSERT(net_params.is_liquid());
@@ -1030,9 +1061,6 @@ namespace sdk {
             GDK_RUNTIME_ASSERT_MSG(false, error);
         }
 
-        constexpr bool is_liquid = true;
-        const auto tx = tx_from_hex(details.at("transaction"), tx_flags(is_liquid));
-
         const auto num_inputs = details.at("used_utxos").size();
 
         std::vector<unsigned char> input_assets;
@@ -1066,13 +1094,13 @@ namespace sdk {
         std::vector<abf_t> output_abfs;
         output_abfs.reserve(num_outputs);
         for (size_t i = 0; i < num_outputs; ++i) {
-            output_abfs.emplace_back(get_random_bytes<32>());
+            output_abfs.emplace_back(get_fast_random_bytes<32>());
         }
 
         std::vector<vbf_t> output_vbfs;
         output_vbfs.reserve(num_outputs - 1);
         for (size_t i = 0; i < num_outputs - 1; ++i) {
-            output_vbfs.emplace_back(get_random_bytes<32>());
+            output_vbfs.emplace_back(get_fast_random_bytes<32>());
         }
 
         output_vbfs.emplace_back(
@@ -1083,6 +1111,8 @@ namespace sdk {
         const bool authorized_assets = subaccount_type == "2of2_no_recovery";
 
         std::vector<std::string> blinding_nonces;
+        std::vector<output_blinders> blinders;
+        blinders.reserve(num_outputs);
 
         for (const auto& output : transaction_outputs) {
             // IMPORTANT: we assume the fee is always the last output
@@ -1094,15 +1124,14 @@ namespace sdk {
             }
 
             const auto asset_id = h2b_rev(output.at("asset_id"));
-            const auto pub_key = h2b(output.at("public_key"));
             const uint64_t value = output.at("satoshi");
 
             const auto generator = asset_generator_from_bytes(asset_id, output_abfs[i]);
             const auto value_commitment = asset_value_commitment(value, output_vbfs[i], generator);
-
-            blind_output(session, details, tx, i, output, generator, value_commitment, output_abfs[i], output_vbfs[i]);
+            blinders.emplace_back(output_blinders{ generator, value_commitment, output_abfs[i], output_vbfs[i] });
 
             if (authorized_assets) {
+                const auto pub_key = h2b(output.at("public_key"));
                 const auto eph_keypair_sec = h2b(output.at("eph_keypair_sec"));
                 const auto blinding_nonce = sha256(ecdh(pub_key, eph_keypair_sec));
                 blinding_nonces.emplace_back(b2h(blinding_nonce));
@@ -1111,23 +1140,29 @@ namespace sdk {
             ++i;
         }
 
+        blind_outputs(net_params, details, tx, blinders);
+        return blinding_nonces;
+    }
+
+    nlohmann::json blind_ga_transaction(ga_session& session, const nlohmann::json& details)
+    {
+        constexpr bool is_liquid = true;
+        const auto tx = tx_from_hex(details.at("transaction"), tx_flags(is_liquid));
+        const auto blinding_nonces = blind_ga_transaction(session, details, tx);
+
         nlohmann::json result(details);
         result["blinded"] = true;
-        if (authorized_assets) {
+        if (details.at("subaccount_type") == "2of2_no_recovery") {
             result["blinding_nonces"] = blinding_nonces;
         }
-        update_tx_size_info(net_params, tx, result);
+        update_tx_size_info(session.get_network_parameters(), tx, result);
         return result;
     }
 
-    void blind_output(session_impl& session, const nlohmann::json& details, const wally_tx_ptr& tx, uint32_t index,
-        const nlohmann::json& output, const std::array<unsigned char, 33>& generator,
-        const std::array<unsigned char, 33>& value_commitment, const std::array<unsigned char, 32>& abf,
-        const std::array<unsigned char, 32>& vbf)
+    void blind_outputs(const network_parameters& net_params, const nlohmann::json& details, const wally_tx_ptr& tx,
+        const std::vector<output_blinders>& blinders)
     {
-        const auto& net_params = session.get_network_parameters();
         GDK_RUNTIME_ASSERT(net_params.is_liquid());
-        GDK_RUNTIME_ASSERT(!output.at("is_fee"));
 
         const std::string error = json_get_value(details, "error");
         if (!error.empty()) {
@@ -1135,35 +1170,58 @@ namespace sdk {
             GDK_RUNTIME_ASSERT_MSG(false, error);
         }
 
-        // FIXME: Compute these up front
         std::vector<unsigned char> input_assets;
         std::vector<unsigned char> input_abfs;
         std::vector<unsigned char> input_ags;
-        for (const auto& utxo : details["used_utxos"]) {
-            const auto asset_id = h2b_rev(utxo["asset_id"]);
+        for (const auto& utxo : details.at("used_utxos")) {
+            const auto asset_id = h2b_rev(utxo.at("asset_id"));
             input_assets.insert(input_assets.end(), std::begin(asset_id), std::end(asset_id));
-            const auto abf = h2b_rev(utxo["assetblinder"]);
+            const auto abf = h2b_rev(utxo.at("assetblinder"));
             input_abfs.insert(input_abfs.end(), std::begin(abf), std::end(abf));
             const auto asset_generator = asset_generator_from_bytes(asset_id, abf);
             input_ags.insert(input_ags.end(), std::begin(asset_generator), std::end(asset_generator));
         }
 
-        const auto asset_id = h2b_rev(output.at("asset_id"));
-        const auto script = h2b(output.at("script"));
-        const auto pub_key = h2b(output.at("public_key"));
-        const uint64_t value = output.at("satoshi");
-
-        const auto eph_keypair_sec = h2b(output.at("eph_keypair_sec"));
-        const auto eph_keypair_pub = h2b(output.at("eph_keypair_pub"));
-
-        const auto rangeproof = asset_rangeproof(value, pub_key, eph_keypair_sec, asset_id, abf, vbf, value_commitment,
-            script, generator, 1, std::min(std::max(net_params.ct_exponent(), -1), 18), net_params.ct_bits());
+        const auto& outputs = details.at("transaction_outputs");
+        GDK_RUNTIME_ASSERT(blinders.size() <= outputs.size());
+        const int ct_exponent = std::min(std::max(net_params.ct_exponent(), -1), 18);
+        const int ct_bits = net_params.ct_bits();
+
+        // Draw the surjection proof seeds up front so the worker threads only
+        // compute; each proof is written to its output's slot, keeping the
+        // result independent of how the outputs are split between threads
+        std::vector<std::array<unsigned char, 32>> seeds;
+        seeds.reserve(blinders.size());
+        for (size_t i = 0; i < blinders.size(); ++i) {
+            seeds.emplace_back(get_fast_random_bytes<32>());
+        }
+        std::vector<std::vector<unsigned char>> rangeproofs(blinders.size());
+        std::vector<std::vector<unsigned char>> surjectionproofs(blinders.size());
+
+        parallel_for(blinders.size(), 2, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const auto& output = outputs.at(i);
+                GDK_RUNTIME_ASSERT(!output.at("is_fee"));
+                const auto& b = blinders[i];
+                const auto asset_id = h2b_rev(output.at("asset_id"));
+                const auto script = h2b(output.at("script"));
+                const auto pub_key = h2b(output.at("public_key"));
+                const uint64_t value = output.at("satoshi");
+                const auto eph_keypair_sec = h2b(output.at("eph_keypair_sec"));
 
-        const auto surjectionproof = asset_surjectionproof(
-            asset_id, abf, generator, get_random_bytes<32>(), input_assets, input_abfs, input_ags);
+                rangeproofs[i] = asset_rangeproof(value, pub_key, eph_keypair_sec, asset_id, b.abf, b.vbf,
+                    b.value_commitment, script, b.generator, 1, ct_exponent, ct_bits);
+                surjectionproofs[i] = asset_surjectionproof(
+                    asset_id, b.abf, b.generator, seeds[i], input_assets, input_abfs, input_ags);
+            }
+        });
 
-        tx_elements_output_commitment_set(
-            tx, index, generator, value_commitment, eph_keypair_pub, surjectionproof, rangeproof);
+        for (size_t i = 0; i < blinders.size(); ++i) {
+            const auto& b = blinders[i];
+            const auto eph_keypair_pub = h2b(outputs.at(i).at("eph_keypair_pub"));
+            tx_elements_output_commitment_set(
+                tx, i, b.generator, b.value_commitment, eph_keypair_pub, surjectionproofs[i], rangeproofs[i]);
+        }
     }
 
 } // namespace sdk
@@ -19,10 +19,20 @@ namespace sdk {
     void add_input_signature(
         const wally_tx_ptr& tx, uint32_t index, const nlohmann::json& u, const std::string& der_hex, bool is_low_r);
 
-    void blind_output(session_impl& session, const nlohmann::json& details, const wally_tx_ptr& tx, uint32_t index,
-        const nlohmann::json& output, const std::array<unsigned char, 33>& generator,
-        const std::array<unsigned char, 33>& value_commitment, const std::array<unsigned char, 32>& abf,
-        const std::array<unsigned char, 32>& vbf);
+    // The asset generator, value commitment and blinders of an output to blind
+    struct output_blinders {
+        std::array<unsigned char, ASSET_GENERATOR_LEN> generator;
+        std::array<unsigned char, ASSET_COMMITMENT_LEN> value_commitment;
+        abf_t abf;
+        vbf_t vbf;
+    };
+
+    // Blind the first blinders.size() outputs of tx, which must be the non-fee
+    // outputs of details["transaction_outputs"] in the same order.
+    // The range and surjection proofs of all outputs are generated in parallel,
+    // then set on tx in output order.
+    void blind_outputs(const network_parameters& net_params, const nlohmann::json& details, const wally_tx_ptr& tx,
+        const std::vector<output_blinders>& blinders);
 
     std::vector<nlohmann::json> get_ga_signing_inputs(const nlohmann::json& details);
 
@@ -32,6 +42,12 @@ namespace sdk {
 
     nlohmann::json blind_ga_transaction(ga_session& session, const nlohmann::json& details);
 
+    // Blind tx in place, without serializing it into the result as the overload
+    // above does. Returns the blinding nonces of the outputs of 2of2_no_recovery
+    // subaccounts, or nothing for other subaccount types.
+    std::vector<std::string> blind_ga_transaction(
+        ga_session& session, const nlohmann::json& details, const wally_tx_ptr& tx);
+
 } // namespace sdk
 } // namespace ga
 
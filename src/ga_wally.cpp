@@ -1,5 +1,6 @@
 #include "ga_wally.hpp"
 #include "boost_wrapper.hpp"
+#include "hex.hpp"
 #include "memory.hpp"
 #include "utils.hpp"
 
@@ -283,6 +284,15 @@ namespace sdk {
         return ret;
     }
 
+    size_t scriptpubkey_get_type(byte_span_t scriptpubkey)
+    {
+        size_t type;
+        if (wally_scriptpubkey_get_type(scriptpubkey.data(), scriptpubkey.size(), &type) != WALLY_OK) {
+            return WALLY_SCRIPT_TYPE_UNKNOWN; // Empty or malformed
+        }
+        return type;
+    }
+
     std::vector<unsigned char> witness_program_from_bytes(byte_span_t script, uint32_t flags)
     {
         size_t written;
@@ -356,39 +366,57 @@ namespace sdk {
     //
     // Strings/Addresses
     //
-    std::string b2h(byte_span_t data)
+    static std::string b2h_impl(byte_span_t data, bool rev)
     {
-        char* ret;
-        GDK_VERIFY(wally_hex_from_bytes(data.data(), data.size(), &ret));
-        return make_string(ret);
+        std::string ret(data.size() * 2, '\0');
+        hex_encode(data.data(), data.size(), &ret[0], rev);
+        return ret;
+    }
+
+    std::string b2h(byte_span_t data) { return b2h_impl(data, false); }
+
+    std::string b2h_rev(byte_span_t data) { return b2h_impl(data, true); }
+
+    void b2h(byte_span_t data, gsl::span<char> hex)
+    {
+        GDK_RUNTIME_ASSERT(static_cast<size_t>(hex.size()) == static_cast<size_t>(data.size()) * 2);
+        hex_encode(data.data(), data.size(), hex.data(), false);
     }
 
-    std::string b2h_rev(byte_span_t data)
+    void b2h_rev(byte_span_t data, gsl::span<char> hex)
     {
-        char* ret;
-        std::vector<unsigned char> buff(data.rbegin(), data.rend());
-        GDK_VERIFY(wally_hex_from_bytes(buff.data(), buff.size(), &ret));
-        return make_string(ret);
+        GDK_RUNTIME_ASSERT(static_cast<size_t>(hex.size()) == static_cast<size_t>(data.size()) * 2);
+        hex_encode(data.data(), data.size(), hex.data(), true);
     }
 
-    static auto h2b(const char* hex, size_t siz, bool rev, uint8_t prefix = 0)
+    static void h2b_impl(const char* hex, size_t siz, bool rev, unsigned char* bytes, size_t bytes_siz)
     {
         GDK_RUNTIME_ASSERT(hex != nullptr && siz != 0);
-        size_t written;
+        GDK_RUNTIME_ASSERT(siz % 2 == 0 && siz / 2 == bytes_siz);
+        GDK_RUNTIME_ASSERT(hex_decode(hex, siz, bytes, rev));
+    }
+
+    static auto h2b(const char* hex, size_t siz, bool rev, uint8_t prefix = 0)
+    {
         const size_t bytes_siz = siz / 2;
         std::vector<unsigned char> buff(bytes_siz + (prefix != 0 ? 1 : 0));
-        auto buff_data = buff.data() + (prefix != 0 ? 1 : 0);
-        GDK_VERIFY(wally_hex_to_bytes(hex, buff_data, bytes_siz, &written));
-        GDK_RUNTIME_ASSERT(written == bytes_siz);
-        if (rev) {
-            std::reverse(buff_data, buff_data + bytes_siz);
-        }
+        h2b_impl(hex, siz, rev, buff.data() + (prefix != 0 ? 1 : 0), bytes_siz);
         if (prefix != 0) {
             buff[0] = prefix;
         }
         return buff;
     }
 
+    void h2b(const std::string& hex, gsl::span<unsigned char> bytes)
+    {
+        h2b_impl(hex.data(), hex.size(), false, bytes.data(), bytes.size());
+    }
+
+    void h2b_rev(const std::string& hex, gsl::span<unsigned char> bytes)
+    {
+        h2b_impl(hex.data(), hex.size(), true, bytes.data(), bytes.size());
+    }
+
     std::vector<unsigned char> h2b(const char* hex) { return h2b(hex, strlen(hex), false); }
     std::vector<unsigned char> h2b(const std::string& hex) { return h2b(hex.data(), hex.size(), false); }
     std::vector<unsigned char> h2b(const std::string& hex, uint8_t prefix)
@@ -590,7 +618,7 @@ namespace sdk {
     {
         priv_key_t private_key;
         do {
-            private_key = get_random_bytes<32>();
+            private_key = get_fast_random_bytes<32>();
         } while (!ec_private_key_verify(private_key));
         return { private_key, ec_public_key_from_private_key(private_key) };
     }
@@ -852,9 +880,17 @@ namespace sdk {
     }
 
     wally_tx_ptr tx_from_hex(const std::string& tx_hex, uint32_t flags)
+    {
+        const auto tx_bytes = h2b(tx_hex);
+        struct wally_tx* p;
+        GDK_VERIFY(wally_tx_from_bytes(tx_bytes.data(), tx_bytes.size(), flags, &p));
+        return wally_tx_ptr(p);
+    }
+
+    wally_tx_ptr tx_clone(const wally_tx_ptr& tx)
     {
         struct wally_tx* p;
-        GDK_VERIFY(wally_tx_from_hex(tx_hex.c_str(), flags, &p));
+        GDK_VERIFY(wally_tx_clone_alloc(tx.get(), 0, &p));
         return wally_tx_ptr(p);
     }
 
@@ -146,6 +146,9 @@ namespace sdk {
 
     std::vector<unsigned char> scriptpubkey_p2sh_from_hash160(byte_span_t hash);
 
+    // Returns the WALLY_SCRIPT_TYPE_ of a scriptpubkey, WALLY_SCRIPT_TYPE_UNKNOWN if unrecognized
+    size_t scriptpubkey_get_type(byte_span_t scriptpubkey);
+
     std::vector<unsigned char> witness_program_from_bytes(byte_span_t script, uint32_t flags);
 
     std::array<unsigned char, SHA256_LEN> format_bitcoin_message_hash(byte_span_t message);
@@ -170,15 +173,23 @@ namespace sdk {
     std::string b2h(byte_span_t data);
     std::string b2h_rev(byte_span_t data);
 
+    // Encode into a caller-provided buffer which must be exactly twice the
+    // size of data. No terminator is written.
+    void b2h(byte_span_t data, gsl::span<char> hex);
+    void b2h_rev(byte_span_t data, gsl::span<char> hex);
+
+    // Decode into a caller-provided buffer which must be exactly half the
+    // length of hex.
+    void h2b(const std::string& hex, gsl::span<unsigned char> bytes);
+    void h2b_rev(const std::string& hex, gsl::span<unsigned char> bytes);
+
     std::vector<unsigned char> h2b(const char* hex);
     std::vector<unsigned char> h2b(const std::string& hex);
     std::vector<unsigned char> h2b(const std::string& hex, uint8_t prefix);
     template <size_t N> std::array<unsigned char, N> h2b_array(const std::string& hex)
     {
-        const auto vec = h2b(hex);
-        GDK_RUNTIME_ASSERT(vec.size() == N);
         std::array<unsigned char, N> ret;
-        std::copy(vec.begin(), vec.end(), ret.begin());
+        h2b(hex, ret);
         return ret;
     }
 
@@ -188,25 +199,15 @@ namespace sdk {
 
     template <std::size_t N> std::array<unsigned char, N> h2b(const std::string& hex)
     {
-        GDK_RUNTIME_ASSERT(hex.size() / 2 == N);
-        std::array<unsigned char, N> buff{ { 0 } };
-
-        const std::vector<unsigned char> bin = h2b(hex);
-        GDK_RUNTIME_ASSERT(bin.size() == N);
-
-        std::copy(std::begin(bin), std::end(bin), buff.begin());
+        std::array<unsigned char, N> buff;
+        h2b(hex, buff);
         return buff;
     }
 
     template <std::size_t N> std::array<unsigned char, N> h2b_rev(const std::string& hex)
     {
-        GDK_RUNTIME_ASSERT(hex.size() / 2 == N);
-        std::array<unsigned char, N> buff{ { 0 } };
-
-        const std::vector<unsigned char> bin = h2b_rev(hex);
-        GDK_RUNTIME_ASSERT(bin.size() == N);
-
-        std::copy(std::begin(bin), std::end(bin), buff.begin());
+        std::array<unsigned char, N> buff;
+        h2b_rev(hex, buff);
         return buff;
     }
 
@@ -335,6 +336,8 @@ namespace sdk {
 
     wally_tx_ptr tx_from_hex(const std::string& tx_hex, uint32_t flags = WALLY_TX_FLAG_USE_WITNESS);
 
+    wally_tx_ptr tx_clone(const wally_tx_ptr& tx);
+
     void tx_add_raw_input(const wally_tx_ptr& tx, byte_span_t txhash, uint32_t index, uint32_t sequence,
         byte_span_t script, const wally_tx_witness_stack_ptr& witness = {});
 
@@ -0,0 +1,282 @@
+#include <array>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define GDK_HEX_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define GDK_HEX_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define GDK_HEX_NEON
+#endif
+
+#include "hex.hpp"
+
+namespace ga {
+namespace sdk {
+
+    namespace {
+        constexpr unsigned char INVALID_NIBBLE = 0xff;
+
+        const char* const HEX_DIGITS = "0123456789abcdef";
+
+        const std::array<unsigned char, 256>& get_decode_table()
+        {
+            static const std::array<unsigned char, 256> table = [] {
+                std::array<unsigned char, 256> t;
+                t.fill(INVALID_NIBBLE);
+                for (unsigned char i = 0; i < 10; ++i) {
+                    t['0' + i] = i;
+                }
+                for (unsigned char i = 0; i < 6; ++i) {
+                    t['a' + i] = t['A' + i] = 10 + i;
+                }
+                return t;
+            }();
+            return table;
+        }
+
+        inline void encode_byte(unsigned char b, char* hex)
+        {
+            hex[0] = HEX_DIGITS[b >> 4];
+            hex[1] = HEX_DIGITS[b & 0xf];
+        }
+
+        inline bool decode_byte(const std::array<unsigned char, 256>& table, const char* hex, unsigned char& b)
+        {
+            const unsigned char hi = table[static_cast<unsigned char>(hex[0])];
+            const unsigned char lo = table[static_cast<unsigned char>(hex[1])];
+            b = static_cast<unsigned char>((hi << 4) | lo);
+            return (hi | lo) != INVALID_NIBBLE;
+        }
+
+#if defined(GDK_HEX_AVX2)
+        constexpr std::size_t BLOCK_SIZE = 32; // Bytes processed per block
+
+        inline __m256i reverse_block(__m256i v)
+        {
+            const __m256i mask = _mm256_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12,
+                11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+            return _mm256_permute4x64_epi64(_mm256_shuffle_epi8(v, mask), 0x4e);
+        }
+
+        inline __m256i nibbles_to_ascii(__m256i n)
+        {
+            const __m256i ascii = _mm256_add_epi8(n, _mm256_set1_epi8('0'));
+            const __m256i is_alpha = _mm256_cmpgt_epi8(n, _mm256_set1_epi8(9));
+            return _mm256_add_epi8(ascii, _mm256_and_si256(is_alpha, _mm256_set1_epi8('a' - '0' - 10)));
+        }
+
+        inline __m256i ascii_to_nibbles(__m256i c, __m256i& valid)
+        {
+            const __m256i minus_one = _mm256_set1_epi8(-1);
+            const __m256i d = _mm256_sub_epi8(c, _mm256_set1_epi8('0'));
+            const __m256i is_digit
+                = _mm256_and_si256(_mm256_cmpgt_epi8(d, minus_one), _mm256_cmpgt_epi8(_mm256_set1_epi8(10), d));
+            const __m256i l = _mm256_sub_epi8(_mm256_or_si256(c, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+            const __m256i is_alpha
+                = _mm256_and_si256(_mm256_cmpgt_epi8(l, minus_one), _mm256_cmpgt_epi8(_mm256_set1_epi8(6), l));
+            valid = _mm256_and_si256(valid, _mm256_or_si256(is_digit, is_alpha));
+            return _mm256_or_si256(_mm256_and_si256(is_digit, d),
+                _mm256_and_si256(is_alpha, _mm256_add_epi8(l, _mm256_set1_epi8(10))));
+        }
+
+        // Combine pairs of nibbles into bytes held in the low half of each 16 bit lane
+        inline __m256i combine_nibbles(__m256i n)
+        {
+            const __m256i hi = _mm256_slli_epi16(_mm256_and_si256(n, _mm256_set1_epi16(0x00ff)), 4);
+            return _mm256_or_si256(hi, _mm256_srli_epi16(n, 8));
+        }
+
+        inline void encode_block(const unsigned char* bytes, char* hex, bool reverse)
+        {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes));
+            if (reverse) {
+                v = reverse_block(v);
+            }
+            const __m256i mask = _mm256_set1_epi8(0x0f);
+            const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask);
+            const __m256i lo = _mm256_and_si256(v, mask);
+            // unpack interleaves within 128 bit lanes, so recombine the lanes in order
+            const __m256i first = nibbles_to_ascii(_mm256_unpacklo_epi8(hi, lo));
+            const __m256i second = nibbles_to_ascii(_mm256_unpackhi_epi8(hi, lo));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(hex), _mm256_permute2x128_si256(first, second, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(hex + 32), _mm256_permute2x128_si256(first, second, 0x31));
+        }
+
+        inline bool decode_block(const char* hex, unsigned char* bytes, bool reverse)
+        {
+            __m256i valid = _mm256_set1_epi8(-1);
+            const __m256i a = ascii_to_nibbles(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex)), valid);
+            const __m256i b = ascii_to_nibbles(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hex + 32)), valid);
+            // packus interleaves 64 bit quarters from each lane, so restore their order
+            __m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi16(combine_nibbles(a), combine_nibbles(b)), 0xd8);
+            if (reverse) {
+                v = reverse_block(v);
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes), v);
+            return _mm256_movemask_epi8(valid) == -1;
+        }
+#elif defined(GDK_HEX_SSE2)
+        constexpr std::size_t BLOCK_SIZE = 16; // Bytes processed per block
+
+        inline __m128i reverse_block(__m128i v)
+        {
+            // SSE2 has no byte shuffle: reverse dwords, then words, then bytes
+            v = _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3));
+            v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 3, 0, 1));
+            return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+        }
+
+        inline __m128i nibbles_to_ascii(__m128i n)
+        {
+            const __m128i ascii = _mm_add_epi8(n, _mm_set1_epi8('0'));
+            const __m128i is_alpha = _mm_cmpgt_epi8(n, _mm_set1_epi8(9));
+            return _mm_add_epi8(ascii, _mm_and_si128(is_alpha, _mm_set1_epi8('a' - '0' - 10)));
+        }
+
+        inline __m128i ascii_to_nibbles(__m128i c, __m128i& valid)
+        {
+            const __m128i minus_one = _mm_set1_epi8(-1);
+            const __m128i d = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+            const __m128i is_digit = _mm_and_si128(_mm_cmpgt_epi8(d, minus_one), _mm_cmplt_epi8(d, _mm_set1_epi8(10)));
+            const __m128i l = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+            const __m128i is_alpha = _mm_and_si128(_mm_cmpgt_epi8(l, minus_one), _mm_cmplt_epi8(l, _mm_set1_epi8(6)));
+            valid = _mm_and_si128(valid, _mm_or_si128(is_digit, is_alpha));
+            return _mm_or_si128(
+                _mm_and_si128(is_digit, d), _mm_and_si128(is_alpha, _mm_add_epi8(l, _mm_set1_epi8(10))));
+        }
+
+        // Combine pairs of nibbles into bytes held in the low half of each 16 bit lane
+        inline __m128i combine_nibbles(__m128i n)
+        {
+            const __m128i hi = _mm_slli_epi16(_mm_and_si128(n, _mm_set1_epi16(0x00ff)), 4);
+            return _mm_or_si128(hi, _mm_srli_epi16(n, 8));
+        }
+
+        inline void encode_block(const unsigned char* bytes, char* hex, bool reverse)
+        {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+            if (reverse) {
+                v = reverse_block(v);
+            }
+            const __m128i mask = _mm_set1_epi8(0x0f);
+            const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+            const __m128i lo = _mm_and_si128(v, mask);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(hex), nibbles_to_ascii(_mm_unpacklo_epi8(hi, lo)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(hex + 16), nibbles_to_ascii(_mm_unpackhi_epi8(hi, lo)));
+        }
+
+        inline bool decode_block(const char* hex, unsigned char* bytes, bool reverse)
+        {
+            __m128i valid = _mm_set1_epi8(-1);
+            const __m128i a = ascii_to_nibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex)), valid);
+            const __m128i b = ascii_to_nibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex + 16)), valid);
+            __m128i v = _mm_packus_epi16(combine_nibbles(a), combine_nibbles(b));
+            if (reverse) {
+                v = reverse_block(v);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes), v);
+            return _mm_movemask_epi8(valid) == 0xffff;
+        }
+#elif defined(GDK_HEX_NEON)
+        constexpr std::size_t BLOCK_SIZE = 16; // Bytes processed per block
+
+        inline uint8x16_t reverse_block(uint8x16_t v)
+        {
+            const uint8x16_t r = vrev64q_u8(v);
+            return vcombine_u8(vget_high_u8(r), vget_low_u8(r));
+        }
+
+        inline uint8x16_t nibbles_to_ascii(uint8x16_t n)
+        {
+            const uint8x16_t ascii = vaddq_u8(n, vdupq_n_u8('0'));
+            const uint8x16_t is_alpha = vcgtq_u8(n, vdupq_n_u8(9));
+            return vaddq_u8(ascii, vandq_u8(is_alpha, vdupq_n_u8('a' - '0' - 10)));
+        }
+
+        inline uint8x16_t ascii_to_nibbles(uint8x16_t c, uint8x16_t& valid)
+        {
+            const uint8x16_t d = vsubq_u8(c, vdupq_n_u8('0'));
+            const uint8x16_t is_digit = vcltq_u8(d, vdupq_n_u8(10));
+            const uint8x16_t l = vsubq_u8(vorrq_u8(c, vdupq_n_u8(0x20)), vdupq_n_u8('a'));
+            const uint8x16_t is_alpha = vcltq_u8(l, vdupq_n_u8(6));
+            valid = vandq_u8(valid, vorrq_u8(is_digit, is_alpha));
+            return vbslq_u8(is_digit, d, vaddq_u8(l, vdupq_n_u8(10)));
+        }
+
+        inline bool all_set(uint8x16_t v)
+        {
+            const uint8x8_t m = vand_u8(vget_low_u8(v), vget_high_u8(v));
+            return vget_lane_u64(vreinterpret_u64_u8(m), 0) == ~uint64_t(0);
+        }
+
+        inline void encode_block(const unsigned char* bytes, char* hex, bool reverse)
+        {
+            uint8x16_t v = vld1q_u8(bytes);
+            if (reverse) {
+                v = reverse_block(v);
+            }
+            uint8x16x2_t out;
+            out.val[0] = nibbles_to_ascii(vshrq_n_u8(v, 4));
+            out.val[1] = nibbles_to_ascii(vandq_u8(v, vdupq_n_u8(0x0f)));
+            vst2q_u8(reinterpret_cast<uint8_t*>(hex), out); // Interleaves hi/lo nibbles
+        }
+
+        inline bool decode_block(const char* hex, unsigned char* bytes, bool reverse)
+        {
+            // De-interleave into hi (even) and lo (odd) characters
+            const uint8x16x2_t in = vld2q_u8(reinterpret_cast<const uint8_t*>(hex));
+            uint8x16_t valid = vdupq_n_u8(0xff);
+            const uint8x16_t hi = ascii_to_nibbles(in.val[0], valid);
+            const uint8x16_t lo = ascii_to_nibbles(in.val[1], valid);
+            uint8x16_t v = vorrq_u8(vshlq_n_u8(hi, 4), lo);
+            if (reverse) {
+                v = reverse_block(v);
+            }
+            vst1q_u8(bytes, v);
+            return all_set(valid);
+        }
+#endif
+    } // namespace
+
+    void hex_encode(const unsigned char* bytes, std::size_t len, char* hex, bool reverse)
+    {
+        // i is the index of the next byte to encode, in output order
+        std::size_t i = 0;
+#if defined(GDK_HEX_AVX2) || defined(GDK_HEX_SSE2) || defined(GDK_HEX_NEON)
+        for (; i + BLOCK_SIZE <= len; i += BLOCK_SIZE) {
+            encode_block(reverse ? bytes + len - i - BLOCK_SIZE : bytes + i, hex + i * 2, reverse);
+        }
+#endif
+        for (; i < len; ++i) {
+            encode_byte(reverse ? bytes[len - i - 1] : bytes[i], hex + i * 2);
+        }
+    }
+
+    bool hex_decode(const char* hex, std::size_t hex_len, unsigned char* bytes, bool reverse)
+    {
+        if (hex_len % 2) {
+            return false;
+        }
+        const std::size_t len = hex_len / 2;
+        bool valid = true;
+        // i is the index of the next byte to decode, in input order
+        std::size_t i = 0;
+#if defined(GDK_HEX_AVX2) || defined(GDK_HEX_SSE2) || defined(GDK_HEX_NEON)
+        for (; i + BLOCK_SIZE <= len; i += BLOCK_SIZE) {
+            valid &= decode_block(hex + i * 2, reverse ? bytes + len - i - BLOCK_SIZE : bytes + i, reverse);
+        }
+#endif
+        const auto& table = get_decode_table();
+        for (; i < len; ++i) {
+            valid &= decode_byte(table, hex + i * 2, reverse ? bytes[len - i - 1] : bytes[i]);
+        }
+        return valid;
+    }
+
+} // namespace sdk
+} // namespace ga
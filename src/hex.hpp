@@ -0,0 +1,29 @@
+#ifndef GDK_HEX_HPP
+#define GDK_HEX_HPP
+#pragma once
+
+#include <cstddef>
+
+namespace ga {
+namespace sdk {
+
+    //
+    // Low level hex codecs, vectorized where the target supports it.
+    // Callers are responsible for buffer sizing; see b2h/h2b in ga_wally.hpp
+    // for the checked interfaces.
+    //
+
+    // Write exactly 2 * len lowercase hex characters (no terminator) to hex.
+    // If reverse is true, the bytes are encoded in reverse order.
+    void hex_encode(const unsigned char* bytes, std::size_t len, char* hex, bool reverse);
+
+    // Decode hex_len / 2 bytes from hex (upper or lowercase) into bytes.
+    // hex_len must be even. Returns false if any character is not valid hex,
+    // in which case the contents of bytes are unspecified.
+    // If reverse is true, the decoded bytes are written in reverse order.
+    bool hex_decode(const char* hex, std::size_t hex_len, unsigned char* bytes, bool reverse);
+
+} // namespace sdk
+} // namespace ga
+
+#endif
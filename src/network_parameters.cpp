@@ -545,9 +545,127 @@ static std::mutex registered_networks_mutex;
 namespace ga {
 namespace sdk {
 
+    namespace {
+        // A parameter that must be present in the network details to be
+        // used. Missing parameters only cause an error when accessed
+        template <typename T> class required_param {
+        public:
+            required_param(const nlohmann::json& details, const char* key)
+                : m_key(key)
+            {
+                const auto p = details.find(key);
+                if (p != details.end()) {
+                    m_value = p->get<T>();
+                    m_present = true;
+                }
+            }
+
+            const T& get() const
+            {
+                if (!m_present) {
+                    GDK_RUNTIME_ASSERT_MSG(false, std::string("missing network parameter ") + m_key);
+                }
+                return m_value;
+            }
+
+        private:
+            const char* m_key;
+            T m_value{};
+            bool m_present = false;
+        };
+    } // namespace
+
+    struct network_parameters::parsed_params {
+        explicit parsed_params(const nlohmann::json& details)
+            : m_details(details)
+            , m_network(details, "network")
+            , m_wamp_url(details, "wamp_url")
+            , m_wamp_cert_pins(details, "wamp_cert_pins")
+            , m_wamp_cert_roots(details, "wamp_cert_roots")
+            , m_address_explorer_url(details, "address_explorer_url")
+            , m_tx_explorer_url(details, "tx_explorer_url")
+            , m_asset_registry_url(details, "asset_registry_url")
+            , m_asset_registry_onion_url(details, "asset_registry_onion_url")
+            , m_service_chain_code(details, "service_chain_code")
+            , m_electrum_tls(details, "electrum_tls")
+            , m_electrum_url(details, "electrum_url")
+            , m_service_pubkey(details, "service_pubkey")
+            , m_wamp_onion_url(details, "wamp_onion_url")
+            , m_policy_asset(details.value("policy_asset", std::string()))
+            , m_bip21_prefix(details, "bip21_prefix")
+            , m_bech32_prefix(details, "bech32_prefix")
+            , m_blech32_prefix(details, "blech32_prefix")
+            , m_log_level(details.value("log_level", "none"))
+            , m_p2pkh_version(details, "p2pkh_version")
+            , m_p2sh_version(details, "p2sh_version")
+            , m_blinded_prefix(details, "blinded_prefix")
+            , m_ct_exponent(details, "ct_exponent")
+            , m_ct_bits(details, "ct_bits")
+            , m_mainnet(details, "mainnet")
+            , m_liquid(details.value("liquid", false))
+            , m_electrum(details.value("server_type", std::string()) == "electrum")
+            , m_use_tor(details.value("use_tor", false))
+            , m_socks5(details.value("socks5", std::string()))
+            , m_spv_enabled(details, "spv_enabled")
+            , m_user_agent(details.value("user_agent", std::string()))
+            , m_csv_buckets(details, "csv_buckets")
+            , m_cert_expiry_threshold(details, "cert_expiry_threshold")
+        {
+        }
+
+        const nlohmann::json m_details;
+        const required_param<std::string> m_network;
+        const required_param<std::string> m_wamp_url;
+        const required_param<std::vector<std::string>> m_wamp_cert_pins;
+        const required_param<std::vector<std::string>> m_wamp_cert_roots;
+        const required_param<std::string> m_address_explorer_url;
+        const required_param<std::string> m_tx_explorer_url;
+        const required_param<std::string> m_asset_registry_url;
+        const required_param<std::string> m_asset_registry_onion_url;
+        const required_param<std::string> m_service_chain_code;
+        const required_param<bool> m_electrum_tls;
+        const required_param<std::string> m_electrum_url;
+        const required_param<std::string> m_service_pubkey;
+        const required_param<std::string> m_wamp_onion_url;
+        const std::string m_policy_asset;
+        const required_param<std::string> m_bip21_prefix;
+        const required_param<std::string> m_bech32_prefix;
+        const required_param<std::string> m_blech32_prefix;
+        const std::string m_log_level;
+        const required_param<unsigned char> m_p2pkh_version;
+        const required_param<unsigned char> m_p2sh_version;
+        const required_param<uint32_t> m_blinded_prefix;
+        const required_param<int> m_ct_exponent;
+        const required_param<int> m_ct_bits;
+        const required_param<bool> m_mainnet;
+        const bool m_liquid;
+        const bool m_electrum;
+        const bool m_use_tor;
+        const std::string m_socks5;
+        const required_param<bool> m_spv_enabled;
+        const std::string m_user_agent;
+        const required_param<std::vector<uint32_t>> m_csv_buckets;
+        const required_param<uint32_t> m_cert_expiry_threshold;
+    };
+
     network_parameters::network_parameters(const nlohmann::json& details)
-        : m_details(details)
     {
+        // Share the parsed parameters of any live instance with the same details
+        static std::mutex interned_mutex;
+        static std::map<std::string, std::weak_ptr<const parsed_params>> interned;
+        const auto key = details.dump();
+
+        std::unique_lock<std::mutex> l{ interned_mutex };
+        auto& entry = interned[key];
+        m_params = entry.lock();
+        if (!m_params) {
+            m_params = std::make_shared<const parsed_params>(details);
+            entry = m_params;
+            // Remove entries for parameters no longer in use
+            for (auto p = interned.begin(); p != interned.end();) {
+                p = p->second.expired() ? interned.erase(p) : std::next(p);
+            }
+        }
     }
 
     network_parameters::~network_parameters() = default;
@@ -599,44 +717,54 @@ namespace sdk {
         return *p->second;
     }
 
-    std::string network_parameters::network() const { return m_details.at("network"); }
-    std::string network_parameters::gait_wamp_url() const { return m_details.at("wamp_url"); }
-    std::vector<std::string> network_parameters::gait_wamp_cert_pins() const { return m_details.at("wamp_cert_pins"); }
-    std::vector<std::string> network_parameters::gait_wamp_cert_roots() const
+    const nlohmann::json& network_parameters::get_json() const { return m_params->m_details; }
+    const std::string& network_parameters::network() const { return m_params->m_network.get(); }
+    const std::string& network_parameters::gait_wamp_url() const { return m_params->m_wamp_url.get(); }
+    const std::vector<std::string>& network_parameters::gait_wamp_cert_pins() const
+    {
+        return m_params->m_wamp_cert_pins.get();
+    }
+    const std::vector<std::string>& network_parameters::gait_wamp_cert_roots() const
+    {
+        return m_params->m_wamp_cert_roots.get();
+    }
+    const std::string& network_parameters::block_explorer_address() const
+    {
+        return m_params->m_address_explorer_url.get();
+    }
+    const std::string& network_parameters::block_explorer_tx() const { return m_params->m_tx_explorer_url.get(); }
+    const std::string& network_parameters::asset_registry_url() const { return m_params->m_asset_registry_url.get(); }
+    const std::string& network_parameters::asset_registry_onion_url() const
     {
-        return m_details.at("wamp_cert_roots");
+        return m_params->m_asset_registry_onion_url.get();
     }
-    std::string network_parameters::block_explorer_address() const { return m_details.at("address_explorer_url"); }
-    std::string network_parameters::block_explorer_tx() const { return m_details.at("tx_explorer_url"); }
-    std::string network_parameters::asset_registry_url() const { return m_details.at("asset_registry_url"); }
-    std::string network_parameters::asset_registry_onion_url() const
+    const std::string& network_parameters::chain_code() const { return m_params->m_service_chain_code.get(); }
+    bool network_parameters::electrum_tls() const { return m_params->m_electrum_tls.get(); }
+    const std::string& network_parameters::electrum_url() const { return m_params->m_electrum_url.get(); }
+    const std::string& network_parameters::pub_key() const { return m_params->m_service_pubkey.get(); }
+    const std::string& network_parameters::gait_onion() const { return m_params->m_wamp_onion_url.get(); }
+    const std::string& network_parameters::policy_asset() const { return m_params->m_policy_asset; }
+    const std::string& network_parameters::bip21_prefix() const { return m_params->m_bip21_prefix.get(); }
+    const std::string& network_parameters::bech32_prefix() const { return m_params->m_bech32_prefix.get(); }
+    const std::string& network_parameters::blech32_prefix() const { return m_params->m_blech32_prefix.get(); }
+    const std::string& network_parameters::log_level() const { return m_params->m_log_level; }
+    unsigned char network_parameters::btc_version() const { return m_params->m_p2pkh_version.get(); }
+    unsigned char network_parameters::btc_p2sh_version() const { return m_params->m_p2sh_version.get(); }
+    uint32_t network_parameters::blinded_prefix() const { return m_params->m_blinded_prefix.get(); }
+    int network_parameters::ct_exponent() const { return m_params->m_ct_exponent.get(); }
+    int network_parameters::ct_bits() const { return m_params->m_ct_bits.get(); }
+    bool network_parameters::is_main_net() const { return m_params->m_mainnet.get(); }
+    bool network_parameters::is_liquid() const { return m_params->m_liquid; }
+    bool network_parameters::is_electrum() const { return m_params->m_electrum; }
+    bool network_parameters::use_tor() const { return m_params->m_use_tor; }
+    const std::string& network_parameters::socks5() const { return m_params->m_socks5; }
+    bool network_parameters::spv_enabled() const { return m_params->m_spv_enabled.get(); }
+    const std::string& network_parameters::user_agent() const { return m_params->m_user_agent; }
+    const std::string& network_parameters::get_connection_string() const
     {
-        return m_details.at("asset_registry_onion_url");
+        return use_tor() ? gait_onion() : gait_wamp_url();
     }
-    std::string network_parameters::chain_code() const { return m_details.at("service_chain_code"); }
-    bool network_parameters::electrum_tls() const { return m_details.at("electrum_tls"); }
-    std::string network_parameters::electrum_url() const { return m_details.at("electrum_url"); }
-    std::string network_parameters::pub_key() const { return m_details.at("service_pubkey"); }
-    std::string network_parameters::gait_onion() const { return m_details.at("wamp_onion_url"); }
-    std::string network_parameters::policy_asset() const { return m_details.value("policy_asset", std::string()); }
-    std::string network_parameters::bip21_prefix() const { return m_details.at("bip21_prefix"); }
-    std::string network_parameters::bech32_prefix() const { return m_details.at("bech32_prefix"); }
-    std::string network_parameters::blech32_prefix() const { return m_details.at("blech32_prefix"); }
-    std::string network_parameters::log_level() const { return m_details.value("log_level", "none"); }
-    unsigned char network_parameters::btc_version() const { return m_details.at("p2pkh_version"); }
-    unsigned char network_parameters::btc_p2sh_version() const { return m_details.at("p2sh_version"); }
-    uint32_t network_parameters::blinded_prefix() const { return m_details.at("blinded_prefix"); }
-    int network_parameters::ct_exponent() const { return m_details.at("ct_exponent"); }
-    int network_parameters::ct_bits() const { return m_details.at("ct_bits"); }
-    bool network_parameters::is_main_net() const { return m_details.at("mainnet"); }
-    bool network_parameters::is_liquid() const { return m_details.value("liquid", false); }
-    bool network_parameters::is_electrum() const { return m_details.value("server_type", std::string()) == "electrum"; }
-    bool network_parameters::use_tor() const { return m_details.value("use_tor", false); }
-    std::string network_parameters::socks5() const { return m_details.value("socks5", std::string()); }
-    bool network_parameters::spv_enabled() const { return m_details.at("spv_enabled"); }
-    std::string network_parameters::user_agent() const { return m_details.value("user_agent", std::string()); }
-    std::string network_parameters::get_connection_string() const { return use_tor() ? gait_onion() : gait_wamp_url(); }
-    std::string network_parameters::get_registry_connection_string() const
+    const std::string& network_parameters::get_registry_connection_string() const
     {
         return use_tor() ? asset_registry_onion_url() : asset_registry_url();
     }
@@ -644,8 +772,8 @@ namespace sdk {
     {
         return boost::algorithm::starts_with(get_connection_string(), "wss://");
     }
-    std::vector<uint32_t> network_parameters::csv_buckets() const { return m_details.at("csv_buckets"); }
-    uint32_t network_parameters::cert_expiry_threshold() const { return m_details.at("cert_expiry_threshold"); }
+    const std::vector<uint32_t>& network_parameters::csv_buckets() const { return m_params->m_csv_buckets.get(); }
+    uint32_t network_parameters::cert_expiry_threshold() const { return m_params->m_cert_expiry_threshold.get(); }
 
 } // namespace sdk
 } // namespace ga
@@ -13,6 +13,9 @@
 namespace ga {
 namespace sdk {
 
+    // Network parameters for a session. Parameters are parsed once on
+    // construction and shared between instances with identical details,
+    // so copying is cheap and field accessors do not perform JSON lookups.
     class network_parameters final {
     public:
         static void add(const std::string& name, const nlohmann::json& details);
@@ -29,25 +32,25 @@ namespace sdk {
         network_parameters(network_parameters&&) = default;
         network_parameters& operator=(network_parameters&&) = default;
 
-        const nlohmann::json& get_json() const { return m_details; }
+        const nlohmann::json& get_json() const;
 
-        std::string network() const;
-        std::string gait_wamp_url() const;
-        std::vector<std::string> gait_wamp_cert_pins() const;
-        std::vector<std::string> gait_wamp_cert_roots() const;
-        std::string block_explorer_address() const;
-        std::string block_explorer_tx() const;
-        std::string asset_registry_url() const;
-        std::string asset_registry_onion_url() const;
-        std::string chain_code() const;
-        std::string electrum_url() const;
-        std::string pub_key() const;
-        std::string gait_onion() const;
-        std::string policy_asset() const;
-        std::string bip21_prefix() const;
-        std::string bech32_prefix() const;
-        std::string blech32_prefix() const;
-        std::string log_level() const;
+        const std::string& network() const;
+        const std::string& gait_wamp_url() const;
+        const std::vector<std::string>& gait_wamp_cert_pins() const;
+        const std::vector<std::string>& gait_wamp_cert_roots() const;
+        const std::string& block_explorer_address() const;
+        const std::string& block_explorer_tx() const;
+        const std::string& asset_registry_url() const;
+        const std::string& asset_registry_onion_url() const;
+        const std::string& chain_code() const;
+        const std::string& electrum_url() const;
+        const std::string& pub_key() const;
+        const std::string& gait_onion() const;
+        const std::string& policy_asset() const;
+        const std::string& bip21_prefix() const;
+        const std::string& bech32_prefix() const;
+        const std::string& blech32_prefix() const;
+        const std::string& log_level() const;
         unsigned char btc_version() const;
         unsigned char btc_p2sh_version() const;
         uint32_t blinded_prefix() const;
@@ -57,18 +60,19 @@ namespace sdk {
         bool is_liquid() const;
         bool is_electrum() const;
         bool use_tor() const;
-        std::string socks5() const;
+        const std::string& socks5() const;
         bool spv_enabled() const;
         bool electrum_tls() const;
-        std::string user_agent() const;
-        std::string get_connection_string() const;
-        std::string get_registry_connection_string() const;
+        const std::string& user_agent() const;
+        const std::string& get_connection_string() const;
+        const std::string& get_registry_connection_string() const;
         bool is_tls_connection() const;
-        std::vector<uint32_t> csv_buckets() const;
+        const std::vector<uint32_t>& csv_buckets() const;
         uint32_t cert_expiry_threshold() const;
 
     private:
-        nlohmann::json m_details;
+        struct parsed_params;
+        std::shared_ptr<const parsed_params> m_params;
     };
 } // namespace sdk
 } // namespace ga
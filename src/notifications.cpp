@@ -0,0 +1,152 @@
+#include <algorithm>
+
+#include "notifications.hpp"
+
+namespace ga {
+namespace sdk {
+
+    namespace {
+        // FNV-1a
+        static const uint64_t FNV_OFFSET_BASIS = 0xcbf29ce484222325ull;
+        static const uint64_t FNV_PRIME = 0x100000001b3ull;
+
+        static uint64_t hash_bytes(uint64_t h, const void* data, std::size_t len)
+        {
+            const auto p = static_cast<const unsigned char*>(data);
+            for (std::size_t i = 0; i < len; ++i) {
+                h = (h ^ p[i]) * FNV_PRIME;
+            }
+            return h;
+        }
+
+        static uint64_t hash_string(uint64_t h, const std::string& s)
+        {
+            const uint64_t len = s.size();
+            return hash_bytes(hash_bytes(h, &len, sizeof(len)), s.data(), s.size());
+        }
+
+        static uint64_t hash_u64(uint64_t h, uint64_t v) { return hash_bytes(h, &v, sizeof(v)); }
+
+        // Events where only the newest notification is meaningful
+        static bool is_superseded_by_newer(const std::string& event) { return event == "block" || event == "ticker"; }
+    } // namespace
+
+    tx_notification_filter::tx_notification_filter(clock::duration window, std::size_t max_entries)
+        : m_window(window)
+        , m_max_entries(max_entries)
+    {
+    }
+
+    bool tx_notification_filter::insert(const nlohmann::json& details, clock::time_point now)
+    {
+        expire(now);
+        const uint64_t h = hash(details);
+        if (!m_seen.insert(h).second) {
+            return false;
+        }
+        m_ring.emplace_back(now, h);
+        if (m_ring.size() > m_max_entries) {
+            m_seen.erase(m_ring.front().second);
+            m_ring.pop_front();
+        }
+        return true;
+    }
+
+    void tx_notification_filter::clear()
+    {
+        m_ring.clear();
+        m_seen.clear();
+    }
+
+    void tx_notification_filter::expire(clock::time_point now)
+    {
+        while (!m_ring.empty() && now - m_ring.front().first > m_window) {
+            m_seen.erase(m_ring.front().second);
+            m_ring.pop_front();
+        }
+    }
+
+    uint64_t tx_notification_filter::hash(const nlohmann::json& details)
+    {
+        uint64_t h = FNV_OFFSET_BASIS;
+        for (const auto& item : details.items()) {
+            // Keys are iterated in sorted order, so the hash is canonical
+            const auto& key = item.key();
+            const auto& value = item.value();
+            h = hash_string(h, key);
+            h = hash_u64(h, static_cast<uint64_t>(value.type()));
+            if (value.is_string()) {
+                h = hash_string(h, value.get_ref<const std::string&>());
+            } else if (value.is_number_unsigned()) {
+                h = hash_u64(h, value.get<uint64_t>());
+            } else if (key == "subaccounts" && value.is_array()) {
+                h = hash_u64(h, value.size());
+                for (const auto& subaccount : value) {
+                    h = hash_u64(h, subaccount.get<uint32_t>());
+                }
+            } else {
+                // Other optional fields
+                h = hash_u64(h, std::hash<nlohmann::json>{}(value));
+            }
+        }
+        return h;
+    }
+
+    notification_queue::notification_queue(std::size_t max_size)
+        : m_max_size(max_size)
+        , m_coalesced(0)
+        , m_dropped(0)
+        , m_delivering(false)
+    {
+    }
+
+    bool notification_queue::push(nlohmann::json details)
+    {
+        std::lock_guard<std::mutex> _(m_mutex);
+
+        const auto event_p = details.find("event");
+        if (event_p != details.end() && event_p->is_string()) {
+            const auto& event = event_p->get_ref<const std::string&>();
+            if (is_superseded_by_newer(event)) {
+                // Remove the older pending event; the newest is queued below
+                const auto p = std::find_if(m_queue.begin(), m_queue.end(),
+                    [&event](const nlohmann::json& n) { return n.value("event", std::string()) == event; });
+                if (p != m_queue.end()) {
+                    m_queue.erase(p);
+                    ++m_coalesced;
+                }
+            }
+        }
+
+        if (m_queue.size() >= m_max_size) {
+            m_queue.pop_front();
+            ++m_dropped;
+        }
+        m_queue.emplace_back(std::move(details));
+
+        if (m_delivering) {
+            return false; // The delivering thread will pick this up
+        }
+        m_delivering = true;
+        return true;
+    }
+
+    nlohmann::json notification_queue::pop_batch()
+    {
+        std::lock_guard<std::mutex> _(m_mutex);
+        if (m_queue.empty()) {
+            m_delivering = false;
+            return nlohmann::json();
+        }
+        nlohmann::json::array_t notifications{ std::make_move_iterator(m_queue.begin()),
+            std::make_move_iterator(m_queue.end()) };
+        m_queue.clear();
+        nlohmann::json batch = { { "notifications", std::move(notifications) }, { "coalesced", m_coalesced },
+            { "dropped", m_dropped } };
+        m_coalesced = 0;
+        m_dropped = 0;
+        return batch;
+    }
+
+} // namespace sdk
+} // namespace ga
@@ -0,0 +1,75 @@
+#ifndef GDK_NOTIFICATIONS_HPP
+#define GDK_NOTIFICATIONS_HPP
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+
+#include <nlohmann/json.hpp>
+
+namespace ga {
+namespace sdk {
+
+    // Elides duplicate transaction notifications sent by the server.
+    // Notifications are keyed by a 64 bit hash of their contents and
+    // remembered for a fixed time window, up to a maximum number of entries.
+    class tx_notification_filter {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        explicit tx_notification_filter(
+            clock::duration window = std::chrono::seconds(60), std::size_t max_entries = 4096);
+
+        // Returns true and records the notification if it hasn't been seen
+        // within the window, or false if it is a duplicate
+        bool insert(const nlohmann::json& details, clock::time_point now = clock::now());
+
+        void clear();
+
+        // Hash of a cleaned up tx notification: txhash, subaccounts and
+        // value, along with any optional fields
+        static uint64_t hash(const nlohmann::json& details);
+
+    private:
+        void expire(clock::time_point now);
+
+        const clock::duration m_window;
+        const std::size_t m_max_entries;
+        std::deque<std::pair<clock::time_point, uint64_t>> m_ring; // Oldest first
+        std::unordered_set<uint64_t> m_seen;
+    };
+
+    // A bounded queue of notifications awaiting delivery to a batch handler.
+    // Superseded events (older "block" and "ticker" notifications) are
+    // coalesced, and the oldest notifications are dropped if the queue is full.
+    class notification_queue {
+    public:
+        explicit notification_queue(std::size_t max_size = 1000);
+
+        // Queue a notification. Returns true if the caller should deliver the
+        // queued notifications, i.e. no other thread is already delivering them
+        bool push(nlohmann::json details);
+
+        // Take the queued notifications as a batch for delivery, along with
+        // the number coalesced or dropped since the last batch. Returns null
+        // and ends the current delivery when the queue is empty.
+        nlohmann::json pop_batch();
+
+    private:
+        const std::size_t m_max_size;
+        std::mutex m_mutex;
+        std::deque<nlohmann::json> m_queue;
+        uint64_t m_coalesced;
+        uint64_t m_dropped;
+        bool m_delivering;
+    };
+
+} // namespace sdk
+} // namespace ga
+
+#endif
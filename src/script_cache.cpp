@@ -0,0 +1,127 @@
+#include "script_cache.hpp"
+#include "assertion.hpp"
+#include "containers.hpp"
+#include "memory.hpp"
+#include "network_parameters.hpp"
+#include "transaction_utils.hpp"
+#include "xpub_hdkey.hpp"
+
+namespace ga {
+namespace sdk {
+
+    script_cache::script_cache(std::size_t max_entries)
+        : m_max_entries(max_entries)
+        , m_generation(0)
+    {
+        GDK_RUNTIME_ASSERT(m_max_entries != 0);
+    }
+
+    script_cache::key_t script_cache::make_key(const network_parameters& net_params, const nlohmann::json& utxo)
+    {
+        const uint32_t subaccount = json_get_value(utxo, "subaccount", 0u);
+        const uint32_t pointer = utxo.at("pointer");
+        const script_type type = utxo.at("script_type");
+        const uint32_t subtype = csv_subtype_from_utxo(net_params, utxo);
+        return key_t{ subaccount, pointer, static_cast<uint32_t>(type), subtype };
+    }
+
+    const script_cache::entry& script_cache::get(const network_parameters& net_params, ga_pubkeys& pubkeys,
+        user_pubkeys& usr_pubkeys, user_pubkeys& recovery_pubkeys, const nlohmann::json& utxo)
+    {
+        const key_t key = make_key(net_params, utxo);
+        const auto p = m_entries.find(key);
+        if (p != m_entries.end()) {
+            return p->second;
+        }
+
+        const uint32_t subaccount = std::get<0>(key);
+        const auto ga = pubkeys.get_subaccount(subaccount);
+        const auto user = usr_pubkeys.get_subaccount(subaccount);
+        if (recovery_pubkeys.have_subaccount(subaccount)) {
+            // 2of3
+            const auto recovery = recovery_pubkeys.get_subaccount(subaccount);
+            return insert(key, make_entry(net_params, ga, user, &recovery, utxo));
+        }
+        // 2of2
+        return insert(key, make_entry(net_params, ga, user, nullptr, utxo));
+    }
+
+    const script_cache::entry* script_cache::find(
+        const network_parameters& net_params, const nlohmann::json& utxo) const
+    {
+        const auto p = m_entries.find(make_key(net_params, utxo));
+        return p == m_entries.end() ? nullptr : &p->second;
+    }
+
+    script_cache::entry script_cache::make_entry(const network_parameters& net_params, const xpub_hdkey& ga,
+        const xpub_hdkey& user, const xpub_hdkey* recovery, const nlohmann::json& utxo)
+    {
+        const uint32_t pointer = utxo.at("pointer");
+        const script_type type = utxo.at("script_type");
+        const uint32_t subtype = csv_subtype_from_utxo(net_params, utxo);
+
+        entry e;
+        e.pubkeys.reserve(3);
+        e.pubkeys.emplace_back(ga.derive(pointer));
+        e.pubkeys.emplace_back(user.derive(pointer));
+        if (recovery != nullptr) {
+            e.pubkeys.emplace_back(recovery->derive(pointer));
+            e.script = output_script(net_params, e.pubkeys[0], e.pubkeys[1], e.pubkeys[2], type, subtype);
+        } else {
+            e.script = output_script(net_params, e.pubkeys[0], e.pubkeys[1], empty_span(), type, subtype);
+        }
+        return e;
+    }
+
+    void script_cache::insert(const network_parameters& net_params, const nlohmann::json& utxo, entry e)
+    {
+        insert(make_key(net_params, utxo), std::move(e));
+    }
+
+    const script_cache::entry& script_cache::insert(const key_t& key, entry e)
+    {
+        if (m_entries.size() >= m_max_entries) {
+            // Rather than tracking usage, start again; entries are cheap to
+            // recompute and typical wallets never reach the limit
+            m_entries.clear();
+        }
+        auto& cached = m_entries[key];
+        cached = std::move(e);
+        return cached;
+    }
+
+    void script_cache::fill(const network_parameters& net_params, ga_pubkeys& pubkeys, user_pubkeys& usr_pubkeys,
+        user_pubkeys& recovery_pubkeys, const nlohmann::json& utxos)
+    {
+        for (const auto& utxo : utxos) {
+            if (!utxo.contains("pointer") || !utxo.contains("script_type")
+                || utxo["script_type"] == script_type::ga_pubkey_hash_out) {
+                continue; // Not a multisig script, e.g. a sweep UTXO
+            }
+            try {
+                get(net_params, pubkeys, usr_pubkeys, recovery_pubkeys, utxo);
+            } catch (const std::exception&) {
+                // Invalid UTXOs are reported to the caller when they are used
+            }
+        }
+    }
+
+    void script_cache::invalidate(uint32_t subaccount)
+    {
+        const auto begin = m_entries.lower_bound(key_t{ subaccount, 0, 0, 0 });
+        auto end = m_entries.end();
+        if (subaccount != 0xffffffff) {
+            end = m_entries.lower_bound(key_t{ subaccount + 1, 0, 0, 0 });
+        }
+        m_entries.erase(begin, end);
+        ++m_generation;
+    }
+
+    void script_cache::clear()
+    {
+        m_entries.clear();
+        ++m_generation;
+    }
+
+} // namespace sdk
+} // namespace ga
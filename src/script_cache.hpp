@@ -0,0 +1,80 @@
+#ifndef GDK_SCRIPT_CACHE_HPP
+#define GDK_SCRIPT_CACHE_HPP
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "ga_wally.hpp"
+
+namespace ga {
+namespace sdk {
+    class ga_pubkeys;
+    class network_parameters;
+    class user_pubkeys;
+    class xpub_hdkey;
+
+    // Caches the prevout scripts and pubkeys of multisig UTXOs/addresses,
+    // keyed by (subaccount, pointer, script_type, csv_blocks).
+    // Derived keys for a subaccount never change once it is known, so entries
+    // only need invalidating when the sessions subaccounts change.
+    // Not thread safe; callers must serialize access.
+    class script_cache {
+    public:
+        struct entry {
+            std::vector<unsigned char> script;
+            std::vector<pub_key_t> pubkeys; // ga, user and for 2of3, recovery
+        };
+
+        explicit script_cache(std::size_t max_entries = 65536);
+
+        // Return the cached entry for a UTXO, computing it if not present
+        const entry& get(const network_parameters& net_params, ga_pubkeys& pubkeys, user_pubkeys& usr_pubkeys,
+            user_pubkeys& recovery_pubkeys, const nlohmann::json& utxo);
+
+        // Return the cached entry for a UTXO, or nullptr if not present
+        const entry* find(const network_parameters& net_params, const nlohmann::json& utxo) const;
+
+        // Compute the entry for a UTXO from the subaccount xpubs of its
+        // signers, without reference to the cache. recovery is null for 2of2.
+        // Thread safe, allowing callers to derive many entries in parallel.
+        static entry make_entry(const network_parameters& net_params, const xpub_hdkey& ga, const xpub_hdkey& user,
+            const xpub_hdkey* recovery, const nlohmann::json& utxo);
+
+        void insert(const network_parameters& net_params, const nlohmann::json& utxo, entry e);
+
+        // Compute and cache entries for any UTXOs that are not yet present
+        void fill(const network_parameters& net_params, ga_pubkeys& pubkeys, user_pubkeys& usr_pubkeys,
+            user_pubkeys& recovery_pubkeys, const nlohmann::json& utxos);
+
+        // Remove all entries for a subaccount
+        void invalidate(uint32_t subaccount);
+
+        void clear();
+
+        std::size_t size() const { return m_entries.size(); }
+
+        // Changes whenever entries are invalidated, so that callers deriving
+        // entries outside of their lock can tell if they are still valid
+        uint64_t generation() const { return m_generation; }
+
+    private:
+        using key_t = std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>;
+
+        static key_t make_key(const network_parameters& net_params, const nlohmann::json& utxo);
+        const entry& insert(const key_t& key, entry e);
+
+        const std::size_t m_max_entries;
+        std::map<key_t, entry> m_entries;
+        uint64_t m_generation;
+    };
+
+} // namespace sdk
+} // namespace ga
+
+#endif
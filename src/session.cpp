@@ -10,6 +10,7 @@
 
 #include "autobahn_wrapper.hpp"
 #include "exception.hpp"
+#include "executor.hpp"
 #include "ga_session.hpp"
 #include "logging.hpp"
 #include "network_parameters.hpp"
@@ -48,6 +49,8 @@ namespace sdk {
         GDK_VERIFY(wally_secp_randomize(entropy.data(), entropy.size()));
         wally_bzero(entropy.data(), entropy.size());
 
+        init_shared_executor(config);
+
 #if defined(__ANDROID__) and not defined(NDEBUG)
         start_android_std_outerr_bridge();
 #endif
@@ -147,6 +150,7 @@ namespace sdk {
                     GDK_LOG_SEV(log_level::info) << "pong timeout ignored on dead session";
                 }
             });
+            session_p->set_batch_notification_handler(m_batch_notification_handler, m_batch_notification_context);
             session_p->set_notification_handler(m_notification_handler, m_notification_context);
 
             boost::shared_ptr<session_impl> empty;
@@ -289,6 +293,14 @@ namespace sdk {
         m_notification_context = context;
     }
 
+    void session::set_batch_notification_handler(GA_batch_notification_handler handler, void* context)
+    {
+        auto p = get_impl();
+        GDK_RUNTIME_ASSERT(p == nullptr);
+        m_batch_notification_handler = handler;
+        m_batch_notification_context = context;
+    }
+
     nlohmann::json session::get_available_currencies()
     {
         return exception_wrapper([&] {
@@ -396,6 +408,18 @@ namespace sdk {
         });
     }
 
+    nlohmann::json session::convert_amounts(const nlohmann::json& details)
+    {
+        return exception_wrapper([&] {
+            auto p = get_impl();
+            if (p) {
+                return p->convert_amounts(details);
+            }
+            // As for convert_amount, use any provided fallback fiat values
+            return amount::convert_amounts(details, std::string(), std::string());
+        });
+    }
+
     const network_parameters& session::get_network_parameters() const
     {
         auto p = get_nonnull_impl();
@@ -44,6 +44,7 @@ namespace sdk {
         std::string get_watch_only_username();
 
         void set_notification_handler(GA_notification_handler handler, void* context);
+        void set_batch_notification_handler(GA_batch_notification_handler handler, void* context);
 
         void rename_subaccount(uint32_t subaccount, const std::string& new_name);
 
@@ -72,6 +73,7 @@ namespace sdk {
         std::string get_system_message();
 
         nlohmann::json convert_amount(const nlohmann::json& amount_json);
+        nlohmann::json convert_amounts(const nlohmann::json& details);
 
         const network_parameters& get_network_parameters() const;
 
@@ -92,6 +94,8 @@ namespace sdk {
 
         GA_notification_handler m_notification_handler{ nullptr };
         void* m_notification_context{ nullptr };
+        GA_batch_notification_handler m_batch_notification_handler{ nullptr };
+        void* m_batch_notification_context{ nullptr };
     };
 } // namespace sdk
 } // namespace ga
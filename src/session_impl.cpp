@@ -69,6 +69,8 @@ namespace sdk {
         , m_debug_logging(m_net_params.log_level() == "debug")
         , m_notification_handler(nullptr)
         , m_notification_context(nullptr)
+        , m_batch_notification_handler(nullptr)
+        , m_batch_notification_context(nullptr)
     {
         configure_logging(m_net_params);
     }
@@ -81,12 +83,33 @@ namespace sdk {
         m_notification_context = context;
     }
 
+    void session_impl::set_batch_notification_handler(GA_batch_notification_handler handler, void* context)
+    {
+        m_batch_notification_handler = handler;
+        m_batch_notification_context = context;
+    }
+
     void session_impl::emit_notification(nlohmann::json details, bool /*async*/)
     {
         // By default, ignore the async flag
-        if (m_notification_handler) {
+        if (m_batch_notification_handler) {
+            if (!m_notification_queue.push(std::move(details))) {
+                return; // Another thread is delivering, it will deliver this too
+            }
+            // Deliver until the queue is empty. Notifications emitted by
+            // other threads meanwhile are queued and delivered in later batches
+            for (;;) {
+                auto batch = m_notification_queue.pop_batch();
+                if (batch.is_null()) {
+                    break;
+                }
+                // We use 'new' here as it is the handlers responsibility to 'delete'
+                const auto batch_p = reinterpret_cast<GA_json*>(new nlohmann::json(std::move(batch)));
+                m_batch_notification_handler(m_batch_notification_context, batch_p);
+            }
+        } else if (m_notification_handler) {
             // We use 'new' here as it is the handlers responsibility to 'delete'
-            const auto details_p = reinterpret_cast<GA_json*>(new nlohmann::json(details));
+            const auto details_p = reinterpret_cast<GA_json*>(new nlohmann::json(std::move(details)));
             m_notification_handler(m_notification_context, details_p);
         }
     }
@@ -116,6 +139,17 @@ namespace sdk {
         return false;
     }
 
+    nlohmann::json session_impl::get_transactions_hex(const std::vector<std::string>& txhashes) const
+    {
+        nlohmann::json result = nlohmann::json::object();
+        for (const auto& txhash : txhashes) {
+            if (!result.contains(txhash)) {
+                result.emplace(txhash, get_transaction_details(txhash).at("transaction"));
+            }
+        }
+        return result;
+    }
+
     void session_impl::save_cache()
     {
         // Refers to the ga_session cache at the moment, so a no-op for rust sessions
@@ -168,6 +202,27 @@ namespace sdk {
         }
     }
 
+    bool session_impl::update_cached_utxos(
+        uint32_t subaccount, const std::vector<utxo_ref_t>& spent, const nlohmann::json& created)
+    {
+        std::vector<utxo_cache_value_t> tmp_values; // Delete outside of lock
+        locker_t locker(m_utxo_cache_mutex);
+        for (const uint32_t num_confs : { 0u, 1u }) {
+            auto p = m_utxo_cache.find({ subaccount, num_confs });
+            if (p == m_utxo_cache.end()) {
+                continue;
+            }
+            // Update a copy, since callers may hold the current value
+            nlohmann::json utxos = *p->second;
+            tmp_values.push_back(p->second);
+            if (!apply_utxo_delta(utxos.at("unspent_outputs"), num_confs, spent, created)) {
+                return false;
+            }
+            p->second = std::make_shared<const nlohmann::json>(std::move(utxos));
+        }
+        return true;
+    }
+
     void session_impl::process_unspent_outputs(nlohmann::json& /*utxos*/)
     {
         // Only needed for multisig until singlesig supports HWW
@@ -7,7 +7,9 @@
 #include "amount.hpp"
 #include "autobahn_wrapper.hpp"
 #include "network_parameters.hpp"
+#include "notifications.hpp"
 #include "signer.hpp"
+#include "utxo_cache.hpp"
 
 namespace ga {
 namespace sdk {
@@ -43,6 +45,10 @@ namespace sdk {
         utxo_cache_value_t set_cached_utxos(uint32_t subaccount, uint32_t num_confs, nlohmann::json& utxos);
         // Un-encache UTXOs
         void remove_cached_utxos(const std::vector<uint32_t>& subaccounts);
+        // Update encached UTXOs with the outputs a new tx spends and creates.
+        // Returns false if the encached UTXOs couldn't be updated consistently
+        bool update_cached_utxos(
+            uint32_t subaccount, const std::vector<utxo_ref_t>& spent, const nlohmann::json& created);
 
         virtual nlohmann::json get_unspent_outputs(const nlohmann::json& details, unique_pubkeys_and_scripts_t& missing)
             = 0;
@@ -99,6 +105,7 @@ namespace sdk {
         virtual nlohmann::json get_transactions(const nlohmann::json& details) = 0;
 
         virtual void set_notification_handler(GA_notification_handler handler, void* context);
+        void set_batch_notification_handler(GA_batch_notification_handler handler, void* context);
 
         virtual nlohmann::json get_receive_address(const nlohmann::json& details) = 0;
         virtual nlohmann::json get_previous_addresses(uint32_t subaccount, uint32_t last_pointer) = 0;
@@ -158,6 +165,8 @@ namespace sdk {
             = 0;
 
         virtual nlohmann::json get_transaction_details(const std::string& txhash_hex) const = 0;
+        // Get the raw hex of the given transactions as an object keyed by txhash
+        virtual nlohmann::json get_transactions_hex(const std::vector<std::string>& txhashes) const;
 
         virtual nlohmann::json create_transaction(const nlohmann::json& details) = 0;
         virtual nlohmann::json sign_transaction(const nlohmann::json& details) = 0;
@@ -179,6 +188,7 @@ namespace sdk {
         virtual void ack_system_message(const std::string& message_hash_hex, const std::string& sig_der_hex) = 0;
 
         virtual nlohmann::json convert_amount(const nlohmann::json& amount_json) const = 0;
+        virtual nlohmann::json convert_amounts(const nlohmann::json& details) const = 0;
 
         virtual amount get_min_fee_rate() const = 0;
         virtual amount get_default_fee_rate() const = 0;
@@ -233,6 +243,11 @@ namespace sdk {
         // Immutable once set by the caller (prior to connect)
         GA_notification_handler m_notification_handler;
         void* m_notification_context;
+        GA_batch_notification_handler m_batch_notification_handler;
+        void* m_batch_notification_context;
+
+        // Notifications awaiting delivery to the batch handler
+        notification_queue m_notification_queue;
 
         // Immutable post-login
         std::shared_ptr<signer> m_signer;
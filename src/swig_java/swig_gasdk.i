@@ -17,6 +17,9 @@ static const char* TO_STRING_METHOD_NAME = "toJSONString";
 static const char* TO_STRING_METHOD_ARGS = "(Ljava/lang/Object;)Ljava/lang/String;";
 static const char* NOTIFY_METHOD_NAME = "callNotificationHandler";
 static const char* NOTIFY_METHOD_ARGS = "(Ljava/lang/Object;Ljava/lang/Object;)V";
+static const char* NOTIFY_BATCH_METHOD_NAME = "callBatchNotificationHandler";
+static const char* HAS_BATCH_METHOD_NAME = "hasBatchNotificationHandler";
+static const char* HAS_BATCH_METHOD_ARGS = "()Z";
 static const char* OBJ_CLASS  = "com/blockstream/libgreenaddress/GDK$Obj";
 
 static JavaVM* g_jvm;
@@ -25,6 +28,8 @@ static jclass g_gasdk;
 static jmethodID g_gasdk_toJSONObject;
 static jmethodID g_gasdk_toJSONString;
 static jmethodID g_gasdk_callNotificationHandler;
+static jmethodID g_gasdk_callBatchNotificationHandler;
+static jmethodID g_gasdk_hasBatchNotificationHandler;
 
 static jclass g_gasdk_obj;
 static jmethodID g_gasdk_obj_ctor;
@@ -59,6 +64,8 @@ JNIEXPORT jint JNI_OnLoad(JavaVM* jvm, void* reserved)
     g_gasdk_toJSONObject = (*jenv)->GetStaticMethodID(jenv, g_gasdk, TO_OBJECT_METHOD_NAME, TO_OBJECT_METHOD_ARGS);
     g_gasdk_toJSONString = (*jenv)->GetStaticMethodID(jenv, g_gasdk, TO_STRING_METHOD_NAME, TO_STRING_METHOD_ARGS);
     g_gasdk_callNotificationHandler = (*jenv)->GetStaticMethodID(jenv, g_gasdk, NOTIFY_METHOD_NAME, NOTIFY_METHOD_ARGS);
+    g_gasdk_callBatchNotificationHandler = (*jenv)->GetStaticMethodID(jenv, g_gasdk, NOTIFY_BATCH_METHOD_NAME, NOTIFY_METHOD_ARGS);
+    g_gasdk_hasBatchNotificationHandler = (*jenv)->GetStaticMethodID(jenv, g_gasdk, HAS_BATCH_METHOD_NAME, HAS_BATCH_METHOD_ARGS);
     g_gasdk_obj_ctor = (*jenv)->GetMethodID(jenv, g_gasdk_obj, "<init>", "(JI)V");
     g_gasdk_obj_get_id = (*jenv)->GetMethodID(jenv, g_gasdk_obj, "get_id", "()I");
     g_gasdk_obj_get = (*jenv)->GetMethodID(jenv, g_gasdk_obj, "get", "()J");
@@ -176,8 +183,8 @@ typedef struct notification_context
     jobject m_session_obj;
 } notify_t;
 
-/* Call any registered notification handler */
-LOCALFUNC void notification_handler(void* context_p, GA_json* details)
+/* Call the given java notification handler method */
+LOCALFUNC void call_notification_handler(void* context_p, GA_json* details, jmethodID method)
 {
     JNIEnv *jenv;
     notify_t* n = (notify_t*) context_p;
@@ -204,7 +211,7 @@ LOCALFUNC void notification_handler(void* context_p, GA_json* details)
 
     json_obj = create_json(jenv, (void *)details);
     if (!(*jenv)->ExceptionOccurred(jenv) && json_obj)
-        (*jenv)->CallStaticVoidMethod(jenv, g_gasdk, g_gasdk_callNotificationHandler, n->m_session_obj, json_obj);
+        (*jenv)->CallStaticVoidMethod(jenv, g_gasdk, method, n->m_session_obj, json_obj);
 
 end:
     if ((*jenv)->ExceptionOccurred(jenv)) {
@@ -215,6 +222,20 @@ end:
         (*g_jvm)->DetachCurrentThread(g_jvm);
 }
 
+/* Call any registered notification handler */
+LOCALFUNC void notification_handler(void* context_p, GA_json* details)
+{
+    call_notification_handler(context_p, details, g_gasdk_callNotificationHandler);
+}
+
+/* Call any registered batch notification handler */
+LOCALFUNC void batch_notification_handler(void* context_p, GA_json* batch)
+{
+    if (!batch)
+        return; /* Un-registering is handled by notification_handler */
+    call_notification_handler(context_p, batch, g_gasdk_callBatchNotificationHandler);
+}
+
 /* Create and return a java object to hold an opaque pointer */
 LOCALFUNC jobject create_obj(JNIEnv *jenv, void *p, int id) {
     jobject obj = 0;
@@ -238,6 +259,10 @@ LOCALFUNC jobject create_obj(JNIEnv *jenv, void *p, int id) {
         }
         /* FIXME: Error handling if this call fails */
         GA_set_notification_handler(n->m_session, notification_handler, n);
+        /* Batches are delivered in place of single notifications, so only
+         * register for them if the caller has set a batch handler */
+        if ((*jenv)->CallStaticBooleanMethod(jenv, g_gasdk, g_gasdk_hasBatchNotificationHandler))
+            GA_set_batch_notification_handler(n->m_session, batch_notification_handler, n);
         return n->m_session_obj;
     }
     return obj;
@@ -276,6 +301,7 @@ LOCALFUNC jbyteArray create_array(JNIEnv *jenv, const unsigned char* p, size_t l
 
 %javaconst(1);
 %ignore GA_destroy_string;
+%ignore GA_set_batch_notification_handler; /* Use setBatchNotificationHandler */
 
 %pragma(java) jniclasscode=%{
     private static boolean loadLibrary() {
@@ -330,6 +356,27 @@ LOCALFUNC jbyteArray create_array(JNIEnv *jenv, const unsigned char* p, size_t l
             mNotificationHandler.onNewNotification(session, jsonObject);
     }
 
+    // Notification batches, delivered in place of single notifications to
+    // sessions created while a batch handler is set
+    public interface BatchNotificationHandler {
+       void onNewNotificationBatch(final Object session, final Object jsonObject);
+    }
+
+    private static BatchNotificationHandler mBatchNotificationHandler = null;
+
+    public static void setBatchNotificationHandler(final BatchNotificationHandler batchNotificationHandler) {
+        mBatchNotificationHandler = batchNotificationHandler;
+    }
+
+    private static boolean hasBatchNotificationHandler() {
+        return mBatchNotificationHandler != null;
+    }
+
+    private static void callBatchNotificationHandler(final Object session, final Object jsonObject) {
+        if (mBatchNotificationHandler != null)
+            mBatchNotificationHandler.onNewNotificationBatch(session, jsonObject);
+    }
+
     static final class Obj {
         private final transient long ptr;
         private final int id;
@@ -487,6 +534,7 @@ LOCALFUNC jbyteArray create_array(JNIEnv *jenv, const unsigned char* p, size_t l
 %returns_string(GA_broadcast_transaction)
 %returns_void__(GA_connect)
 %returns_struct(GA_convert_amount, GA_json)
+%returns_struct(GA_convert_amounts, GA_json)
 %returns_string(GA_convert_json_to_string)
 %returns_string(GA_convert_json_value_to_string)
 %returns_struct(GA_convert_string_to_json, GA_json)
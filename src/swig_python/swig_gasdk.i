@@ -163,6 +163,57 @@ static int _python_set_callback_handler(PyObject* obj, PyObject* arg)
     return GA_OK;
 }
 
+/* The batch handler context is a (session capsule, handler) tuple */
+static void batch_notification_handler(void* context_p, GA_json* batch)
+{
+    PyObject* context = (PyObject*) context_p;
+    PyObject* session_capsule = NULL;
+    PyObject* handler = NULL;
+    char* json_cstring = NULL;
+
+    if (!context || !batch)
+        return;
+
+    if (GA_convert_json_to_string(batch, &json_cstring) != GA_OK)
+        return;
+    GA_destroy_json(batch);
+
+    SWIG_PYTHON_THREAD_BEGIN_BLOCK;
+    if (!PyArg_ParseTuple(context, "OO", &session_capsule, &handler)) {
+        PyErr_Clear();
+        goto end;
+    }
+
+    PyObject *args = Py_BuildValue("(Os)", session_capsule, json_cstring);
+    if (!args)
+        goto end;
+
+    PyEval_CallObject(handler, args);
+    Py_DecRef(args);
+
+end:
+    SWIG_PYTHON_THREAD_END_BLOCK;
+
+    GA_destroy_string(json_cstring);
+}
+
+static int _python_set_batch_callback_handler(PyObject* obj, PyObject* arg)
+{
+    struct GA_session *p = (struct GA_session *)PyCapsule_GetPointer(obj, "struct GA_session *");
+    if (!p)
+        return GA_ERROR;
+
+    PyObject* context = Py_BuildValue("(OO)", obj, arg);
+    if (!context)
+        return GA_ERROR;
+
+    if (GA_set_batch_notification_handler(p, batch_notification_handler, context) != GA_OK) {
+        Py_DecRef(context);
+        return GA_ERROR;
+    }
+    return GA_OK;
+}
+
 #define capsule_dtor(name, fn) static void destroy_##name(PyObject *obj) { \
     struct name *p = obj == Py_None ? NULL : (struct name *)PyCapsule_GetPointer(obj, "struct " #name " *"); \
     if (p) fn(p); }
@@ -275,3 +326,4 @@ typedef unsigned int uint32_t;
 %include "../include/gdk.h"
 
 int _python_set_callback_handler(PyObject* obj, PyObject* arg);
+int _python_set_batch_callback_handler(PyObject* obj, PyObject* arg);
@@ -17,6 +17,11 @@ bool isupper(const std::string& s)
     return std::all_of(std::begin(s), std::end(s), [](int c) { return std::islower(c) == 0; });
 }
 
+size_t varint_length(size_t n) { return n < 0xfd ? 1 : n <= 0xffff ? 3 : n <= 0xffffffff ? 5 : 9; }
+
+// The length of a length-prefixed buffer
+size_t varbuff_length(size_t n) { return varint_length(n) + n; }
+
 using namespace ga::sdk;
 
 std::vector<unsigned char> output_script_for_address(
@@ -83,6 +88,27 @@ std::vector<unsigned char> output_script_for_address(
 
     return script;
 }
+
+// Convert uppercase b(l)ech32 alphanumeric strings to lowercase, returning true if converted.
+// Only convert all uppercase strings, BIP-173 specifically disallows mixed case strings
+bool lowercase_bech32_address(const network_parameters& net_params, std::string& address)
+{
+    const std::string bech32_prefix = net_params.bech32_prefix() + "1";
+    if ((boost::istarts_with(address, bech32_prefix)
+            || (net_params.is_liquid() && boost::istarts_with(address, net_params.blech32_prefix() + "1")))
+        && isupper(address)) {
+        boost::to_lower(address);
+        return true;
+    }
+    return false;
+}
+
+// Payout scripts must be of a type that a wallet can give as an address
+bool is_payout_script_type(size_t script_type)
+{
+    return script_type == WALLY_SCRIPT_TYPE_P2PKH || script_type == WALLY_SCRIPT_TYPE_P2SH
+        || script_type == WALLY_SCRIPT_TYPE_P2WPKH || script_type == WALLY_SCRIPT_TYPE_P2WSH;
+}
 } // namespace
 
 namespace ga {
@@ -148,7 +174,65 @@ namespace sdk {
         __builtin_unreachable();
     }
 
-    static std::vector<unsigned char> output_script(const network_parameters& net_params, const pub_key_t& ga_pub_key,
+    void verify_address(const network_parameters& net_params, nlohmann::json& address,
+        const std::vector<unsigned char>* user_script, bool is_historic, uint32_t csv_blocks,
+        const std::vector<uint32_t>& csv_buckets)
+    {
+        const std::string addr_type = address["address_type"];
+        const script_type addr_script_type = address["script_type"];
+
+        std::vector<unsigned char> server_script;
+        if (user_script) {
+            // Compare against the locally computed script to verify the servers data
+            if (!address.contains("script")) {
+                // FIXME: get_my_addresses doesn't return script yet
+                address["script"] = b2h(*user_script);
+                server_script = *user_script;
+            } else {
+                server_script = h2b(address["script"]);
+                GDK_RUNTIME_ASSERT(server_script == *user_script);
+            }
+        } else {
+            server_script = h2b(address["script"]);
+        }
+
+        const auto server_address = get_address_from_script(net_params, server_script, addr_type);
+        if (user_script && address.contains("address")) {
+            GDK_RUNTIME_ASSERT(server_address == address["address"]);
+        }
+        address["address"] = server_address;
+
+        if (addr_type == address_type::csv) {
+            // Make sure the csv value used is in our csv buckets. If isn't,
+            // coins held in such scripts may not be recoverable.
+            uint32_t addr_csv_blocks = get_csv_blocks_from_csv_redeem_script(server_script);
+            if (is_historic) {
+                // For historic addresses only check csvtime is in our bucket
+                // list, since the user may have changed their settings.
+                GDK_RUNTIME_ASSERT(
+                    std::find(csv_buckets.begin(), csv_buckets.end(), addr_csv_blocks) != csv_buckets.end());
+            } else {
+                // For new addresses, ensure that the csvtime is the users
+                // current csv_blocks setting. This also ensures it is
+                // one of the bucket values as a side effect.
+                GDK_RUNTIME_ASSERT(addr_csv_blocks == csv_blocks);
+            }
+        }
+
+        if (net_params.is_liquid()) {
+            // we treat the script as a segwit wrapped script, which is the only supported type on Liquid at
+            // the moment
+            GDK_RUNTIME_ASSERT(addr_script_type == script_type::ga_p2sh_p2wsh_csv_fortified_out
+                || addr_script_type == script_type::ga_p2sh_p2wsh_fortified_out);
+
+            const auto witness_program = witness_program_from_bytes(server_script, WALLY_SCRIPT_SHA256);
+            const auto p2sh = scriptpubkey_p2sh_from_hash160(hash160(witness_program));
+            address["blinding_script"] = b2h(p2sh);
+            // The blinding key will be added later once fetched from the sessions signer
+        }
+    }
+
+    std::vector<unsigned char> output_script(const network_parameters& net_params, const pub_key_t& ga_pub_key,
         const pub_key_t& user_pub_key, byte_span_t backup_pub_key, script_type type, uint32_t subtype)
     {
         const bool is_2of3 = !backup_pub_key.empty();
@@ -178,22 +262,27 @@ namespace sdk {
         return script;
     }
 
+    uint32_t csv_subtype_from_utxo(const network_parameters& net_params, const nlohmann::json& utxo)
+    {
+        const script_type type = utxo.at("script_type");
+        if (type != script_type::ga_p2sh_p2wsh_csv_fortified_out) {
+            return 0;
+        }
+        // subtype indicates the number of csv blocks and must be one of the known bucket values
+        const uint32_t subtype = utxo.at("subtype");
+        const auto& csv_buckets = net_params.csv_buckets();
+        const auto csv_bucket_p = std::find(std::begin(csv_buckets), std::end(csv_buckets), subtype);
+        GDK_RUNTIME_ASSERT_MSG(csv_bucket_p != csv_buckets.end(), "Unknown csv bucket");
+        return subtype;
+    }
+
     std::vector<unsigned char> output_script_from_utxo(const network_parameters& net_params, ga_pubkeys& pubkeys,
         user_pubkeys& usr_pubkeys, user_pubkeys& recovery_pubkeys, const nlohmann::json& utxo)
     {
         const uint32_t subaccount = json_get_value(utxo, "subaccount", 0u);
         const uint32_t pointer = utxo.at("pointer");
-        script_type type;
-
-        type = utxo.at("script_type");
-        uint32_t subtype = 0;
-        if (type == script_type::ga_p2sh_p2wsh_csv_fortified_out) {
-            // subtype indicates the number of csv blocks and must be one of the known bucket values
-            subtype = utxo.at("subtype");
-            const auto csv_buckets = net_params.csv_buckets();
-            const auto csv_bucket_p = std::find(std::begin(csv_buckets), std::end(csv_buckets), subtype);
-            GDK_RUNTIME_ASSERT_MSG(csv_bucket_p != csv_buckets.end(), "Unknown csv bucket");
-        }
+        const script_type type = utxo.at("script_type");
+        const uint32_t subtype = csv_subtype_from_utxo(net_params, utxo);
 
         const auto ga_pub_key = pubkeys.derive(subaccount, pointer);
         const auto user_pub_key = usr_pubkeys.derive(subaccount, pointer);
@@ -271,10 +360,14 @@ namespace sdk {
     }
 
     amount get_tx_fee(const wally_tx_ptr& tx, amount min_fee_rate, amount fee_rate)
+    {
+        return get_tx_fee(tx_get_vsize(tx), min_fee_rate, fee_rate);
+    }
+
+    amount get_tx_fee(size_t vsize, amount min_fee_rate, amount fee_rate)
     {
         const amount rate = fee_rate < min_fee_rate ? min_fee_rate : fee_rate;
 
-        const size_t vsize = tx_get_vsize(tx);
         const auto fee = static_cast<double>(vsize) * rate.value() / 1000.0;
         const auto rounded_fee = static_cast<amount::value_type>(std::ceil(fee));
         return amount(rounded_fee);
@@ -301,7 +394,12 @@ namespace sdk {
         const std::string& address, amount::value_type satoshi, const std::string& asset_id)
     {
         std::vector<unsigned char> script = output_script_for_address(net_params, address, result);
+        return add_tx_output(net_params, tx, script, satoshi, asset_id);
+    }
 
+    amount add_tx_output(const network_parameters& net_params, wally_tx_ptr& tx, byte_span_t script,
+        amount::value_type satoshi, const std::string& asset_id)
+    {
         if (net_params.is_liquid()) {
             const auto ct_value = tx_confidential_value_from_satoshi(satoshi);
             const auto asset_bytes = h2b_rev(asset_id, 0x1);
@@ -328,7 +426,7 @@ namespace sdk {
         tx_elements_output_commitment_set(tx, index, asset_bytes, ct_value, {}, {}, {});
     }
 
-    // TODO: Merge this validation with add_tx_addressee to avoid re-parsing?
+    // TODO: Merge this validation with parse_tx_addressee to avoid re-parsing?
     std::string validate_tx_addressee(
         const network_parameters& net_params, nlohmann::json& result, nlohmann::json& addressee)
     {
@@ -359,8 +457,8 @@ namespace sdk {
         return asset_id_from_json(net_params, addressee);
     }
 
-    amount add_tx_addressee(ga_session& session, const network_parameters& net_params, nlohmann::json& result,
-        wally_tx_ptr& tx, nlohmann::json& addressee)
+    tx_payout parse_tx_addressee(const network_parameters& net_params, amount dust_threshold,
+        const amount_converter_t& convert_amount, nlohmann::json& result, nlohmann::json& addressee)
     {
         std::string address = addressee.at("address"); // Assume its a standard address
 
@@ -380,25 +478,19 @@ namespace sdk {
             if (uri_amount_p != bip21_params.end()) {
                 // Use the amount specified in the URI
                 const nlohmann::json uri_amount = { { "btc", uri_amount_p->get<std::string>() } };
-                addressee["satoshi"] = session.convert_amount(uri_amount)["satoshi"];
+                addressee["satoshi"] = convert_amount(uri_amount)["satoshi"];
                 amount::strip_non_satoshi_keys(addressee);
             }
         }
 
-        // Convert uppercase b(l)ech32 alphanumeric strings to lowercase
-        // Only convert all uppercase strings, BIP-173 specifically disallows mixed case strings
-        const std::string bech32_prefix = net_params.bech32_prefix() + "1";
-        if ((boost::istarts_with(address, bech32_prefix)
-                || (net_params.is_liquid() && boost::istarts_with(address, net_params.blech32_prefix() + "1")))
-            && isupper(address)) {
-            boost::to_lower(address);
+        if (lowercase_bech32_address(net_params, address)) {
             addressee["address"] = address;
         }
 
         // Convert the users entered value into satoshi
         amount satoshi;
         try {
-            satoshi = session.convert_amount(addressee)["satoshi"].get<amount::value_type>();
+            satoshi = convert_amount(addressee)["satoshi"].get<amount::value_type>();
         } catch (const user_error& ex) {
             // Note the error, and create a 0 satoshi output
             set_tx_error(result, ex.what());
@@ -409,23 +501,137 @@ namespace sdk {
 
         // Transactions with outputs below the dust threshold (except OP_RETURN)
         // are not relayed by network nodes
-        if (!result.value("send_all", false) && satoshi.value() < session.get_dust_threshold()) {
+        if (!result.value("send_all", false) && satoshi < dust_threshold) {
             set_tx_error(result, res::id_invalid_amount);
         }
 
         amount::strip_non_satoshi_keys(addressee);
         addressee["satoshi"] = satoshi.value(); // Sets to 0 if not present
 
-        return add_tx_output(
-            net_params, result, tx, address, satoshi.value(), asset_id_from_json(net_params, addressee));
+        tx_payout payout;
+        payout.script = output_script_for_address(net_params, address, result);
+        payout.address = std::move(address);
+        payout.satoshi = satoshi.value();
+        payout.asset_id = asset_id_from_json(net_params, addressee);
+        return payout;
     }
 
-    void update_tx_size_info(const network_parameters& net_params, const wally_tx_ptr& tx, nlohmann::json& result)
+    std::vector<tx_payout> parse_tx_payouts(
+        const network_parameters& net_params, amount dust_threshold, nlohmann::json& result)
+    {
+        const bool is_liquid = net_params.is_liquid();
+        const bool send_all = result.value("send_all", false);
+        const auto& entries = result.at("payouts");
+        GDK_RUNTIME_ASSERT(entries.is_array());
+
+        std::vector<tx_payout> payouts;
+        payouts.reserve(entries.size());
+        std::vector<nlohmann::json> addressees;
+        addressees.reserve(entries.size());
+        std::string last_asset_id; // Payouts usually share an asset id, only validate it when it changes
+
+        for (const auto& entry : entries) {
+            tx_payout payout;
+
+            if (!is_liquid || last_asset_id.empty() || json_get_value(entry, "asset_id") != last_asset_id) {
+                last_asset_id = asset_id_from_json(net_params, entry);
+            }
+            payout.asset_id = last_asset_id;
+
+            const auto satoshi_p = entry.find("satoshi");
+            if (satoshi_p == entry.end() || !satoshi_p->is_number_integer() || satoshi_p->get<int64_t>() < 0) {
+                set_tx_error(result, res::id_invalid_amount);
+            } else {
+                payout.satoshi = satoshi_p->get<amount::value_type>();
+                // Transactions with outputs below the dust threshold are not relayed by network nodes
+                if (!send_all && payout.satoshi < dust_threshold.value()) {
+                    set_tx_error(result, res::id_invalid_amount);
+                }
+            }
+
+            const auto address_p = entry.find("address");
+            const auto script_p = entry.find("script");
+            if (address_p != entry.end() && script_p == entry.end()) {
+                payout.address = address_p->get<std::string>();
+                lowercase_bech32_address(net_params, payout.address);
+                payout.script = output_script_for_address(net_params, payout.address, result);
+            } else if (script_p != entry.end() && address_p == entry.end() && !is_liquid) {
+                try {
+                    payout.script = h2b(script_p->get<std::string>());
+                } catch (const std::exception&) {
+                    payout.script.clear();
+                }
+                if (!is_payout_script_type(scriptpubkey_get_type(payout.script))) {
+                    payout.script.clear();
+                }
+            }
+            if (payout.script.empty()) {
+                // Liquid outputs must be given a confidential address to blind them to
+                const bool is_unblindable = is_liquid && script_p != entry.end();
+                set_tx_error(result, is_unblindable ? res::id_nonconfidential_addresses_not : res::id_invalid_address);
+                // As for addressees, use a dummy script to get a reasonable estimate of the tx size/fee
+                payout.script.assign(HASH160_LEN, 0);
+            }
+
+            nlohmann::json addressee = { { "address", payout.address }, { "satoshi", payout.satoshi } };
+            if (is_liquid) {
+                addressee["asset_id"] = payout.asset_id;
+            } else if (payout.address.empty()) {
+                addressee["script"] = b2h(payout.script);
+            }
+            addressees.emplace_back(std::move(addressee));
+            payouts.emplace_back(std::move(payout));
+        }
+
+        result["addressees"] = addressees;
+        return payouts;
+    }
+
+    void tx_size_tracker::update(const wally_tx_ptr& tx)
+    {
+        if (tx_is_elements(tx)) {
+            m_length = tx_get_length(tx, WALLY_TX_FLAG_USE_WITNESS);
+            m_weight = tx_get_weight(tx);
+            return;
+        }
+
+        if (tx->num_inputs < m_num_inputs || tx->num_outputs < m_num_outputs) {
+            *this = tx_size_tracker(); // Inputs or outputs were removed, start again
+        }
+        for (; m_num_inputs < tx->num_inputs; ++m_num_inputs) {
+            const auto& input = tx->inputs[m_num_inputs];
+            m_inputs_base += WALLY_TXHASH_LEN + sizeof(input.index) + sizeof(input.sequence);
+            m_inputs_base += varbuff_length(input.script_len);
+            if (input.witness != nullptr && input.witness->num_items != 0) {
+                m_witness_items += input.witness->num_items;
+                m_inputs_witness += varint_length(input.witness->num_items);
+                for (size_t i = 0; i < input.witness->num_items; ++i) {
+                    m_inputs_witness += varbuff_length(input.witness->items[i].witness_len);
+                }
+            } else {
+                m_inputs_witness += varint_length(0); // Empty witness
+            }
+        }
+        for (; m_num_outputs < tx->num_outputs; ++m_num_outputs) {
+            const auto& output = tx->outputs[m_num_outputs];
+            m_outputs_base += sizeof(output.satoshi) + varbuff_length(output.script_len);
+        }
+
+        const size_t base = sizeof(tx->version) + varint_length(tx->num_inputs) + m_inputs_base
+            + varint_length(tx->num_outputs) + m_outputs_base + sizeof(tx->locktime);
+        // The witnesses are only serialized if any input has one, after the segwit marker and flag
+        const size_t witness = m_witness_items != 0 ? 2 + m_inputs_witness : 0;
+        m_length = base + witness;
+        m_weight = base * 4 + witness;
+    }
+
+    size_t tx_size_tracker::vsize() const { return tx_vsize_from_weight(m_weight); }
+
+    static void update_tx_size_info(const network_parameters& net_params, const wally_tx_ptr& tx,
+        nlohmann::json& result, size_t length, size_t weight)
     {
         const bool valid = tx->num_inputs != 0u && tx->num_outputs != 0u;
-        result["transaction"] = valid ? b2h(tx_to_bytes(tx)) : std::string();
-        const auto weight = tx_get_weight(tx);
-        result["transaction_size"] = valid ? tx_get_length(tx, WALLY_TX_FLAG_USE_WITNESS) : 0;
+        result["transaction_size"] = valid ? length : 0;
         result["transaction_weight"] = valid ? weight : 0;
         const uint32_t tx_vsize = valid ? tx_vsize_from_weight(weight) : 0;
         result["transaction_vsize"] = tx_vsize;
@@ -442,6 +648,21 @@ namespace sdk {
         }
     }
 
+    void update_tx_size_info(const network_parameters& net_params, const wally_tx_ptr& tx, nlohmann::json& result)
+    {
+        const bool valid = tx->num_inputs != 0u && tx->num_outputs != 0u;
+        result["transaction"] = valid ? b2h(tx_to_bytes(tx)) : std::string();
+        const size_t length = tx_get_length(tx, WALLY_TX_FLAG_USE_WITNESS);
+        update_tx_size_info(net_params, tx, result, length, tx_get_weight(tx));
+    }
+
+    void update_tx_size_info(
+        const network_parameters& net_params, const wally_tx_ptr& tx, tx_size_tracker& tracker, nlohmann::json& result)
+    {
+        tracker.update(tx);
+        update_tx_size_info(net_params, tx, result, tracker.length(), tracker.weight());
+    }
+
     vbf_t generate_final_vbf(byte_span_t input_abfs, byte_span_t input_vbfs, uint64_span_t input_values,
         const std::vector<abf_t>& output_abfs, const std::vector<vbf_t>& output_vbfs, uint32_t num_inputs)
     {
@@ -459,10 +680,9 @@ namespace sdk {
         return asset_final_vbf(input_values, num_inputs, abfs, vbfs);
     }
 
-    void update_tx_info(const network_parameters& net_params, const wally_tx_ptr& tx, nlohmann::json& result)
+    static void update_tx_outputs_info(
+        const network_parameters& net_params, const wally_tx_ptr& tx, nlohmann::json& result)
     {
-        update_tx_size_info(net_params, tx, result);
-
         const bool is_liquid = net_params.is_liquid();
         const bool valid = tx->num_inputs != 0u && tx->num_outputs != 0U;
 
@@ -541,6 +761,19 @@ namespace sdk {
         result["transaction_outputs"] = outputs;
     }
 
+    void update_tx_info(const network_parameters& net_params, const wally_tx_ptr& tx, nlohmann::json& result)
+    {
+        update_tx_size_info(net_params, tx, result);
+        update_tx_outputs_info(net_params, tx, result);
+    }
+
+    void update_tx_info(
+        const network_parameters& net_params, const wally_tx_ptr& tx, tx_size_tracker& tracker, nlohmann::json& result)
+    {
+        update_tx_size_info(net_params, tx, tracker, result);
+        update_tx_outputs_info(net_params, tx, result);
+    }
+
     void set_anti_snipe_locktime(const wally_tx_ptr& tx, uint32_t current_block_height)
     {
         // We use cores algorithm to randomly use an older locktime for delayed tx privacy
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <array>
+#include <functional>
 #include <memory>
 #include <utility>
 
@@ -12,7 +13,6 @@
 namespace ga {
 namespace sdk {
     class ga_pubkeys;
-    class ga_session;
     class user_pubkeys;
 
     enum class script_type : int {
@@ -45,6 +45,22 @@ namespace sdk {
     std::string get_address_from_script(
         const network_parameters& net_params, byte_span_t script, const std::string& addr_type);
 
+    // Verify an address returned by the server and set its "address" from its
+    // script, and for Liquid its "blinding_script". user_script is the locally
+    // derived script to verify against, or null for watch only sessions. csv
+    // addresses must use csv_blocks if new, or one of csv_buckets if historic.
+    void verify_address(const network_parameters& net_params, nlohmann::json& address,
+        const std::vector<unsigned char>* user_script, bool is_historic, uint32_t csv_blocks,
+        const std::vector<uint32_t>& csv_buckets);
+
+    // Make a 2of2, 2of2 CSV or (if backup_pub_key is non-empty) 2of3 multisig script
+    std::vector<unsigned char> output_script(const network_parameters& net_params, const pub_key_t& ga_pub_key,
+        const pub_key_t& user_pub_key, byte_span_t backup_pub_key, script_type type, uint32_t subtype);
+
+    // Returns the number of csv blocks for a csv UTXO, validated against the
+    // networks csv buckets, or 0 for other script types
+    uint32_t csv_subtype_from_utxo(const network_parameters& net_params, const nlohmann::json& utxo);
+
     std::vector<unsigned char> output_script_from_utxo(const network_parameters& net_params, ga_pubkeys& pubkeys,
         user_pubkeys& usr_pubkeys, user_pubkeys& recovery_pubkeys, const nlohmann::json& utxo);
 
@@ -69,6 +85,33 @@ namespace sdk {
     // Compute the fee for a tx
     amount get_tx_fee(const wally_tx_ptr& tx, amount min_fee_rate, amount fee_rate);
 
+    // Compute the fee for a tx of the given vsize
+    amount get_tx_fee(size_t vsize, amount min_fee_rate, amount fee_rate);
+
+    // Tracks the serialized length and weight of a tx as it is built, measuring
+    // only the inputs and outputs added since the last update rather than the
+    // whole tx. Inputs and outputs may be reordered once added but must not
+    // otherwise change size, which holds for BTC txs under construction.
+    // Elements txs, whose outputs change size when blinded, are measured in full.
+    class tx_size_tracker {
+    public:
+        void update(const wally_tx_ptr& tx);
+
+        size_t length() const { return m_length; }
+        size_t weight() const { return m_weight; }
+        size_t vsize() const;
+
+    private:
+        size_t m_num_inputs = 0;
+        size_t m_num_outputs = 0;
+        size_t m_inputs_base = 0; // Non-witness bytes of the inputs
+        size_t m_inputs_witness = 0; // Witness bytes of the inputs
+        size_t m_witness_items = 0;
+        size_t m_outputs_base = 0;
+        size_t m_length = 0;
+        size_t m_weight = 0;
+    };
+
     // Get scriptpubkey from address (address is expected to be valid)
     std::vector<unsigned char> scriptpubkey_from_address(
         const network_parameters& net_params, const std::string& address);
@@ -80,6 +123,10 @@ namespace sdk {
     amount add_tx_output(const network_parameters& net_params, nlohmann::json& result, wally_tx_ptr& tx,
         const std::string& address, amount::value_type satoshi = 0, const std::string& asset_id = {});
 
+    // Add an output to a tx given its script
+    amount add_tx_output(const network_parameters& net_params, wally_tx_ptr& tx, byte_span_t script,
+        amount::value_type satoshi, const std::string& asset_id);
+
     // Add a fee output to a tx, returns the index in tx->outputs
     size_t add_tx_fee_output(const network_parameters& net_params, wally_tx_ptr& tx, amount::value_type satoshi);
 
@@ -89,9 +136,27 @@ namespace sdk {
     std::string validate_tx_addressee(
         const network_parameters& net_params, nlohmann::json& result, nlohmann::json& addressee);
 
-    // Add an output from a JSON addressee
-    amount add_tx_addressee(ga_session& session, const network_parameters& net_params, nlohmann::json& result,
-        wally_tx_ptr& tx, nlohmann::json& addressee);
+    // A recipient of a tx, parsed and validated from an addressee or payout
+    struct tx_payout {
+        std::string address; // Empty for payouts given as a script
+        std::vector<unsigned char> script;
+        amount::value_type satoshi = 0;
+        std::string asset_id; // As returned by asset_id_from_json
+    };
+
+    // Converts a JSON amount given in any unit, returning it in all units
+    using amount_converter_t = std::function<nlohmann::json(const nlohmann::json&)>;
+
+    // Parse the output for a JSON addressee, converting its amount to satoshi
+    tx_payout parse_tx_addressee(const network_parameters& net_params, amount dust_threshold,
+        const amount_converter_t& convert_amount, nlohmann::json& result, nlohmann::json& addressee);
+
+    // Parse and validate result["payouts"], a compact list of recipients given as
+    // {"address" or, for BTC only, "script", "satoshi", "asset_id" (Liquid only)},
+    // and set result["addressees"] from them. Unlike addressees, payouts take no
+    // BIP21 URIs or non-satoshi amounts. Errors are set in result as for addressees.
+    std::vector<tx_payout> parse_tx_payouts(
+        const network_parameters& net_params, amount dust_threshold, nlohmann::json& result);
 
     vbf_t generate_final_vbf(byte_span_t input_abfs, byte_span_t input_vbfs, uint64_span_t input_values,
         const std::vector<abf_t>& output_abfs, const std::vector<vbf_t>& output_vbfs, uint32_t num_inputs);
@@ -99,9 +164,19 @@ namespace sdk {
     // Update the json tx size/fee rate information from tx
     void update_tx_size_info(const network_parameters& net_params, const wally_tx_ptr& tx, nlohmann::json& result);
 
+    // Update the json tx size/fee rate information from tx, without serializing
+    // it into result["transaction"]. For use while building a tx; the caller
+    // must call the overload above once the tx is complete.
+    void update_tx_size_info(
+        const network_parameters& net_params, const wally_tx_ptr& tx, tx_size_tracker& tracker, nlohmann::json& result);
+
     // Update the json tx representation with info from tx
     void update_tx_info(const network_parameters& net_params, const wally_tx_ptr& tx, nlohmann::json& result);
 
+    // As above, without serializing tx into result["transaction"]
+    void update_tx_info(
+        const network_parameters& net_params, const wally_tx_ptr& tx, tx_size_tracker& tracker, nlohmann::json& result);
+
     // Set the locktime on tx to avoid fee sniping
     void set_anti_snipe_locktime(const wally_tx_ptr& tx, uint32_t current_block_height);
 } // namespace sdk
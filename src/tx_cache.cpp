@@ -0,0 +1,55 @@
+#include "tx_cache.hpp"
+#include "assertion.hpp"
+
+namespace ga {
+namespace sdk {
+
+    raw_tx_cache::raw_tx_cache(std::size_t max_bytes)
+        : m_max_bytes(max_bytes)
+        , m_bytes(0)
+    {
+        GDK_RUNTIME_ASSERT(m_max_bytes != 0);
+    }
+
+    const std::string* raw_tx_cache::find(const std::string& txhash)
+    {
+        const auto p = m_index.find(txhash);
+        if (p == m_index.end()) {
+            return nullptr;
+        }
+        // Mark as most recently used
+        m_entries.splice(m_entries.begin(), m_entries, p->second);
+        return &p->second->second;
+    }
+
+    void raw_tx_cache::insert(const std::string& txhash, const std::string& tx_hex)
+    {
+        if (tx_hex.size() > m_max_bytes) {
+            return;
+        }
+        const auto p = m_index.find(txhash);
+        if (p != m_index.end()) {
+            // Already cached; the tx is unchanged, so only mark it as used
+            m_entries.splice(m_entries.begin(), m_entries, p->second);
+            return;
+        }
+        while (m_bytes + tx_hex.size() > m_max_bytes) {
+            const auto& lru = m_entries.back();
+            m_bytes -= lru.second.size();
+            m_index.erase(lru.first);
+            m_entries.pop_back();
+        }
+        m_entries.emplace_front(txhash, tx_hex);
+        m_index.emplace(txhash, m_entries.begin());
+        m_bytes += tx_hex.size();
+    }
+
+    void raw_tx_cache::clear()
+    {
+        m_index.clear();
+        m_entries.clear();
+        m_bytes = 0;
+    }
+
+} // namespace sdk
+} // namespace ga
@@ -0,0 +1,48 @@
+#ifndef GDK_TX_CACHE_HPP
+#define GDK_TX_CACHE_HPP
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace ga {
+namespace sdk {
+
+    // Caches raw transactions in hex, keyed by txhash, evicting the least
+    // recently used once their total size exceeds max_bytes.
+    // A txhash always refers to the same transaction, so entries never need
+    // invalidating.
+    // Not thread safe; callers must serialize access.
+    class raw_tx_cache {
+    public:
+        explicit raw_tx_cache(std::size_t max_bytes = 16 * 1024 * 1024);
+
+        // Return the cached tx hex, or nullptr if not present. The returned
+        // pointer is invalidated by any subsequent insert or clear.
+        const std::string* find(const std::string& txhash);
+
+        // Cache a tx, ignoring any that is larger than max_bytes by itself
+        void insert(const std::string& txhash, const std::string& tx_hex);
+
+        void clear();
+
+        std::size_t size() const { return m_entries.size(); }
+        std::size_t bytes() const { return m_bytes; }
+
+    private:
+        using entry_t = std::pair<std::string, std::string>; // txhash, tx hex
+        using entries_t = std::list<entry_t>; // Most recently used first
+
+        const std::size_t m_max_bytes;
+        entries_t m_entries;
+        std::unordered_map<std::string, entries_t::iterator> m_index;
+        std::size_t m_bytes;
+    };
+
+} // namespace sdk
+} // namespace ga
+
+#endif
@@ -36,7 +36,8 @@ namespace sdk {
      * - For 3), we must assume when logging in that we may have missed a re-org, and
      *   so remove N blocks from the results where N is the largest expected re-org.
      *   However when reconnecting, if we have not missed a block notification this
-     *   can be avoided (TODO).
+     *   is avoided, and only mempool txs are removed. In either case we may have
+     *   missed tx notifications, so the front of the cache must be refreshed.
      * - The timestamp of the transaction is the server sort key, but this timestamp
      *   is set when the signed tx is entered into the servers database.
      * - As such, a mempool tx may appear later in the list returned from the server
@@ -309,6 +310,16 @@ namespace sdk {
         m_is_front_dirty = true;
     }
 
+    void tx_list_cache::on_reconnect(uint32_t block_height)
+    {
+        remove_forked_txs(block_height);
+        if (m_tx_cache.empty()) {
+            m_oldest_txhash.clear();
+        }
+        // We may have missed notifications for new txs while disconnected
+        m_is_front_dirty = true;
+    }
+
     void tx_list_cache::remove_mempool_txs()
     {
         GDK_LOG_SEV(cache_log_level) << "remove_mempool_txs";
@@ -369,5 +380,13 @@ namespace sdk {
         get(subaccount)->on_new_transaction(details);
     }
 
+    void tx_list_caches::on_reconnect(uint32_t block_height)
+    {
+        GDK_LOG_SEV(cache_log_level) << "on_reconnect:" << block_height;
+        for (auto& cache : m_caches) {
+            cache.second->on_reconnect(block_height);
+        }
+    }
+
 } // namespace sdk
 } // namespace ga
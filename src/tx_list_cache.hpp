@@ -25,6 +25,9 @@ namespace sdk {
 
         void on_new_block(uint32_t ga_block_height, const nlohmann::json& details);
         void on_new_transaction(const nlohmann::json& details);
+        // Called on re-login: remove mempool txs and any txs confirmed at or
+        // after 'block_height', which may have changed while disconnected
+        void on_reconnect(uint32_t block_height);
 
     private:
         void remove_mempool_txs();
@@ -43,6 +46,7 @@ namespace sdk {
 
         void on_new_block(uint32_t ga_block_height, const nlohmann::json& details);
         void on_new_transaction(uint32_t subaccount, const nlohmann::json& details);
+        void on_reconnect(uint32_t block_height);
 
     private:
         std::map<uint32_t, std::shared_ptr<tx_list_cache>> m_caches;
@@ -2,6 +2,7 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <functional>
@@ -34,6 +35,8 @@
 #include "bcrypt.h"
 #endif
 
+#define OPENSSL_VERIFY(x) GDK_RUNTIME_ASSERT((x) == 1)
+
 namespace ga {
 namespace sdk {
 
@@ -166,6 +169,109 @@ namespace sdk {
         wally_bzero(hashed.data(), hashed.size());
     }
 
+    namespace {
+        // Per-thread ChaCha20 keystream generator. The key is replaced from
+        // the keystream on every refill so previous outputs cannot be
+        // recovered from the generator state, and the generator is reseeded
+        // from get_random_bytes after a fixed amount of output or time, or
+        // in a forked child so it doesn't repeat its parent's output.
+        class fast_rng final {
+        public:
+            fast_rng()
+                : m_ctx(EVP_CIPHER_CTX_new(), EVP_CIPHER_CTX_free)
+                , m_block()
+                , m_pos(m_block.size())
+                , m_generated(0)
+                , m_reseed_time()
+                , m_pid(0)
+            {
+                GDK_RUNTIME_ASSERT(m_ctx != nullptr);
+                reseed();
+            }
+
+            fast_rng(const fast_rng&) = delete;
+            fast_rng& operator=(const fast_rng&) = delete;
+            fast_rng(fast_rng&&) = delete;
+            fast_rng& operator=(fast_rng&&) = delete;
+
+            ~fast_rng() { wally_bzero(m_block.data(), m_block.size()); }
+
+            void generate(unsigned char* output_bytes, size_t num_bytes)
+            {
+                m_generated += num_bytes;
+                if (m_generated > RESEED_BYTES || std::chrono::steady_clock::now() >= m_reseed_time
+                    || getpid() != m_pid) {
+                    reseed();
+                    m_generated = num_bytes;
+                }
+                while (num_bytes != 0) {
+                    if (m_pos == m_block.size()) {
+                        refill();
+                    }
+                    const size_t n = std::min(num_bytes, m_block.size() - m_pos);
+                    std::copy(m_block.data() + m_pos, m_block.data() + m_pos + n, output_bytes);
+                    wally_bzero(m_block.data() + m_pos, n);
+                    m_pos += n;
+                    output_bytes += n;
+                    num_bytes -= n;
+                }
+            }
+
+        private:
+            static constexpr size_t KEY_SIZE = 32;
+            static constexpr size_t RESEED_BYTES = 1024 * 1024;
+            static constexpr std::chrono::seconds RESEED_INTERVAL{ 300 };
+
+            void set_key(const unsigned char* key)
+            {
+                // Each key is only ever used once, so a zero nonce is safe
+                const std::array<unsigned char, 16> iv{ { 0 } };
+                OPENSSL_VERIFY(EVP_EncryptInit_ex(m_ctx.get(), EVP_chacha20(), NULL, key, iv.data()));
+            }
+
+            void reseed()
+            {
+                std::array<unsigned char, KEY_SIZE> key;
+                get_random_bytes(key.size(), key.data(), key.size());
+                set_key(key.data());
+                wally_bzero(key.data(), key.size());
+                wally_bzero(m_block.data(), m_block.size());
+                m_pos = m_block.size(); // Discard any output from the old key
+                m_reseed_time = std::chrono::steady_clock::now() + RESEED_INTERVAL;
+                m_pid = getpid();
+            }
+
+            void refill()
+            {
+                // Generate the keystream in place over zeros, then take the
+                // first KEY_SIZE bytes as the key for the next refill
+                std::fill(m_block.begin(), m_block.end(), 0);
+                int n;
+                OPENSSL_VERIFY(EVP_EncryptUpdate(m_ctx.get(), m_block.data(), &n, m_block.data(), m_block.size()));
+                GDK_RUNTIME_ASSERT(static_cast<size_t>(n) == m_block.size());
+                set_key(m_block.data());
+                wally_bzero(m_block.data(), KEY_SIZE);
+                m_pos = KEY_SIZE;
+            }
+
+            std::unique_ptr<EVP_CIPHER_CTX, decltype(&::EVP_CIPHER_CTX_free)> m_ctx;
+            std::array<unsigned char, KEY_SIZE + 512> m_block;
+            size_t m_pos;
+            size_t m_generated;
+            std::chrono::steady_clock::time_point m_reseed_time;
+            pid_t m_pid;
+        };
+
+        constexpr std::chrono::seconds fast_rng::RESEED_INTERVAL;
+    } // namespace
+
+    void get_fast_random_bytes(std::size_t num_bytes, void* output_bytes, std::size_t siz)
+    {
+        GDK_RUNTIME_ASSERT(num_bytes <= siz);
+        static thread_local fast_rng rng;
+        rng.generate(static_cast<unsigned char*>(output_bytes), num_bytes);
+    }
+
     int32_t spv_verify_tx(const nlohmann::json& details)
     {
 #ifdef BUILD_GDK_RUST
@@ -195,7 +301,7 @@ namespace sdk {
         if (++m_index == m_entropy.size()) {
             m_index = 0;
             const size_t num_bytes = m_entropy.size() * sizeof(result_type);
-            get_random_bytes(num_bytes, m_entropy.data(), num_bytes);
+            get_fast_random_bytes(num_bytes, m_entropy.data(), num_bytes);
         }
         return m_entropy[m_index];
     }
@@ -332,7 +438,7 @@ namespace sdk {
     std::string aes_cbc_encrypt(
         const std::array<unsigned char, PBKDF2_HMAC_SHA256_LEN>& key, const std::string& plaintext)
     {
-        const auto iv = get_random_bytes<AES_BLOCK_LEN>();
+        const auto iv = get_fast_random_bytes<AES_BLOCK_LEN>();
         const size_t plaintext_padded_size = (plaintext.size() / AES_BLOCK_LEN + 1) * AES_BLOCK_LEN;
         std::vector<unsigned char> encrypted(AES_BLOCK_LEN + plaintext_padded_size);
         aes_cbc(key, iv, ustring_span(plaintext), AES_FLAG_ENCRYPT, encrypted);
@@ -475,8 +581,6 @@ namespace sdk {
         return result;
     }
 
-#define OPENSSL_VERIFY(x) GDK_RUNTIME_ASSERT((x) == 1)
-
     namespace {
         constexpr int AES_GCM_TAG_SIZE = 16;
         constexpr int AES_GCM_IV_SIZE = 12;
@@ -495,7 +599,7 @@ namespace sdk {
         GDK_RUNTIME_ASSERT(static_cast<size_t>(cyphertext.size()) == aes_gcm_encrypt_get_length(plaintext));
 
         std::array<unsigned char, AES_GCM_IV_SIZE> iv;
-        get_random_bytes(iv.size(), iv.data(), iv.size());
+        get_fast_random_bytes(iv.size(), iv.data(), iv.size());
         std::copy(iv.begin(), iv.end(), cyphertext.begin());
         unsigned char* out = cyphertext.data() + iv.size();
 
@@ -23,6 +23,18 @@ namespace sdk {
         return buff;
     }
 
+    // Fetch random bytes from a per-thread CSPRNG which is seeded and
+    // periodically reseeded from get_random_bytes. Use for bulk/per-object
+    // randomness such as IVs, blinding factors and anti-exfil entropy.
+    void get_fast_random_bytes(std::size_t num_bytes, void* output_bytes, std::size_t siz);
+
+    template <std::size_t N> std::array<unsigned char, N> get_fast_random_bytes()
+    {
+        std::array<unsigned char, N> buff{ { 0 } };
+        get_fast_random_bytes(N, buff.data(), buff.size());
+        return buff;
+    }
+
     // Return a uint32_t in the range 0 to (upper_bound - 1) without bias
     uint32_t get_uniform_uint32_t(uint32_t upper_bound);
 
@@ -0,0 +1,133 @@
+#include <algorithm>
+
+#include "containers.hpp"
+#include "utxo_cache.hpp"
+
+namespace ga {
+namespace sdk {
+
+    namespace {
+        static bool utxo_matches(const nlohmann::json& utxo, const utxo_ref_t& ref)
+        {
+            return utxo.at("pt_idx") == ref.second && utxo.at("txhash") == ref.first;
+        }
+
+        static bool contains_utxo(const nlohmann::json& asset_utxos, const utxo_ref_t& ref)
+        {
+            for (const auto& utxos : asset_utxos) {
+                if (std::any_of(utxos.begin(), utxos.end(), [&ref](const auto& u) { return utxo_matches(u, ref); })) {
+                    return true;
+                }
+            }
+            return false;
+        }
+    } // namespace
+
+    void sort_asset_utxos(nlohmann::json& asset_utxos)
+    {
+        // Sort the UTXOs such that the oldest are first, with the default
+        // UTXO selection strategy this reduces the number of re-deposits
+        // users have to do by recycling UTXOs that are closer to expiry.
+        // This also reduces the chance of spending unconfirmed outputs by
+        // pushing them to the end of the selection array.
+        std::for_each(std::begin(asset_utxos), std::end(asset_utxos), [](nlohmann::json& utxos) {
+            std::sort(std::begin(utxos), std::end(utxos), [](const nlohmann::json& lhs, const nlohmann::json& rhs) {
+                const uint32_t lbh = lhs["block_height"];
+                const uint32_t rbh = rhs["block_height"];
+                if (lbh == 0) {
+                    return false;
+                }
+                if (rbh == 0) {
+                    return true;
+                }
+                return lbh < rbh;
+            });
+        });
+    }
+
+    bool apply_utxo_delta(nlohmann::json& asset_utxos, uint32_t num_confs, const std::vector<utxo_ref_t>& spent,
+        const nlohmann::json& created)
+    {
+        if (asset_utxos.is_null()) {
+            asset_utxos = nlohmann::json::object();
+        }
+        if (created.contains("error")) {
+            return false; // Outputs we couldn't process
+        }
+
+        for (const auto& ref : spent) {
+            bool found = false;
+            for (auto& utxos : asset_utxos) {
+                const auto p
+                    = std::find_if(utxos.begin(), utxos.end(), [&ref](const auto& u) { return utxo_matches(u, ref); });
+                if (p != utxos.end()) {
+                    utxos.erase(p);
+                    found = true;
+                    break;
+                }
+            }
+            if (!found && num_confs == 0) {
+                // Every output we own is present when unconfirmed UTXOs are
+                // included, so this tx spends something we don't know about:
+                // e.g. it replaces or double spends a tx we saw earlier
+                return false;
+            }
+        }
+
+        for (const auto& asset : created.items()) {
+            for (const auto& utxo : asset.value()) {
+                if (utxo.value("block_height", 0u) != 0) {
+                    // Confirmations change which UTXOs are returned for
+                    // num_confs 1, and their relative order
+                    return false;
+                }
+                if (contains_utxo(asset_utxos, { utxo.at("txhash"), utxo.at("pt_idx") })) {
+                    return false; // Re-notified of a tx we already applied
+                }
+                if (num_confs == 0) {
+                    // Unconfirmed UTXOs sort last, so appending keeps the order
+                    asset_utxos[asset.key()].push_back(utxo);
+                }
+            }
+        }
+
+        // Remove any assets that have no UTXOs left
+        for (auto p = asset_utxos.begin(); p != asset_utxos.end(); /* no-op */) {
+            if (p->empty()) {
+                p = asset_utxos.erase(p);
+            } else {
+                ++p;
+            }
+        }
+        return true;
+    }
+
+    nlohmann::json utxos_from_tx_endpoints(
+        const nlohmann::json& tx, uint32_t subaccount, std::vector<utxo_ref_t>& spent)
+    {
+        const std::string& txhash = tx.at("txhash");
+        nlohmann::json created = nlohmann::json::array();
+        for (auto ep : tx.at("eps")) {
+            json_add_if_missing(ep, "subaccount", 0, true);
+            if (!json_get_value(ep, "is_relevant", false) || ep["subaccount"] != subaccount) {
+                continue;
+            }
+            if (!json_get_value(ep, "is_output", false)) {
+                spent.emplace_back(ep.at("prevtxhash"), ep.at("previdx"));
+                continue;
+            }
+            // Convert the endpoint into the UTXO format returned by the server
+            for (const auto& key : { "id", "is_credit", "is_output", "is_relevant", "ad" }) {
+                ep.erase(key);
+            }
+            json_rename_key(ep, "pubkey_pointer", "pointer");
+            json_add_if_missing(ep, "pointer", 0, true);
+            ep["txhash"] = txhash;
+            ep["block_height"] = tx.value("block_height", nlohmann::json(0));
+            created.emplace_back(std::move(ep));
+        }
+        return created;
+    }
+
+} // namespace sdk
+} // namespace ga
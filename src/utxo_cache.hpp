@@ -0,0 +1,38 @@
+#ifndef GDK_UTXO_CACHE_HPP
+#define GDK_UTXO_CACHE_HPP
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace ga {
+namespace sdk {
+    using utxo_ref_t = std::pair<std::string, uint32_t>; // txhash, pt_idx
+
+    // Sort UTXOs grouped by asset id such that the oldest are first, and
+    // unconfirmed UTXOs are last.
+    void sort_asset_utxos(nlohmann::json& asset_utxos);
+
+    // Apply the effect of a new unconfirmed transaction to UTXOs grouped by
+    // asset id: remove the outputs it spends and add the (asset grouped)
+    // outputs it creates, if they are included at num_confs.
+    // Returns false if the result can't be guaranteed to match a full refetch
+    // from the server, in which case asset_utxos is left in an unspecified
+    // state and must be discarded.
+    bool apply_utxo_delta(nlohmann::json& asset_utxos, uint32_t num_confs, const std::vector<utxo_ref_t>& spent,
+        const nlohmann::json& created);
+
+    // Convert the endpoints of a tx from the tx list into the UTXOs it creates
+    // for subaccount, in the format returned by the server, adding the
+    // outputs it spends from subaccount to spent.
+    nlohmann::json utxos_from_tx_endpoints(
+        const nlohmann::json& tx, uint32_t subaccount, std::vector<utxo_ref_t>& spent);
+
+} // namespace sdk
+} // namespace ga
+
+#endif
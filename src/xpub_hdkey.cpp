@@ -26,7 +26,7 @@ namespace sdk {
 
     xpub_hdkey::~xpub_hdkey() { wally_bzero(&m_ext_key, sizeof(m_ext_key)); }
 
-    pub_key_t xpub_hdkey::derive(uint32_t pointer)
+    pub_key_t xpub_hdkey::derive(uint32_t pointer) const
     {
         ext_key result = bip32_public_key_from_parent(m_ext_key, pointer);
         pub_key_t ret;
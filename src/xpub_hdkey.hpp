@@ -25,7 +25,7 @@ namespace sdk {
         xpub_hdkey& operator=(xpub_hdkey&&) = default;
         ~xpub_hdkey();
 
-        pub_key_t derive(uint32_t pointer);
+        pub_key_t derive(uint32_t pointer) const;
 
         xpub_t to_xpub_t() const;
         std::string to_base58() const;
@@ -33,7 +33,7 @@ use gdk_common::{ElementsNetwork, Network, NetworkId, LIQUID_TESTNET};
 
 use crate::error::Error;
 use crate::interface::ElectrumUrl;
-use crate::store::{Store, BATCH_SIZE};
+use crate::store::{RawAccountCache, Store, TxSummary, BATCH_SIZE};
 
 // The number of account types, including these reserved for future use.
 // Currently only 3 are used: P2SH-P2WPKH, P2WPKH and P2PKH
@@ -153,111 +153,70 @@ impl Account {
     }
 
     pub fn list_tx(&self, opt: &GetTransactionsOpt) -> Result<Vec<TransactionMeta>, Error> {
+        if self.store.read()?.tx_list(self.account_num).is_none() {
+            self.update_tx_list(true)?;
+        }
         let store = self.store.read()?;
         let acc_store = store.account_cache(self.account_num)?;
+        let tx_list = store
+            .tx_list(self.account_num)
+            .ok_or_else(|| Error::Generic("tx list not built".into()))?;
 
-        let tip_height = store.cache.tip.0;
+        let tip_height = store.cache().tip.0;
         let num_confs = opt.num_confs.unwrap_or(0);
 
-        let mut txs = vec![];
-        let mut my_txids: Vec<(&BETxid, &Option<u32>)> = acc_store
-            .heights
-            .iter()
-            .filter(|(_, height)| {
-                num_confs <= height.map_or(0, |height| (tip_height + 1).saturating_sub(height))
+        // txs with too few confirmations are the first ones, unconfirmed or with the highest heights
+        let start = tx_list
+            .order
+            .binary_search_by(|(_, height)| {
+                let confs = height.map_or(0, |height| (tip_height + 1).saturating_sub(height));
+                if confs < num_confs {
+                    Ordering::Less
+                } else {
+                    Ordering::Greater
+                }
             })
-            .collect();
-        my_txids.sort_by(|a, b| {
-            let height_cmp = b.1.unwrap_or(std::u32::MAX).cmp(&a.1.unwrap_or(std::u32::MAX));
-            match height_cmp {
-                Ordering::Equal => b.0.cmp(a.0),
-                h @ _ => h,
-            }
-        });
-
-        for (tx_id, height) in my_txids.iter().skip(opt.first).take(opt.count) {
-            trace!("tx_id {}", tx_id);
+            .unwrap_err();
+        let start = start.saturating_add(opt.first).min(tx_list.order.len());
+        let end = start.saturating_add(opt.count).min(tx_list.order.len());
 
+        let mut txs = vec![];
+        for (tx_id, height) in tx_list.order[start..end].iter() {
             let txe = acc_store
                 .all_txs
-                .get(*tx_id)
+                .get(tx_id)
                 .ok_or_else(fn_err(&format!("list_tx no tx {}", tx_id)))?;
-            let tx = &txe.tx;
+            let summary = tx_list
+                .summaries
+                .get(tx_id)
+                .ok_or_else(fn_err(&format!("list_tx no summary for tx {}", tx_id)))?;
 
-            let header = height.map(|h| store.cache.headers.get(&h)).flatten();
+            let header = height.map(|h| store.cache().headers.get(&h)).flatten();
             trace!("tx_id {} header {:?}", tx_id, header);
-            let mut addressees = vec![];
-            for i in 0..tx.output_len() as u32 {
-                let script = tx.output_script(i);
-                if !script.is_empty() && !acc_store.paths.contains_key(&script) {
-                    let address = tx.output_address(i, self.network.id());
-                    trace!("tx_id {}:{} not my script, address {:?}", tx_id, i, address);
-                    addressees.push(AddressAmount {
-                        address: address.unwrap_or_else(|| "".to_string()),
-                        satoshi: 0, // apparently not needed in list_tx addressees
-                        asset_id: None,
-                    });
-                }
-            }
             let memo = store.get_memo(tx_id).cloned();
 
             let create_transaction = CreateTransaction {
-                addressees,
+                addressees: summary.addressees.clone(),
                 memo,
                 ..Default::default()
             };
 
-            let fee = tx.fee(
-                &acc_store.all_txs,
-                &acc_store.unblinded,
-                &self.network.policy_asset_id().ok(),
-            )?;
-            trace!("tx_id {} fee {}", tx_id, fee);
-
-            let satoshi =
-                tx.my_balance_changes(&acc_store.all_txs, &acc_store.paths, &acc_store.unblinded);
-            trace!("tx_id {} balances {:?}", tx_id, satoshi);
-
-            // We define an incoming txs if there are more assets received by the wallet than spent
-            // when they are equal it's an outgoing tx because the special asset liquid BTC
-            // is negative due to the fee being paid
-            // TODO how do we label issuance tx?
-            let negatives = satoshi.iter().filter(|(_, v)| **v < 0).count();
-            let positives = satoshi.iter().filter(|(_, v)| **v > 0).count();
-            let (type_, user_signed) = if satoshi.is_empty() && self.network.liquid {
-                ("unblindable", false)
-            } else if tx.is_redeposit(&acc_store.paths, &acc_store.all_txs) {
-                ("redeposit", true)
-            } else if positives > negatives {
-                ("incoming", false)
-            } else {
-                ("outgoing", true)
-            };
-
             let spv_verified = if self.network.spv_enabled.unwrap_or(false) {
                 store.spv_verification_status(self.num(), tx_id)
             } else {
                 SPVVerifyResult::Disabled
             };
 
-            trace!(
-                "tx_id {} type {} user_signed {} spv_verified {:?}",
-                tx_id,
-                type_,
-                user_signed,
-                spv_verified
-            );
-
             let tx_meta = TransactionMeta::new(
                 txe.clone(),
-                **height,
+                *height,
                 header.map(|h| h.time()),
-                satoshi,
-                fee,
+                summary.satoshi.clone(),
+                summary.fee,
                 self.network.id().get_bitcoin_network().unwrap_or(bitcoin::Network::Bitcoin),
-                type_.to_string(),
+                summary.type_.to_string(),
                 create_transaction,
-                user_signed,
+                summary.user_signed,
                 spv_verified,
             );
 
@@ -268,12 +227,103 @@ impl Account {
         Ok(txs)
     }
 
+    /// Update the transaction list after the account was synced.
+    /// Summaries are computed for the transactions without one, or for all of them if `full`,
+    /// which is needed when the wallet scripts changed.
+    pub fn update_tx_list(&self, full: bool) -> Result<(), Error> {
+        let mut store = self.store.write()?;
+        let (acc_store, tx_list) = store.tx_list_mut(self.account_num)?;
+
+        if full || !tx_list.built {
+            tx_list.summaries.clear();
+        }
+        tx_list.summaries.retain(|txid, _| acc_store.heights.contains_key(txid));
+        for txid in acc_store.heights.keys() {
+            if tx_list.summaries.contains_key(txid) {
+                continue;
+            }
+            match self.tx_summary(acc_store, txid) {
+                Ok(summary) => {
+                    tx_list.summaries.insert(*txid, summary);
+                }
+                // reported by list_tx if the tx is requested
+                Err(e) => warn!("cannot summarize tx {}: {:?}", txid, e),
+            }
+        }
+
+        tx_list.order = acc_store.heights.iter().map(|(txid, height)| (*txid, *height)).collect();
+        tx_list.order.sort_by(|a, b| {
+            let height_cmp = b.1.unwrap_or(std::u32::MAX).cmp(&a.1.unwrap_or(std::u32::MAX));
+            match height_cmp {
+                Ordering::Equal => b.0.cmp(&a.0),
+                h @ _ => h,
+            }
+        });
+        tx_list.built = true;
+        Ok(())
+    }
+
+    fn tx_summary(&self, acc_store: &RawAccountCache, tx_id: &BETxid) -> Result<TxSummary, Error> {
+        let tx = &acc_store
+            .all_txs
+            .get(tx_id)
+            .ok_or_else(fn_err(&format!("list_tx no tx {}", tx_id)))?
+            .tx;
+
+        let mut addressees = vec![];
+        for i in 0..tx.output_len() as u32 {
+            let script = tx.output_script(i);
+            if !script.is_empty() && !acc_store.paths.contains_key(&script) {
+                let address = tx.output_address(i, self.network.id());
+                trace!("tx_id {}:{} not my script, address {:?}", tx_id, i, address);
+                addressees.push(AddressAmount {
+                    address: address.unwrap_or_else(|| "".to_string()),
+                    satoshi: 0, // apparently not needed in list_tx addressees
+                    asset_id: None,
+                });
+            }
+        }
+
+        let fee =
+            tx.fee(&acc_store.all_txs, &acc_store.unblinded, &self.network.policy_asset_id().ok())?;
+        trace!("tx_id {} fee {}", tx_id, fee);
+
+        let satoshi =
+            tx.my_balance_changes(&acc_store.all_txs, &acc_store.paths, &acc_store.unblinded);
+        trace!("tx_id {} balances {:?}", tx_id, satoshi);
+
+        // We define an incoming txs if there are more assets received by the wallet than spent
+        // when they are equal it's an outgoing tx because the special asset liquid BTC
+        // is negative due to the fee being paid
+        // TODO how do we label issuance tx?
+        let negatives = satoshi.iter().filter(|(_, v)| **v < 0).count();
+        let positives = satoshi.iter().filter(|(_, v)| **v > 0).count();
+        let (type_, user_signed) = if satoshi.is_empty() && self.network.liquid {
+            ("unblindable", false)
+        } else if tx.is_redeposit(&acc_store.paths, &acc_store.all_txs) {
+            ("redeposit", true)
+        } else if positives > negatives {
+            ("incoming", false)
+        } else {
+            ("outgoing", true)
+        };
+        trace!("tx_id {} type {} user_signed {}", tx_id, type_, user_signed);
+
+        Ok(TxSummary {
+            fee,
+            satoshi,
+            type_,
+            user_signed,
+            addressees,
+        })
+    }
+
     pub fn utxos(&self, num_confs: u32, confidential_utxos_only: bool) -> Result<Utxos, Error> {
         info!("start utxos");
         let store_read = self.store.read()?;
         let acc_store = store_read.account_cache(self.account_num)?;
 
-        let tip_height = store_read.cache.tip.0;
+        let tip_height = store_read.cache().tip.0;
 
         let mut utxos = vec![];
         let spent = self.spent()?;
@@ -1,21 +1,26 @@
 use crate::error::*;
 use crate::headers::compute_merkle_root;
+use crate::headers::header_file::HeaderFile;
 use crate::spv::calc_difficulty_retarget;
 use bitcoin::blockdata::constants::{genesis_block, DIFFCHANGE_INTERVAL, TARGET_BLOCK_SPACING};
-use bitcoin::consensus::{deserialize, serialize};
 use bitcoin::hashes::hex::FromHex;
 use bitcoin::{BlockHash, Txid};
 use bitcoin::{BlockHeader, Network};
 use electrum_client::GetMerkleRes;
 use log::info;
 use std::collections::HashMap;
-use std::fs::{File, OpenOptions};
-use std::io::{Read, Seek, SeekFrom, Write};
+use std::fmt;
 use std::path::PathBuf;
+use std::sync::{Arc, Mutex, Weak};
+
+lazy_static! {
+    /// the chain open on each headers file, so that each file has a single writer in the process
+    static ref CHAINS: Mutex<HashMap<PathBuf, Weak<Mutex<HeadersChain>>>> = Mutex::new(HashMap::new());
+}
 
-#[derive(Debug)]
 pub struct HeadersChain {
     path: PathBuf,
+    file: HeaderFile,
     height: u32,
     last: BlockHeader,
     checkpoints: HashMap<u32, BlockHash>,
@@ -23,43 +28,47 @@ pub struct HeadersChain {
 }
 
 impl HeadersChain {
-    /// create a chain of headers based on the file identified by the `path` parameter.
+    /// the chain of headers based on the file identified by the `path` parameter, shared with any
+    /// other user of the same file in this process: the sync thread and `spv_verify_tx` both
+    /// extend and reorg the chain, and the memory mapped file must only have a single writer.
     /// if the file doesn't exist, a chain with only the genesis block (relative to `network`) is returned
-    pub fn new(path: PathBuf, network: Network) -> Result<HeadersChain, Error> {
-        let checkpoints = get_checkpoints(network);
-        if !path.exists() {
-            info!("{:?} chain file don't exists, creating", path);
-            let last = genesis_block(network).header;
-            let mut file = File::create(&path)?;
-            file.write_all(&serialize(&last))?;
-            let height = 0;
-
-            Ok(HeadersChain {
-                path,
-                height,
-                last,
-                checkpoints,
-                network,
-            })
-        } else {
-            info!("{:?} chain file exists, reading", path);
-            let mut file = File::open(&path)?;
-            let file_size = file.metadata()?.len();
-
-            file.seek(SeekFrom::Start(file_size - 80))?;
-            let mut buf = [0u8; 80];
-            file.read_exact(&mut buf)?;
-            let height = (file_size as u32 / 80) - 1;
-            let last: BlockHeader = deserialize(&buf)?;
-
-            Ok(HeadersChain {
-                path,
-                height,
-                last,
-                checkpoints,
-                network,
-            })
+    pub fn shared(path: PathBuf, network: Network) -> Result<Arc<Mutex<HeadersChain>>, Error> {
+        let key = match (path.parent(), path.file_name()) {
+            (Some(dir), Some(name)) => {
+                dir.canonicalize().map(|dir| dir.join(name)).unwrap_or_else(|_| path.clone())
+            }
+            _ => path.clone(),
+        };
+        let mut chains = CHAINS.lock().unwrap();
+        if let Some(chain) = chains.get(&key).and_then(Weak::upgrade) {
+            return Ok(chain);
         }
+        let chain = Arc::new(Mutex::new(HeadersChain::new(path, network)?));
+        chains.retain(|_, chain| chain.strong_count() > 0);
+        chains.insert(key, Arc::downgrade(&chain));
+        Ok(chain)
+    }
+
+    fn new(path: PathBuf, network: Network) -> Result<HeadersChain, Error> {
+        let checkpoints = get_checkpoints(network);
+        let file = HeaderFile::open(&path, &genesis_block(network).header)?;
+        let height = file.len() - 1;
+        let last = file.get(height)?;
+        info!("{:?} chain file opened at height {}", path, height);
+
+        Ok(HeadersChain {
+            path,
+            file,
+            height,
+            last,
+            checkpoints,
+            network,
+        })
+    }
+
+    /// index the headers by hash, speeding up `contains` at the cost of memory
+    pub fn enable_hash_index(&mut self) -> Result<(), Error> {
+        self.file.enable_hash_index()
     }
 
     pub fn height(&self) -> u32 {
@@ -98,23 +107,25 @@ impl HeadersChain {
     }
 
     pub fn get(&self, height: u32) -> Result<BlockHeader, Error> {
-        let mut file = File::open(&self.path)?;
-        file.seek(SeekFrom::Start(height as u64 * 80))?;
-        let mut buf = [0u8; 80];
-        file.read_exact(&mut buf)?;
-        let header: BlockHeader = deserialize(&buf)?;
-        Ok(header)
+        self.file.get(height)
+    }
+
+    /// whether the header at `height` in our chain has hash `hash`
+    pub fn contains(&self, height: u32, hash: &BlockHash) -> Result<bool, Error> {
+        if self.file.has_hash_index() {
+            Ok(self.file.height_of(hash) == Some(height))
+        } else {
+            Ok(height <= self.height && self.get(height)?.block_hash() == *hash)
+        }
     }
 
     /// to handle reorgs, it's necessary to remove some of the last headers
     pub fn remove(&mut self, headers_to_remove: u32) -> Result<(), Error> {
         let headers_to_remove = headers_to_remove.min(self.height);
         let new_height = self.height - headers_to_remove;
-        let new_size = (new_height + 1) as u64 * 80;
-        let file = OpenOptions::new().write(true).open(&self.path)?;
+        self.file.truncate(new_height + 1)?;
         self.last = self.get(new_height)?;
         self.height = new_height;
-        file.set_len(new_size)?;
         Ok(())
     }
 
@@ -122,11 +133,47 @@ impl HeadersChain {
         self.last
     }
 
-    /// write new headers to the file if checks are passed
+    /// write new headers to the file if checks are passed.
+    /// They are appended with a single write once all are checked, so none are if any is invalid
     pub fn push(&mut self, new_headers: Vec<BlockHeader>) -> Result<(), Error> {
         let mut curr_bits = self.curr_bits()?;
-        let mut serialized = vec![];
-        for new_header in new_headers {
+        let first_height = self.height + 1;
+        let (last, height) = (self.last, self.height);
+        let result = self.check_new_headers(&new_headers, &mut curr_bits);
+        if let Err(e) = result {
+            self.last = last;
+            self.height = height;
+            return Err(e);
+        }
+        debug_assert_eq!(first_height, self.file.len());
+        self.file.append(&new_headers)?;
+        info!(
+            "chain tip height {} hash {} file {:?}",
+            self.height,
+            self.tip().block_hash(),
+            self.path
+        );
+        Ok(())
+    }
+
+    /// the header at `height`, either in the file or in `pending` which would follow it
+    fn get_or_pending(&self, pending: &[BlockHeader], height: u32) -> Result<BlockHeader, Error> {
+        match height.checked_sub(self.file.len()) {
+            Some(i) => pending
+                .get(i as usize)
+                .copied()
+                .ok_or_else(|| Error::Generic(format!("no header at height {}", height))),
+            None => self.get(height),
+        }
+    }
+
+    /// check `new_headers` follow the chain, advancing `last` and `height` over them
+    fn check_new_headers(
+        &mut self,
+        new_headers: &[BlockHeader],
+        curr_bits: &mut u32,
+    ) -> Result<(), Error> {
+        for new_header in new_headers.iter().copied() {
             let new_height = self.height + 1;
             if self.last.block_hash() != new_header.prev_blockhash
                 || new_header.validate_pow(&new_header.target()).is_err()
@@ -135,16 +182,15 @@ impl HeadersChain {
             }
 
             if new_height % DIFFCHANGE_INTERVAL == 0 {
-                self.flush(&mut serialized)?;
-                let first = self.get(new_height - DIFFCHANGE_INTERVAL)?;
+                let first = self.get_or_pending(new_headers, new_height - DIFFCHANGE_INTERVAL)?;
                 let new_target = calc_difficulty_retarget(&first, &self.last);
 
                 if new_header.bits != BlockHeader::compact_target_from_u256(&new_target) {
                     return Err(Error::InvalidHeaders);
                 }
-                curr_bits = new_header.bits;
+                *curr_bits = new_header.bits;
             } else {
-                if new_header.bits != curr_bits {
+                if new_header.bits != *curr_bits {
                     if !self.pow_allow_min_difficulty_blocks()
                         || new_header.difficulty(self.network) != 1
                         || new_header.time.checked_sub(self.last.time).unwrap_or(0)
@@ -161,17 +207,9 @@ impl HeadersChain {
                 info!("checkpoint {} {} is ok", new_height, hash);
             }
 
-            serialized.extend(serialize(&new_header));
             self.last = new_header;
             self.height = new_height;
         }
-        self.flush(&mut serialized)?;
-        info!(
-            "chain tip height {} hash {} file {:?}",
-            self.height,
-            self.tip().block_hash(),
-            self.path
-        );
         Ok(())
     }
 
@@ -192,17 +230,16 @@ impl HeadersChain {
             Err(Error::InvalidHeaders)
         }
     }
+}
 
-    /// write `serialized` bytes to the file, forcing flush so we are sure next `get()` will have
-    /// also this data if requested
-    fn flush(&mut self, serialized: &mut Vec<u8>) -> Result<(), Error> {
-        if !serialized.is_empty() {
-            let mut file = OpenOptions::new().append(true).open(&self.path)?;
-            file.write_all(&serialized)?;
-            file.flush()?;
-            serialized.clear();
-        }
-        Ok(())
+impl fmt::Debug for HeadersChain {
+    fn fmt(&self, f: &mut fmt::Formatter) -> fmt::Result {
+        f.debug_struct("HeadersChain")
+            .field("path", &self.path)
+            .field("height", &self.height)
+            .field("last", &self.last)
+            .field("network", &self.network)
+            .finish()
     }
 }
 
@@ -342,4 +379,30 @@ mod test {
         );
         assert!(chain.get(200).is_err());
     }
+
+    #[test]
+    fn test_shared_chain() {
+        let temp = TempDir::new("temp_dir").unwrap();
+        let dir = temp.into_path();
+        let chain = HeadersChain::shared(dir.join("chain"), Network::Regtest).unwrap();
+
+        // the same file, however it is named, gives the same chain
+        let mut other_path = dir.join("sub");
+        std::fs::create_dir(&other_path).unwrap();
+        other_path.push("..");
+        other_path.push("chain");
+        let same = HeadersChain::shared(other_path, Network::Regtest).unwrap();
+        assert!(std::sync::Arc::ptr_eq(&chain, &same));
+
+        let other = HeadersChain::shared(dir.join("other"), Network::Regtest).unwrap();
+        assert!(!std::sync::Arc::ptr_eq(&chain, &other));
+
+        // once unused, the chain is dropped and opened again when next shared
+        let weak = std::sync::Arc::downgrade(&chain);
+        drop(chain);
+        drop(same);
+        assert!(weak.upgrade().is_none());
+        let reopened = HeadersChain::shared(dir.join("chain"), Network::Regtest).unwrap();
+        assert_eq!(reopened.lock().unwrap().height(), 0);
+    }
 }
@@ -0,0 +1,212 @@
+use crate::error::*;
+use bitcoin::consensus::{deserialize, serialize};
+use bitcoin::{BlockHash, BlockHeader};
+use log::warn;
+use memmap2::Mmap;
+use std::collections::HashMap;
+use std::fs::{File, OpenOptions};
+use std::io::{Seek, SeekFrom, Write};
+use std::path::Path;
+
+const HEADER_SIZE: usize = 80;
+
+/// Block headers persisted as consecutive 80 bytes records, the one at `height` being at offset
+/// `height * 80`. The file is memory mapped, so reading any header is a memory access rather than
+/// file I/O. The file must only be opened and modified through a single `HeaderFile` at a time,
+/// as truncating it would invalidate the mapping of any other.
+pub struct HeaderFile {
+    file: File,
+    mmap: Option<Mmap>,
+    len: u32,
+
+    /// block hash to height, only kept if enabled with `enable_hash_index`
+    hash_index: Option<HashMap<BlockHash, u32>>,
+}
+
+impl HeaderFile {
+    /// open the file at `path`, creating it with only `genesis` if it does not exist
+    pub fn open(path: &Path, genesis: &BlockHeader) -> Result<HeaderFile, Error> {
+        let file = OpenOptions::new().read(true).write(true).create(true).open(path)?;
+        let size = file.metadata()?.len() as usize;
+        let mut header_file = HeaderFile {
+            file,
+            mmap: None,
+            len: (size / HEADER_SIZE) as u32,
+            hash_index: None,
+        };
+        if header_file.len == 0 {
+            header_file.truncate(0)?;
+            header_file.append(&[*genesis])?;
+        } else {
+            header_file.repair(size)?;
+        }
+        Ok(header_file)
+    }
+
+    /// drop the records left incomplete, or not linked to their parent, by an interrupted write
+    fn repair(&mut self, size: usize) -> Result<(), Error> {
+        self.remap()?;
+        let mut len = self.len;
+        while len > 1 {
+            match (self.get(len - 2), self.get(len - 1)) {
+                (Ok(parent), Ok(child)) if child.prev_blockhash == parent.block_hash() => break,
+                _ => len -= 1,
+            }
+        }
+        if len as usize * HEADER_SIZE != size {
+            warn!(
+                "dropping {} bytes of incomplete or unlinked headers",
+                size - len as usize * HEADER_SIZE
+            );
+            self.truncate(len)?;
+        }
+        Ok(())
+    }
+
+    /// the number of headers, the tip being at `len() - 1`
+    pub fn len(&self) -> u32 {
+        self.len
+    }
+
+    pub fn get(&self, height: u32) -> Result<BlockHeader, Error> {
+        match &self.mmap {
+            Some(mmap) if height < self.len => {
+                let start = height as usize * HEADER_SIZE;
+                Ok(deserialize(&mmap[start..start + HEADER_SIZE])?)
+            }
+            _ => Err(Error::Generic(format!("no header at height {}", height))),
+        }
+    }
+
+    /// the height of the header with `hash`, if the index is enabled and it is in the file
+    pub fn height_of(&self, hash: &BlockHash) -> Option<u32> {
+        self.hash_index.as_ref().and_then(|index| index.get(hash).copied())
+    }
+
+    pub fn has_hash_index(&self) -> bool {
+        self.hash_index.is_some()
+    }
+
+    /// keep an index of the headers by hash, hashing all the headers in the file once
+    pub fn enable_hash_index(&mut self) -> Result<(), Error> {
+        if self.hash_index.is_none() {
+            let mut index = HashMap::with_capacity(self.len as usize);
+            for height in 0..self.len {
+                index.insert(self.get(height)?.block_hash(), height);
+            }
+            self.hash_index = Some(index);
+        }
+        Ok(())
+    }
+
+    /// append `headers` with a single write, synced to disk before returning
+    pub fn append(&mut self, headers: &[BlockHeader]) -> Result<(), Error> {
+        if headers.is_empty() {
+            return Ok(());
+        }
+        let mut serialized = Vec::with_capacity(headers.len() * HEADER_SIZE);
+        for header in headers {
+            serialized.extend(serialize(header));
+        }
+        self.file.seek(SeekFrom::Start((self.len as usize * HEADER_SIZE) as u64))?;
+        self.file.write_all(&serialized)?;
+        self.file.sync_data()?;
+
+        if let Some(index) = self.hash_index.as_mut() {
+            for (i, header) in headers.iter().enumerate() {
+                index.insert(header.block_hash(), self.len + i as u32);
+            }
+        }
+        self.len += headers.len() as u32;
+        self.remap()
+    }
+
+    /// keep only the first `len` headers.
+    /// The new length is synced to disk before returning. If interrupted, the file is left with
+    /// either length: any headers left over are replaced by the next append, as the length is
+    /// only updated on success, or dropped on open if they do not link to the ones that follow.
+    pub fn truncate(&mut self, len: u32) -> Result<(), Error> {
+        // the mapping must not cover data past the end of the file
+        self.mmap = None;
+        self.file.set_len((len as usize * HEADER_SIZE) as u64)?;
+        self.file.sync_all()?;
+
+        if let Some(index) = self.hash_index.as_mut() {
+            index.retain(|_, height| *height < len);
+        }
+        self.len = len;
+        self.remap()
+    }
+
+    fn remap(&mut self) -> Result<(), Error> {
+        self.mmap = None;
+        if self.len > 0 {
+            // Safety: the file is only modified through this struct, which drops the mapping
+            // before shrinking the file and remaps it after every change.
+            self.mmap = Some(unsafe { Mmap::map(&self.file)? });
+        }
+        Ok(())
+    }
+}
+
+#[cfg(test)]
+mod test {
+    use super::*;
+    use bitcoin::blockdata::constants::genesis_block;
+    use bitcoin::Network;
+    use tempdir::TempDir;
+
+    fn headers(n: u32) -> Vec<BlockHeader> {
+        let mut headers = vec![genesis_block(Network::Regtest).header];
+        for i in 1..n {
+            let mut header = headers[i as usize - 1];
+            header.prev_blockhash = header.block_hash();
+            header.nonce = i;
+            headers.push(header);
+        }
+        headers
+    }
+
+    #[test]
+    fn test_header_file() {
+        let temp = TempDir::new("temp_dir").unwrap();
+        let mut path = temp.into_path();
+        path.push("chain");
+        let headers = headers(100);
+
+        let mut file = HeaderFile::open(&path, &headers[0]).unwrap();
+        assert_eq!(file.len(), 1);
+        file.append(&headers[1..60]).unwrap();
+        file.append(&headers[60..]).unwrap();
+        assert_eq!(file.len(), 100);
+        for (height, header) in headers.iter().enumerate() {
+            assert_eq!(&file.get(height as u32).unwrap(), header);
+        }
+        assert!(file.get(100).is_err());
+
+        assert_eq!(file.height_of(&headers[42].block_hash()), None);
+        file.enable_hash_index().unwrap();
+        assert_eq!(file.height_of(&headers[42].block_hash()), Some(42));
+
+        file.truncate(50).unwrap();
+        assert_eq!(file.len(), 50);
+        assert!(file.get(50).is_err());
+        assert_eq!(file.height_of(&headers[60].block_hash()), None);
+        file.append(&headers[50..70]).unwrap();
+        assert_eq!(file.get(60).unwrap(), headers[60]);
+        assert_eq!(file.height_of(&headers[60].block_hash()), Some(60));
+        drop(file);
+
+        // an interrupted append, with a linked and an unlinked record and a partial one
+        let mut raw = OpenOptions::new().append(true).open(&path).unwrap();
+        raw.write_all(&serialize(&headers[70])).unwrap();
+        raw.write_all(&serialize(&headers[90])).unwrap();
+        raw.write_all(&[0u8; 30]).unwrap();
+        drop(raw);
+
+        let file = HeaderFile::open(&path, &headers[0]).unwrap();
+        assert_eq!(file.len(), 71);
+        assert_eq!(file.get(70).unwrap(), headers[70]);
+        assert_eq!(std::fs::metadata(&path).unwrap().len(), 71 * 80);
+    }
+}
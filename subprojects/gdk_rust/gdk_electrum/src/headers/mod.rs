@@ -15,14 +15,15 @@ use std::collections::HashSet;
 use std::fs::File;
 use std::io::{Read, Write};
 use std::path::PathBuf;
-use std::sync::Mutex;
+use std::sync::{Arc, Mutex};
 
 pub mod bitcoin;
+pub mod header_file;
 pub mod liquid;
 
 pub enum ChainOrVerifier {
     /// used for bitcoin networks
-    Chain(HeadersChain),
+    Chain(Arc<Mutex<HeadersChain>>),
 
     /// used for elements networks
     Verifier(Verifier),
@@ -60,7 +61,7 @@ lazy_static! {
 
 /// used to expose SPV functionality through C interface
 pub fn spv_verify_tx(input: &SPVVerifyTx) -> Result<SPVVerifyResult, Error> {
-    let _ = SPV_MUTEX.lock().unwrap();
+    let _guard = SPV_MUTEX.lock().unwrap();
 
     info!("spv_verify_tx {:?}", input);
     let txid = BETxid::from_hex(&input.txid, input.network.id())?;
@@ -79,11 +80,13 @@ pub fn spv_verify_tx(input: &SPVVerifyTx) -> Result<SPVVerifyResult, Error> {
         NetworkId::Bitcoin(bitcoin_network) => {
             let mut path: PathBuf = (&input.path).into();
             path.push(format!("headers_chain_{}", bitcoin_network));
-            let mut chain = HeadersChain::new(path, bitcoin_network)?;
+            // the chain is shared with the sessions syncing it, so it isn't locked while fetching
+            let chain = HeadersChain::shared(path, bitcoin_network)?;
+            let height = chain.lock().unwrap().height();
 
-            if input.height <= chain.height() {
+            if input.height <= height {
                 let btxid = txid.ref_bitcoin().unwrap();
-                info!("chain height ({}) enough to verify, downloading proof", chain.height());
+                info!("chain height ({}) enough to verify, downloading proof", height);
                 let proof = match client.transaction_get_merkle(btxid, input.height as usize) {
                     Ok(proof) => proof,
                     Err(e) => {
@@ -91,20 +94,22 @@ pub fn spv_verify_tx(input: &SPVVerifyTx) -> Result<SPVVerifyResult, Error> {
                         return Ok(SPVVerifyResult::NotVerified);
                     }
                 };
-                if chain.verify_tx_proof(btxid, input.height, proof).is_ok() {
+                if chain.lock().unwrap().verify_tx_proof(btxid, input.height, proof).is_ok() {
                     cache.write(&txid)?;
                     Ok(SPVVerifyResult::Verified)
                 } else {
                     Ok(SPVVerifyResult::NotVerified)
                 }
             } else {
-                info!(
-                    "chain height ({}) not enough to verify, downloading 2016 headers",
-                    chain.height()
-                );
+                info!("chain height ({}) not enough to verify, downloading 2016 headers", height);
                 let headers_to_download = input.headers_to_download.unwrap_or(2016).min(2016);
                 let headers =
-                    client.block_headers(chain.height() as usize + 1, headers_to_download)?.headers;
+                    client.block_headers(height as usize + 1, headers_to_download)?.headers;
+                let mut chain = chain.lock().unwrap();
+                if chain.height() != height {
+                    // extended or reorged meanwhile, the headers may no longer follow the tip
+                    return Ok(SPVVerifyResult::InProgress);
+                }
                 if let Err(Error::InvalidHeaders) = chain.push(headers) {
                     // handle reorgs
                     chain.remove(144)?;
@@ -1,4 +1,6 @@
+mod scan;
 mod store;
+mod unblind;
 
 #[macro_use]
 extern crate serde_json;
@@ -19,27 +21,24 @@ pub mod interface;
 pub mod pin;
 pub mod spv;
 
+use crate::account::Account;
 use crate::error::Error;
 use crate::interface::{ElectrumUrl, WalletCtx};
+use crate::scan::{scan_histories, AccountHistory};
 use crate::store::*;
+use crate::unblind::unblind_outputs;
 
-use bitcoin::hashes::hex::ToHex;
-use bitcoin::secp256k1::{self, Secp256k1, SecretKey};
+use bitcoin::secp256k1::{Secp256k1, SecretKey};
 use bitcoin::util::bip32::{DerivationPath, ExtendedPrivKey, ExtendedPubKey};
 
-use electrum_client::GetHistoryRes;
 use gdk_common::be::*;
 use gdk_common::mnemonic::Mnemonic;
 use gdk_common::model::*;
 use gdk_common::network::{aqua_unique_id_and_xpub, Network};
 use gdk_common::password::Password;
 use gdk_common::session::Session;
-use gdk_common::wally::{
-    self, asset_blinding_key_from_seed, asset_blinding_key_to_ec_private_key, asset_unblind,
-    make_str, MasterBlindingKey,
-};
+use gdk_common::wally::{self, asset_blinding_key_from_seed, make_str, MasterBlindingKey};
 
-use elements::confidential::{self, Asset, Nonce};
 use gdk_common::NetworkId;
 use std::collections::{HashMap, HashSet};
 use std::path::PathBuf;
@@ -58,7 +57,6 @@ use block_modes::block_padding::Pkcs7;
 use block_modes::BlockMode;
 use block_modes::Cbc;
 use electrum_client::{Client, ElectrumApi};
-use rand::seq::SliceRandom;
 use rand::thread_rng;
 use rand::Rng;
 use std::collections::hash_map::DefaultHasher;
@@ -414,7 +412,7 @@ impl Session<Error> for ElectrumSession {
             )?)),
         };
 
-        let mut tip_height = store.read()?.cache.tip.0;
+        let mut tip_height = store.read()?.cache().tip.0;
         notify_block(self.notify.clone(), tip_height);
 
         info!(
@@ -428,7 +426,7 @@ impl Session<Error> for ElectrumSession {
             thread::spawn(move || {
                 match try_get_fee_estimates(&fee_client) {
                     Ok(fee_estimates) => {
-                        fee_store.write().unwrap().cache.fee_estimates = fee_estimates
+                        fee_store.write().unwrap().set_fee_estimates(fee_estimates)
                     }
                     Err(e) => warn!("can't update fee estimates {:?}", e),
                 };
@@ -442,7 +440,7 @@ impl Session<Error> for ElectrumSession {
                 NetworkId::Bitcoin(network) => {
                     let mut path: PathBuf = self.data_root.as_str().into();
                     path.push(format!("headers_chain_{}", network));
-                    ChainOrVerifier::Chain(HeadersChain::new(path, network)?)
+                    ChainOrVerifier::Chain(HeadersChain::shared(path, network)?)
                 }
                 NetworkId::Elements(network) => {
                     let verifier = Verifier::new(network);
@@ -491,7 +489,7 @@ impl Session<Error> for ElectrumSession {
                                 Err(Error::InvalidHeaders) => {
                                     warn!("invalid headers");
                                     // this should handle reorgs and also broke IO writes update
-                                    headers.store.write().unwrap().cache.txs_verif.clear();
+                                    headers.store.write().unwrap().txs_verif_mut().clear();
                                     if let Err(e) = headers.remove(144) {
                                         warn!("failed removing headers: {:?}", e);
                                         break;
@@ -546,9 +544,9 @@ impl Session<Error> for ElectrumSession {
         };
 
         // Recover BIP 44 accounts on the first login
-        if !store.read().unwrap().cache.accounts_recovered {
+        if !store.read().unwrap().cache().accounts_recovered {
             wallet.write().unwrap().recover_accounts(&self.url, self.proxy.as_deref())?;
-            store.write().unwrap().cache.accounts_recovered = true;
+            store.write().unwrap().set_accounts_recovered();
         }
 
         let syncer = Syncer {
@@ -767,7 +765,7 @@ impl Session<Error> for ElectrumSession {
         };
         let fee_estimates = try_get_fee_estimates(&self.url.build_client(self.proxy.as_deref())?)
             .unwrap_or_else(|_| vec![FeeEstimate(min_fee); 25]);
-        self.get_wallet()?.store.write()?.cache.fee_estimates = fee_estimates.clone();
+        self.get_wallet()?.store.write()?.set_fee_estimates(fee_estimates.clone());
         Ok(fee_estimates)
         //TODO better implement default
     }
@@ -817,7 +815,7 @@ impl Session<Error> for ElectrumSession {
                     .clone()
                     .ok_or_else(|| Error::Generic("policy assets not available".into()))?;
                 let last_modified =
-                    self.get_wallet()?.store.read()?.cache.assets_last_modified.clone();
+                    self.get_wallet()?.store.read()?.cache().assets_last_modified.clone();
                 let base_url = self.network.registry_base_url()?;
                 let agent = self.build_request_agent()?;
                 thread::spawn(move || {
@@ -831,7 +829,7 @@ impl Session<Error> for ElectrumSession {
             let (tx_icons, rx_icons) = mpsc::channel();
             if details.icons {
                 let last_modified =
-                    self.get_wallet()?.store.read()?.cache.icons_last_modified.clone();
+                    self.get_wallet()?.store.read()?.cache().icons_last_modified.clone();
                 let base_url = self.network.registry_base_url()?;
                 let agent = self.build_request_agent()?;
                 thread::spawn(move || match call_icons(agent, base_url, last_modified) {
@@ -857,11 +855,11 @@ impl Session<Error> for ElectrumSession {
             let mut store_write = wallet.store.write()?;
             if let Value::Object(_) = icons {
                 store_write.write_asset_icons(&icons)?;
-                store_write.cache.icons_last_modified = icons_last_modified;
+                store_write.set_icons_last_modified(icons_last_modified);
             }
             if let Value::Object(_) = assets {
                 store_write.write_asset_registry(&assets)?;
-                store_write.cache.assets_last_modified = assets_last_modified;
+                store_write.set_assets_last_modified(assets_last_modified);
             }
         }
 
@@ -930,7 +928,7 @@ impl Session<Error> for ElectrumSession {
 
 impl ElectrumSession {
     pub fn export_cache(&self) -> Result<RawCache, Error> {
-        self.get_wallet()?.store.read()?.export_cache()
+        self.get_wallet()?.store.write()?.export_cache()
     }
 }
 
@@ -985,11 +983,11 @@ impl Tipper {
     pub fn tip(&self, client: &Client) -> Result<u32, Error> {
         let header = client.block_headers_subscribe_raw()?;
         let height = header.height as u32;
-        let tip_height = self.store.read()?.cache.tip.0;
+        let tip_height = self.store.read()?.cache().tip.0;
         if height != tip_height {
             let hash = BEBlockHeader::deserialize(&header.header, self.network.id())?.block_hash();
             info!("saving in store new tip {:?}", (height, hash));
-            self.store.write()?.cache.tip = (height, hash);
+            self.store.write()?.set_tip((height, hash));
         }
         Ok(height)
     }
@@ -997,10 +995,18 @@ impl Tipper {
 
 impl Headers {
     pub fn ask(&mut self, chunk_size: usize, client: &Client) -> Result<usize, Error> {
-        if let ChainOrVerifier::Chain(chain) = &mut self.checker {
-            info!("asking headers, current height:{} chunk_size:{} ", chain.height(), chunk_size);
-            let headers = client.block_headers(chain.height() as usize + 1, chunk_size)?.headers;
+        if let ChainOrVerifier::Chain(chain) = &self.checker {
+            // the chain is shared with other sessions, so it isn't locked while fetching
+            let height = chain.lock().unwrap().height();
+            info!("asking headers, current height:{} chunk_size:{} ", height, chunk_size);
+            let headers = client.block_headers(height as usize + 1, chunk_size)?.headers;
             let len = headers.len();
+            let mut chain = chain.lock().unwrap();
+            if chain.height() != height {
+                // extended or reorged meanwhile, the headers may no longer follow the tip
+                info!("chain height changed to {} while asking headers", chain.height());
+                return Ok(len);
+            }
             chain.push(headers)?;
             Ok(len)
         } else {
@@ -1022,7 +1028,7 @@ impl Headers {
             let remove_proof: Vec<BETxid> = acc_store
                 .heights
                 .iter()
-                .filter(|(t, h)| h.is_none() && store_read.cache.txs_verif.get(*t).is_some())
+                .filter(|(t, h)| h.is_none() && store_read.cache().txs_verif.get(*t).is_some())
                 .map(|(t, _)| t.clone())
                 .collect();
 
@@ -1031,7 +1037,7 @@ impl Headers {
                 .heights
                 .iter()
                 .filter_map(|(t, h_opt)| Some((t, (*h_opt)?)))
-                .filter(|(t, _)| store_read.cache.txs_verif.get(*t).is_none())
+                .filter(|(t, _)| store_read.cache().txs_verif.get(*t).is_none())
                 .map(|(t, h)| (t.clone(), h))
                 .collect();
             drop(acc_store);
@@ -1044,11 +1050,13 @@ impl Headers {
                 {
                     Ok(proof) => match &self.checker {
                         ChainOrVerifier::Chain(chain) => chain
+                            .lock()
+                            .unwrap()
                             .verify_tx_proof(txid.ref_bitcoin().unwrap(), height, proof)
                             .is_ok(),
                         ChainOrVerifier::Verifier(verifier) => {
                             if let Some(BEBlockHeader::Elements(header)) =
-                                self.store.read()?.cache.headers.get(&height)
+                                self.store.read()?.cache().headers.get(&height)
                             {
                                 verifier
                                     .verify_tx_proof(txid.ref_elements().unwrap(), proof, &header)
@@ -1076,9 +1084,9 @@ impl Headers {
 
             let mut store_write = self.store.write()?;
 
-            store_write.cache.txs_verif.extend(txs_verified);
+            store_write.txs_verif_mut().extend(txs_verified);
             for txid in remove_proof {
-                store_write.cache.txs_verif.remove(&txid);
+                store_write.txs_verif_mut().remove(&txid);
             }
         }
 
@@ -1086,8 +1094,8 @@ impl Headers {
     }
 
     pub fn remove(&mut self, headers: u32) -> Result<(), Error> {
-        if let ChainOrVerifier::Chain(chain) = &mut self.checker {
-            chain.remove(headers)?;
+        if let ChainOrVerifier::Chain(chain) = &self.checker {
+            chain.lock().unwrap().remove(headers)?;
         }
         Ok(())
     }
@@ -1098,16 +1106,16 @@ impl Headers {
         {
             let was_valid = {
                 let store = self.store.read().unwrap();
-                store.cache.cross_validation_result.as_ref().map(|r| r.is_valid())
+                store.cache().cross_validation_result.as_ref().map(|r| r.is_valid())
             };
 
-            let result = cross_validator.validate(chain);
+            let result = cross_validator.validate(&chain.lock().unwrap());
             debug!("cross validation result: {:?}", result);
 
             let changed = was_valid.map_or(true, |was_valid| was_valid != result.is_valid());
 
             let mut store = self.store.write().unwrap();
-            store.cache.cross_validation_result = Some(result);
+            store.set_cross_validation_result(result);
 
             changed
         } else {
@@ -1129,134 +1137,109 @@ impl Syncer {
         let start = Instant::now();
 
         let wallet = self.wallet.read().unwrap();
+        let accounts: Vec<&Account> = wallet.iter_accounts().collect();
         let mut updated_accounts = HashSet::new();
 
-        for account in wallet.iter_accounts() {
-            let mut history_txs_id = HashSet::<BETxid>::new();
-            let mut heights_set = HashSet::new();
-            let mut txid_height = HashMap::<BETxid, _>::new();
-            let mut scripts = HashMap::new();
-
-            let mut last_used = Indexes::default();
-            let mut wallet_chains = vec![0, 1];
-            wallet_chains.shuffle(&mut thread_rng());
-            for i in wallet_chains {
-                let mut batch_count = 0;
-                loop {
-                    let batch = account.get_script_batch(i == 1, batch_count)?;
-                    // convert the BEScript into bitcoin::Script for electrum-client
-                    let b_scripts =
-                        batch.value.iter().map(|e| e.0.clone().into_bitcoin()).collect::<Vec<_>>();
-                    let result: Vec<Vec<GetHistoryRes>> =
-                        client.batch_script_get_history(b_scripts.iter())?;
-                    if !batch.cached {
-                        scripts.extend(batch.value);
-                    }
-                    let max = result
-                        .iter()
-                        .enumerate()
-                        .filter(|(_, v)| !v.is_empty())
-                        .map(|(i, _)| i as u32)
-                        .max();
-                    if let Some(max) = max {
-                        if i == 0 {
-                            last_used.external = max + batch_count * BATCH_SIZE;
-                        } else {
-                            last_used.internal = max + batch_count * BATCH_SIZE;
-                        }
-                    };
-
-                    let flattened: Vec<GetHistoryRes> = result.into_iter().flatten().collect();
-                    trace!("{}/batch({}) {:?}", i, batch_count, flattened.len());
-
-                    if flattened.is_empty() {
-                        break;
-                    }
-
-                    let net = self.network.id();
-
-                    for el in flattened {
-                        // el.height = -1 means unconfirmed with unconfirmed parents
-                        // el.height =  0 means unconfirmed with confirmed parents
-                        // but we threat those tx the same
-                        let height = el.height.max(0);
-                        heights_set.insert(height as u32);
-                        if height == 0 {
-                            txid_height.insert(el.tx_hash.into_net(net), None);
-                        } else {
-                            txid_height.insert(el.tx_hash.into_net(net), Some(height as u32));
-                        }
-
-                        history_txs_id.insert(el.tx_hash.into_net(net));
-                    }
-
-                    batch_count += 1;
+        scan_histories(
+            accounts.len(),
+            self.network.id(),
+            |i, is_change, batch_count| accounts[i].get_script_batch(is_change, batch_count),
+            |scripts| {
+                // convert the BEScript into bitcoin::Script for electrum-client
+                let b_scripts =
+                    scripts.iter().map(|e| e.clone().into_bitcoin()).collect::<Vec<_>>();
+                Ok(client.batch_script_get_history(b_scripts.iter())?)
+            },
+            |i, history| {
+                let account = accounts[i];
+                let changed = self.update_account(account, history, client)?;
+                if changed {
+                    updated_accounts.insert(account.num());
                 }
-            }
+                trace!(
+                    "changes for {}: {} elapsed {}",
+                    account.num(),
+                    changed,
+                    start.elapsed().as_millis()
+                );
+                Ok(())
+            },
+        )?;
 
-            let new_txs = self.download_txs(account.num(), &history_txs_id, &scripts, &client)?;
-            let headers = self.download_headers(account.num(), &heights_set, &client)?;
+        Ok(updated_accounts)
+    }
 
-            let store_read = self.store.read()?;
-            let acc_store = store_read.account_cache(account.num())?;
-            let store_indexes = acc_store.indexes.clone();
-            let txs_heights_changed = txid_height
-                .iter()
-                .any(|(txid, height)| acc_store.heights.get(txid) != Some(height))
+    /// Download the new transactions and headers of a scanned account and update the store,
+    /// return whether anything changed
+    fn update_account(
+        &self,
+        account: &Account,
+        history: AccountHistory,
+        client: &Client,
+    ) -> Result<bool, Error> {
+        let AccountHistory {
+            history_txs_id,
+            heights_set,
+            txid_height,
+            scripts,
+            last_used,
+            ..
+        } = history;
+        let new_txs = self.download_txs(account.num(), &history_txs_id, &scripts, &client)?;
+        let headers = self.download_headers(account.num(), &heights_set, &client)?;
+
+        let store_read = self.store.read()?;
+        let acc_store = store_read.account_cache(account.num())?;
+        let store_indexes = acc_store.indexes.clone();
+        let txs_heights_changed =
+            txid_height.iter().any(|(txid, height)| acc_store.heights.get(txid) != Some(height))
                 || acc_store.heights.keys().any(|txid| txid_height.get(txid).is_none());
-            drop(acc_store);
-            drop(store_read);
-
-            let changed = if !new_txs.txs.is_empty()
-                || !headers.is_empty()
-                || store_indexes != last_used
-                || !scripts.is_empty()
-                || txs_heights_changed
-            {
-                info!(
-                    "There are changes in the store new_txs:{:?} headers:{:?} txid_height:{:?}",
-                    new_txs.txs.iter().map(|tx| tx.0).collect::<Vec<_>>(),
-                    headers,
-                    txid_height
-                );
-                let mut store_write = self.store.write()?;
-                store_write.cache.headers.extend(headers);
-
-                let mut acc_store = store_write.account_cache_mut(account.num())?;
-                acc_store.indexes = last_used;
-                acc_store
-                    .all_txs
-                    .extend(new_txs.txs.iter().cloned().map(|(txid, tx)| (txid, tx.into())));
-                acc_store.unblinded.extend(new_txs.unblinds);
-
-                // height map is used for the live list of transactions, since due to reorg or rbf tx
-                // could disappear from the list, we clear the list and keep only the last values returned by the server
-                acc_store.heights.clear();
-                acc_store.heights.extend(txid_height.into_iter());
-                acc_store.scripts.extend(scripts.clone().into_iter().map(|(a, b)| (b, a)));
-                acc_store.paths.extend(scripts.into_iter());
-
-                store_write.flush()?;
-                drop(store_write);
-
-                updated_accounts.insert(account.num());
-
-                // the transactions are first indexed into the db and then verified so that all the prevouts
-                // and scripts are available for querying. invalid transactions will be removed by verify_own_txs.
-                account.verify_own_txs(&new_txs.txs)?;
-                true
-            } else {
-                false
-            };
-            trace!(
-                "changes for {}: {} elapsed {}",
-                account.num(),
-                changed,
-                start.elapsed().as_millis()
+        drop(acc_store);
+        drop(store_read);
+
+        let changed = if !new_txs.txs.is_empty()
+            || !headers.is_empty()
+            || store_indexes != last_used
+            || !scripts.is_empty()
+            || txs_heights_changed
+        {
+            info!(
+                "There are changes in the store new_txs:{:?} headers:{:?} txid_height:{:?}",
+                new_txs.txs.iter().map(|tx| tx.0).collect::<Vec<_>>(),
+                headers,
+                txid_height
             );
-        }
-
-        Ok(updated_accounts)
+            let mut store_write = self.store.write()?;
+            store_write.insert_headers(headers);
+
+            let scripts_changed = !scripts.is_empty();
+            let mut acc_store = store_write.account_cache_mut(account.num())?;
+            acc_store.indexes = last_used;
+            acc_store
+                .all_txs
+                .extend(new_txs.txs.iter().cloned().map(|(txid, tx)| (txid, tx.into())));
+            acc_store.unblinded.extend(new_txs.unblinds);
+
+            // height map is used for the live list of transactions, since due to reorg or rbf tx
+            // could disappear from the list, we clear the list and keep only the last values returned by the server
+            acc_store.heights.clear();
+            acc_store.heights.extend(txid_height.into_iter());
+            acc_store.scripts.extend(scripts.clone().into_iter().map(|(a, b)| (b, a)));
+            acc_store.paths.extend(scripts.into_iter());
+
+            store_write.flush()?;
+            drop(store_write);
+
+            // the transactions are first indexed into the db and then verified so that all the prevouts
+            // and scripts are available for querying. invalid transactions will be removed by verify_own_txs.
+            account.verify_own_txs(&new_txs.txs)?;
+            // new scripts may change which outputs of known txs are ours
+            account.update_tx_list(scripts_changed)?;
+            true
+        } else {
+            false
+        };
+        Ok(changed)
     }
 
     fn download_headers(
@@ -1316,16 +1299,16 @@ impl Syncer {
             }
             info!("txs_downloaded {:?}", txs_downloaded.len());
             let mut previous_txs_to_download = HashSet::new();
+            let mut outputs_to_unblind = vec![];
+            let store_read = self.store.read()?;
+            let acc_store = store_read.account_cache(account_num)?;
             for tx in txs_downloaded.into_iter() {
                 let txid = tx.txid();
                 txs_in_db.insert(txid);
 
                 if let BETransaction::Elements(tx) = &tx {
-                    info!("compute OutPoint Unblinded");
                     for (i, output) in tx.output.iter().enumerate() {
                         let be_script = output.script_pubkey.clone().into_be();
-                        let store_read = self.store.read()?;
-                        let acc_store = store_read.account_cache(account_num)?;
                         // could be the searched script it's not yet in the store, because created in the current run, thus it's searched also in the `scripts`
                         if acc_store.paths.contains_key(&be_script)
                             || scripts.contains_key(&be_script)
@@ -1335,11 +1318,7 @@ impl Syncer {
                                 txid: tx.txid(),
                                 vout,
                             };
-
-                            match self.try_unblind(outpoint, output.clone()) {
-                                Ok(unblinded) => unblinds.push((outpoint, unblinded)),
-                                Err(_) => info!("{} cannot unblind, ignoring (could be sender messed up with the blinding process)", outpoint),
-                            }
+                            outputs_to_unblind.push((outpoint, output.clone()));
                         }
                     }
                 } else {
@@ -1350,6 +1329,15 @@ impl Syncer {
                 }
                 txs.push((txid, tx));
             }
+            drop(acc_store);
+            drop(store_read);
+
+            // unblind all the outputs of the batch together, without holding the store lock
+            if !outputs_to_unblind.is_empty() {
+                info!("compute OutPoint Unblinded for {} outputs", outputs_to_unblind.len());
+                let master_blinding = self.master_blinding.as_ref().unwrap();
+                unblinds = unblind_outputs(master_blinding, outputs_to_unblind);
+            }
 
             let txs_to_download: Vec<bitcoin::Txid> = previous_txs_to_download
                 .difference(&txs_in_db)
@@ -1373,65 +1361,6 @@ impl Syncer {
             Ok(DownloadTxResult::default())
         }
     }
-
-    pub fn try_unblind(
-        &self,
-        outpoint: elements::OutPoint,
-        output: elements::TxOut,
-    ) -> Result<Unblinded, Error> {
-        match (output.asset, output.value, output.nonce) {
-            (
-                Asset::Confidential(_, _),
-                confidential::Value::Confidential(_, _),
-                Nonce::Confidential(_, _),
-            ) => {
-                let master_blinding = self.master_blinding.as_ref().unwrap();
-
-                let script = output.script_pubkey.clone();
-                let blinding_key = asset_blinding_key_to_ec_private_key(master_blinding, &script);
-                let rangeproof = output.witness.rangeproof.clone();
-                let value_commitment = elements::encode::serialize(&output.value);
-                let asset_commitment = elements::encode::serialize(&output.asset);
-                let nonce_commitment = elements::encode::serialize(&output.nonce);
-                info!(
-                    "commitments len {} {} {}",
-                    value_commitment.len(),
-                    asset_commitment.len(),
-                    nonce_commitment.len()
-                );
-                let sender_pk = secp256k1::PublicKey::from_slice(&nonce_commitment).unwrap();
-
-                let (asset, abf, vbf, value) = asset_unblind(
-                    sender_pk,
-                    blinding_key,
-                    rangeproof,
-                    value_commitment,
-                    script,
-                    asset_commitment,
-                )?;
-
-                info!("Unblinded outpoint:{} asset:{} value:{}", outpoint, asset.to_hex(), value);
-
-                let unblinded = Unblinded {
-                    asset,
-                    value,
-                    abf,
-                    vbf,
-                };
-                Ok(unblinded)
-            }
-            (Asset::Explicit(asset_id), confidential::Value::Explicit(satoshi), _) => {
-                let unblinded = Unblinded {
-                    asset: asset_id,
-                    value: satoshi,
-                    abf: [0u8; 32],
-                    vbf: [0u8; 32],
-                };
-                Ok(unblinded)
-            }
-            _ => Err(Error::Generic("Unexpected asset/value/nonce".into())),
-        }
-    }
 }
 
 fn wait_or_close(r: &Receiver<()>, interval: u32) -> bool {
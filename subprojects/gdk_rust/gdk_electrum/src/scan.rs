@@ -0,0 +1,253 @@
+use std::collections::{HashMap, HashSet, VecDeque};
+
+use bitcoin::util::bip32::DerivationPath;
+use electrum_client::GetHistoryRes;
+use log::trace;
+use rand::seq::SliceRandom;
+use rand::thread_rng;
+
+use gdk_common::be::{BEScript, BETxid, BETxidConvert, ScriptBatch};
+use gdk_common::NetworkId;
+
+use crate::error::Error;
+use crate::store::{Indexes, BATCH_SIZE};
+
+/// Maximum number of script batches requested in a single round trip to the server
+pub const MAX_BATCHES_PER_REQUEST: usize = 8;
+
+/// The history of the scripts of an account, as found by `scan_histories`
+#[derive(Default)]
+pub struct AccountHistory {
+    pub history_txs_id: HashSet<BETxid>,
+    pub heights_set: HashSet<u32>,
+    pub txid_height: HashMap<BETxid, Option<u32>>,
+
+    /// scripts derived during the scan, not yet in the store
+    pub scripts: HashMap<BEScript, DerivationPath>,
+
+    pub last_used: Indexes,
+
+    /// chains not yet scanned up to a batch without history
+    chains_left: usize,
+}
+
+/// Scan the external and internal chains of `num_accounts` accounts up to a batch without history.
+///
+/// Rather than scanning each chain in turn, every round trip requests the next batch of all the
+/// chains still being scanned, up to `MAX_BATCHES_PER_REQUEST` of them, so that a wallet with many
+/// accounts needs about as many round trips as its longest chain has batches.
+/// `on_scanned` is called for each account as soon as both its chains are scanned, so that its
+/// transactions and headers are downloaded while the other accounts are still being scanned.
+pub fn scan_histories<B, H, S>(
+    num_accounts: usize,
+    net: NetworkId,
+    mut get_batch: B,
+    mut get_history: H,
+    mut on_scanned: S,
+) -> Result<(), Error>
+where
+    B: FnMut(usize, bool, u32) -> Result<ScriptBatch, Error>,
+    H: FnMut(&[BEScript]) -> Result<Vec<Vec<GetHistoryRes>>, Error>,
+    S: FnMut(usize, AccountHistory) -> Result<(), Error>,
+{
+    let mut histories: Vec<Option<AccountHistory>> = (0..num_accounts)
+        .map(|_| {
+            Some(AccountHistory {
+                chains_left: 2,
+                ..Default::default()
+            })
+        })
+        .collect();
+
+    // (account, chain, batch number) of the batches to request
+    let mut pending = VecDeque::new();
+    for account in 0..num_accounts {
+        let mut wallet_chains = [0u32, 1];
+        wallet_chains.shuffle(&mut thread_rng());
+        for chain in wallet_chains.iter() {
+            pending.push_back((account, *chain, 0));
+        }
+    }
+
+    while !pending.is_empty() {
+        let num_batches = pending.len().min(MAX_BATCHES_PER_REQUEST);
+        let mut batches = Vec::with_capacity(num_batches);
+        let mut scripts = vec![];
+        for (account, chain, batch_count) in pending.drain(..num_batches) {
+            let batch = get_batch(account, chain == 1, batch_count)?;
+            scripts.extend(batch.value.iter().map(|(script, _)| script.clone()));
+            batches.push((account, chain, batch_count, batch));
+        }
+
+        let results = get_history(&scripts)?;
+        if results.len() != scripts.len() {
+            return Err(Error::Generic("unexpected number of script histories".into()));
+        }
+        let mut results = results.into_iter();
+
+        for (account, chain, batch_count, batch) in batches {
+            let result: Vec<Vec<GetHistoryRes>> =
+                results.by_ref().take(batch.value.len()).collect();
+            let history = histories[account].as_mut().expect("account being scanned");
+
+            let max = result
+                .iter()
+                .enumerate()
+                .filter(|(_, v)| !v.is_empty())
+                .map(|(i, _)| i as u32)
+                .max();
+            if let Some(max) = max {
+                if chain == 0 {
+                    history.last_used.external = max + batch_count * BATCH_SIZE;
+                } else {
+                    history.last_used.internal = max + batch_count * BATCH_SIZE;
+                }
+            };
+            if !batch.cached {
+                history.scripts.extend(batch.value);
+            }
+
+            let flattened: Vec<GetHistoryRes> = result.into_iter().flatten().collect();
+            trace!("{}/{}/batch({}) {:?}", account, chain, batch_count, flattened.len());
+
+            if flattened.is_empty() {
+                history.chains_left -= 1;
+                if history.chains_left == 0 {
+                    let history = histories[account].take().expect("account being scanned");
+                    on_scanned(account, history)?;
+                }
+                continue;
+            }
+
+            for el in flattened {
+                // el.height = -1 means unconfirmed with unconfirmed parents
+                // el.height =  0 means unconfirmed with confirmed parents
+                // but we threat those tx the same
+                let height = el.height.max(0);
+                history.heights_set.insert(height as u32);
+                if height == 0 {
+                    history.txid_height.insert(el.tx_hash.into_net(net), None);
+                } else {
+                    history.txid_height.insert(el.tx_hash.into_net(net), Some(height as u32));
+                }
+
+                history.history_txs_id.insert(el.tx_hash.into_net(net));
+            }
+
+            pending.push_back((account, chain, batch_count + 1));
+        }
+    }
+
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use bitcoin::hashes::hex::ToHex;
+    use bitcoin::hashes::Hash;
+    use bitcoin::util::bip32::ChildNumber;
+    use bitcoin::Network;
+
+    fn script_bytes(account: usize, chain: u32, index: u32) -> Vec<u8> {
+        let mut bytes = vec![account as u8, chain as u8];
+        bytes.extend(&index.to_le_bytes());
+        bytes
+    }
+
+    fn script(account: usize, chain: u32, index: u32) -> BEScript {
+        BEScript::Bitcoin(bitcoin::Script::from(script_bytes(account, chain, index)))
+    }
+
+    fn history(account: usize, chain: u32, index: u32) -> GetHistoryRes {
+        let txid = bitcoin::Txid::hash(&script_bytes(account, chain, index));
+        serde_json::from_value(json!({ "height": 100 + index, "tx_hash": txid.to_hex() })).unwrap()
+    }
+
+    /// Scan against an electrum stand-in with the given last used (external, internal) index of
+    /// each account, returning the histories found and the number of round trips
+    fn scan(used: &[(Option<u32>, Option<u32>)]) -> (Vec<AccountHistory>, usize) {
+        let mut server = HashMap::new();
+        for (account, (external, internal)) in used.iter().enumerate() {
+            for (chain, last) in [(0, external), (1, internal)].iter() {
+                for index in 0..last.map_or(0, |last| last + 1) {
+                    server.insert(script(account, *chain, index), (account, *chain, index));
+                }
+            }
+        }
+
+        let mut requests = 0;
+        let mut scanned: Vec<Option<AccountHistory>> = used.iter().map(|_| None).collect();
+        scan_histories(
+            used.len(),
+            NetworkId::Bitcoin(Network::Regtest),
+            |account, is_change, batch_count| {
+                let chain = is_change as u32;
+                let start = batch_count * BATCH_SIZE;
+                let value = (start..start + BATCH_SIZE)
+                    .map(|index| {
+                        let path = DerivationPath::from(vec![
+                            ChildNumber::from(chain),
+                            ChildNumber::from(index),
+                        ]);
+                        (script(account, chain, index), path)
+                    })
+                    .collect();
+                Ok(ScriptBatch {
+                    cached: false,
+                    value,
+                })
+            },
+            |scripts| {
+                requests += 1;
+                assert!(scripts.len() <= MAX_BATCHES_PER_REQUEST * BATCH_SIZE as usize);
+                Ok(scripts
+                    .iter()
+                    .map(|s| {
+                        server.get(s).map(|(a, c, i)| history(*a, *c, *i)).into_iter().collect()
+                    })
+                    .collect())
+            },
+            |account, history| {
+                assert!(scanned[account].is_none());
+                scanned[account] = Some(history);
+                Ok(())
+            },
+        )
+        .unwrap();
+        (scanned.into_iter().map(|h| h.expect("all accounts scanned")).collect(), requests)
+    }
+
+    #[test]
+    fn test_scan_histories() {
+        let used = vec![
+            (Some(45), Some(3)),
+            (None, None),
+            (Some(0), None),
+            (Some(19), Some(20)),
+            (None, Some(99)),
+        ];
+        let (histories, requests) = scan(&used);
+
+        let mut sequential_requests = 0;
+        for (history, (external, internal)) in histories.iter().zip(used.iter()) {
+            assert_eq!(history.last_used.external, external.unwrap_or(0));
+            assert_eq!(history.last_used.internal, internal.unwrap_or(0));
+            let num_txs = external.map_or(0, |e| e + 1) + internal.map_or(0, |i| i + 1);
+            assert_eq!(history.history_txs_id.len(), num_txs as usize);
+            assert_eq!(history.txid_height.len(), num_txs as usize);
+            for last in [external, internal].iter() {
+                // batches with history, then an empty one
+                sequential_requests += last.map_or(0, |last| last / BATCH_SIZE + 1) + 1;
+            }
+        }
+        assert!(requests < sequential_requests as usize);
+    }
+
+    #[test]
+    fn test_scan_histories_empty() {
+        let (histories, requests) = scan(&[]);
+        assert!(histories.is_empty());
+        assert_eq!(requests, 0);
+    }
+}
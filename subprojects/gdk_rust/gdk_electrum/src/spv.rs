@@ -256,7 +256,7 @@ fn get_fork_branch(
             }
 
             // We reached the common ancestor
-            if height <= chain.height() && chain.get(height)?.block_hash() == blockhash {
+            if chain.contains(height, &blockhash)? {
                 break 'chunk_fetch;
             }
 
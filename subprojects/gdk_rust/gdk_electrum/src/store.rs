@@ -5,9 +5,13 @@ use aes_gcm_siv::{Aes256GcmSiv, Key, Nonce};
 use bitcoin::hashes::{sha256, Hash};
 use bitcoin::util::bip32::{DerivationPath, ExtendedPubKey};
 use bitcoin::Transaction;
-use gdk_common::be::{BEBlockHash, BEBlockHeader, BEScript, BETransaction, BETransactions, BETxid};
+use gdk_common::be::{
+    BEBlockHash, BEBlockHeader, BEScript, BETransaction, BETransactionEntry, BETransactions, BETxid,
+};
 use gdk_common::be::{BETxidConvert, Unblinded};
-use gdk_common::model::{AccountSettings, FeeEstimate, SPVVerifyResult, Settings};
+use gdk_common::model::{
+    AccountSettings, AddressAmount, Balances, FeeEstimate, SPVVerifyResult, Settings,
+};
 use gdk_common::NetworkId;
 use log::{info, warn};
 use rand::{thread_rng, Rng};
@@ -22,6 +26,29 @@ use std::time::Instant;
 
 pub const BATCH_SIZE: u32 = 20;
 
+/// Number of files the transactions of each account are persisted in, by the first byte of their
+/// txid, so that syncing a few new transactions does not rewrite the whole history
+const TX_SEGMENTS: usize = 32;
+
+// Files the store and cache are persisted in. Each contains the epoch of the flush that wrote it,
+// the cache manifest in `CACHE_META` is written last and lists the epoch every segment must have.
+const STORE_SETTINGS: &str = "store_settings";
+const STORE_MEMOS: &str = "store_memos";
+const CACHE_META: &str = "cache_meta";
+const CACHE_HEADERS: &str = "cache_headers";
+
+// Files written by previous versions, holding the whole store and cache
+const LEGACY_STORE: &str = "store";
+const LEGACY_CACHE: &str = "cache";
+
+fn account_segment_name(account_num: u32) -> String {
+    format!("cache_account_{}", account_num)
+}
+
+fn txs_segment_name(account_num: u32, segment: usize) -> String {
+    format!("cache_account_{}_txs_{}", account_num, segment)
+}
+
 pub type Store = Arc<RwLock<StoreMeta>>;
 
 /// RawCache is a persisted and encrypted cache of wallet data, contains stuff like wallet transactions
@@ -77,6 +104,27 @@ pub struct RawAccountCache {
     pub indexes: Indexes,
 }
 
+/// The wallet transactions of an account in the order they are listed, with the parts of their
+/// listing that only change when the account is synced. Not persisted, built on first use.
+#[derive(Default)]
+pub struct TxList {
+    pub built: bool,
+
+    /// sorted by descending height with unconfirmed first, then by descending txid
+    pub order: Vec<(BETxid, Option<u32>)>,
+
+    pub summaries: HashMap<BETxid, TxSummary>,
+}
+
+#[derive(Clone)]
+pub struct TxSummary {
+    pub fee: u64,
+    pub satoshi: Balances,
+    pub type_: &'static str,
+    pub user_signed: bool,
+    pub addressees: Vec<AddressAmount>,
+}
+
 /// RawStore contains data that are not extractable from xpub+blockchain
 /// like wallet settings and memos
 #[derive(Default, Serialize, Deserialize)]
@@ -92,16 +140,127 @@ pub struct RawStore {
     accounts_settings: Option<HashMap<u32, AccountSettings>>,
 }
 
+/// Epochs at which each segment of the cache was last written
+#[derive(Default, Serialize, Deserialize)]
+struct CacheManifest {
+    /// 0 if never written
+    headers: u64,
+
+    accounts: HashMap<u32, AccountManifest>,
+}
+
+#[derive(Default, Serialize, Deserialize)]
+struct AccountManifest {
+    meta: u64,
+
+    /// one per tx segment, 0 if never written
+    txs: Vec<u64>,
+}
+
+/// The `CACHE_META` segment: the manifest and the fields of RawCache not persisted elsewhere
+#[derive(Serialize)]
+struct CacheMetaRef<'a> {
+    manifest: &'a CacheManifest,
+    txs_verif: &'a HashMap<BETxid, SPVVerifyResult>,
+    fee_estimates: &'a Vec<FeeEstimate>,
+    tip: &'a (u32, BEBlockHash),
+    assets_last_modified: &'a String,
+    icons_last_modified: &'a String,
+    cross_validation_result: &'a Option<CrossValidationResult>,
+    accounts_recovered: bool,
+}
+
+#[derive(Deserialize)]
+struct CacheMeta {
+    manifest: CacheManifest,
+    txs_verif: HashMap<BETxid, SPVVerifyResult>,
+    fee_estimates: Vec<FeeEstimate>,
+    tip: (u32, BEBlockHash),
+    assets_last_modified: String,
+    icons_last_modified: String,
+    cross_validation_result: Option<CrossValidationResult>,
+    accounts_recovered: bool,
+}
+
+/// The per account segment: the fields of RawAccountCache except `all_txs`
+#[derive(Serialize)]
+struct AccountSegmentRef<'a> {
+    paths: &'a HashMap<BEScript, DerivationPath>,
+    scripts: &'a HashMap<DerivationPath, BEScript>,
+    heights: &'a HashMap<BETxid, Option<u32>>,
+    unblinded: &'a HashMap<elements::OutPoint, Unblinded>,
+    indexes: &'a Indexes,
+}
+
+#[derive(Deserialize)]
+struct AccountSegment {
+    paths: HashMap<BEScript, DerivationPath>,
+    scripts: HashMap<DerivationPath, BEScript>,
+    heights: HashMap<BETxid, Option<u32>>,
+    unblinded: HashMap<elements::OutPoint, Unblinded>,
+    indexes: Indexes,
+}
+
+#[derive(Serialize)]
+struct StoreSettingsRef<'a> {
+    settings: &'a Option<Settings>,
+    accounts_settings: &'a Option<HashMap<u32, AccountSettings>>,
+}
+
+#[derive(Deserialize)]
+struct StoreSettings {
+    settings: Option<Settings>,
+    accounts_settings: Option<HashMap<u32, AccountSettings>>,
+}
+
+/// Segments changed since the last flush
+#[derive(Default)]
+struct DirtySegments {
+    settings: bool,
+    memos: bool,
+    cache_meta: bool,
+    headers: bool,
+    accounts: HashSet<u32>,
+}
+
+/// Count and xor of the txids in each tx segment of an account, as last persisted.
+/// Transactions are never modified once inserted, so a change means the segment needs writing.
+type TxsFingerprint = Vec<(usize, [u8; 32])>;
+
+fn txs_segment(txid: &BETxid) -> usize {
+    txid.into_bitcoin().into_inner()[0] as usize % TX_SEGMENTS
+}
+
+fn txs_fingerprint(all_txs: &BETransactions) -> TxsFingerprint {
+    let mut fingerprint = vec![(0, [0u8; 32]); TX_SEGMENTS];
+    for txid in all_txs.keys() {
+        let bytes = txid.into_bitcoin().into_inner();
+        let (count, xor) = &mut fingerprint[bytes[0] as usize % TX_SEGMENTS];
+        *count += 1;
+        for (x, b) in xor.iter_mut().zip(bytes.iter()) {
+            *x ^= b;
+        }
+    }
+    fingerprint
+}
+
 pub struct StoreMeta {
-    pub cache: RawCache,
+    cache: RawCache,
     pub store: RawStore,
     id: NetworkId,
     path: PathBuf,
     cipher: Aes256GcmSiv,
+    dirty: DirtySegments,
+    manifest: CacheManifest,
+    /// epoch of the last flush of the cache
+    epoch: u64,
+    txs_fingerprints: HashMap<u32, TxsFingerprint>,
+    tx_lists: HashMap<u32, TxList>,
 }
 
 impl Drop for StoreMeta {
     fn drop(&mut self) {
+        // only writes the segments not yet flushed
         self.flush().unwrap();
     }
 }
@@ -115,54 +274,143 @@ pub struct Indexes {
 impl RawCache {
     /// create a new RawCache, try to load data from a file or a fallback file
     /// errors such as corrupted file or model change in the db, result in a empty store that will be repopulated
+    /// The manifest and epoch are returned only if loaded from the segments in `path`,
+    /// otherwise everything must be written on the next flush.
     fn new<P: AsRef<Path>>(
         path: P,
         cipher: &Aes256GcmSiv,
         fallback_path: Option<&Path>,
         fallback_cipher: Option<&Aes256GcmSiv>,
-    ) -> Self {
+    ) -> (Self, Option<(CacheManifest, u64)>) {
         Self::try_new(path, cipher).unwrap_or_else(|e| {
             if let (Some(fpath), Some(fcipher)) = (fallback_path, fallback_cipher) {
-                if let Ok(store) = Self::try_new(fpath, &fcipher) {
-                    return store;
+                if let Ok((store, _)) = Self::try_new(fpath, &fcipher) {
+                    return (store, None);
                 };
             };
             warn!("Initialize cache as default {:?}", e);
-            Default::default()
+            (Default::default(), None)
         })
     }
 
-    fn try_new<P: AsRef<Path>>(path: P, cipher: &Aes256GcmSiv) -> Result<Self, Error> {
-        let decrypted = load_decrypt("cache", path, cipher)?;
-        let store = serde_cbor::from_slice(&decrypted)?;
-        Ok(store)
+    /// load from segments, or from the single file written by previous versions
+    fn try_new<P: AsRef<Path>>(
+        path: P,
+        cipher: &Aes256GcmSiv,
+    ) -> Result<(Self, Option<(CacheManifest, u64)>), Error> {
+        match Self::try_new_segments(path.as_ref(), cipher) {
+            Ok((cache, manifest, epoch)) => Ok((cache, Some((manifest, epoch)))),
+            Err(e) => {
+                if path.as_ref().join(CACHE_META).exists() {
+                    warn!("cannot load cache segments {:?}", e);
+                }
+                let decrypted = load_decrypt(LEGACY_CACHE, path, cipher)?;
+                let store = serde_cbor::from_slice(&decrypted)?;
+                Ok((store, None))
+            }
+        }
+    }
+
+    fn try_new_segments(
+        path: &Path,
+        cipher: &Aes256GcmSiv,
+    ) -> Result<(Self, CacheManifest, u64), Error> {
+        let (epoch, meta): (u64, CacheMeta) = load_segment(CACHE_META, path, cipher, None)?;
+        let manifest = meta.manifest;
+        let mut cache = RawCache {
+            txs_verif: meta.txs_verif,
+            fee_estimates: meta.fee_estimates,
+            tip: meta.tip,
+            assets_last_modified: meta.assets_last_modified,
+            icons_last_modified: meta.icons_last_modified,
+            cross_validation_result: meta.cross_validation_result,
+            accounts_recovered: meta.accounts_recovered,
+            ..Default::default()
+        };
+        if manifest.headers != 0 {
+            let (_, headers) = load_segment(CACHE_HEADERS, path, cipher, Some(manifest.headers))?;
+            cache.headers = headers;
+        }
+        for (account_num, account_manifest) in manifest.accounts.iter() {
+            let (_, segment): (u64, AccountSegment) = load_segment(
+                &account_segment_name(*account_num),
+                path,
+                cipher,
+                Some(account_manifest.meta),
+            )?;
+            let mut account = RawAccountCache {
+                all_txs: Default::default(),
+                paths: segment.paths,
+                scripts: segment.scripts,
+                heights: segment.heights,
+                unblinded: segment.unblinded,
+                indexes: segment.indexes,
+            };
+            if account_manifest.txs.len() != TX_SEGMENTS {
+                return Err(Error::Generic("unexpected number of tx segments".into()));
+            }
+            for (i, txs_epoch) in account_manifest.txs.iter().enumerate() {
+                if *txs_epoch == 0 {
+                    continue;
+                }
+                let (_, txs): (u64, Vec<(BETxid, BETransactionEntry)>) = load_segment(
+                    &txs_segment_name(*account_num, i),
+                    path,
+                    cipher,
+                    Some(*txs_epoch),
+                )?;
+                account.all_txs.extend(txs);
+            }
+            cache.accounts.insert(*account_num, account);
+        }
+        Ok((cache, manifest, epoch))
     }
 }
 
 impl RawStore {
     /// create a new RawStore, try to load data from a file or a fallback file
     /// errors such as corrupted file or model change in the db, result in a empty store that will be repopulated
+    /// Also returns whether it was loaded from the segments in `path`,
+    /// otherwise everything must be written on the next flush.
     fn new<P: AsRef<Path>>(
         path: P,
         cipher: &Aes256GcmSiv,
         fallback_path: Option<&Path>,
         fallback_cipher: Option<&Aes256GcmSiv>,
-    ) -> Self {
+    ) -> (Self, bool) {
         Self::try_new(path, cipher).unwrap_or_else(|e| {
             if let (Some(fpath), Some(fcipher)) = (fallback_path, fallback_cipher) {
-                if let Ok(store) = Self::try_new(fpath, &fcipher) {
-                    return store;
+                if let Ok((store, _)) = Self::try_new(fpath, &fcipher) {
+                    return (store, false);
                 };
             };
             warn!("Initialize store as default {:?}", e);
-            Default::default()
+            (Default::default(), false)
         })
     }
 
-    fn try_new<P: AsRef<Path>>(path: P, cipher: &Aes256GcmSiv) -> Result<Self, Error> {
-        let decrypted = load_decrypt("store", path, cipher)?;
+    /// load from segments, or from the single file written by previous versions
+    fn try_new<P: AsRef<Path>>(path: P, cipher: &Aes256GcmSiv) -> Result<(Self, bool), Error> {
+        let path = path.as_ref();
+        if path.join(STORE_SETTINGS).exists() {
+            match Self::try_new_segments(path, cipher) {
+                Ok(store) => return Ok((store, true)),
+                Err(e) => warn!("cannot load store segments {:?}", e),
+            }
+        }
+        let decrypted = load_decrypt(LEGACY_STORE, path, cipher)?;
         let store = serde_cbor::from_slice(&decrypted)?;
-        Ok(store)
+        Ok((store, false))
+    }
+
+    fn try_new_segments(path: &Path, cipher: &Aes256GcmSiv) -> Result<Self, Error> {
+        let (_, settings): (u64, StoreSettings) = load_segment(STORE_SETTINGS, path, cipher, None)?;
+        let (_, memos) = load_segment(STORE_MEMOS, path, cipher, None)?;
+        Ok(RawStore {
+            settings: settings.settings,
+            memos,
+            accounts_settings: settings.accounts_settings,
+        })
     }
 }
 
@@ -191,6 +439,65 @@ fn load_decrypt<P: AsRef<Path>>(
     Ok(plaintext)
 }
 
+/// load a segment, checking it was written at the epoch expected by the manifest
+fn load_segment<T: serde::de::DeserializeOwned>(
+    name: &str,
+    path: &Path,
+    cipher: &Aes256GcmSiv,
+    expected_epoch: Option<u64>,
+) -> Result<(u64, T), Error> {
+    let decrypted = load_decrypt(name, path, cipher)?;
+    let (epoch, value): (u64, T) = serde_cbor::from_slice(&decrypted)?;
+    if let Some(expected_epoch) = expected_epoch {
+        if epoch != expected_epoch {
+            return Err(Error::Generic(format!(
+                "{} has epoch {}, expected {}",
+                name, epoch, expected_epoch
+            )));
+        }
+    }
+    Ok((epoch, value))
+}
+
+/// encrypt and write a value, returning the number of bytes written
+fn write_encrypt<T: serde::Serialize>(
+    name: &str,
+    path: &Path,
+    cipher: &Aes256GcmSiv,
+    value: &T,
+) -> Result<usize, Error> {
+    let now = Instant::now();
+    let mut nonce_bytes = [0u8; 12];
+    thread_rng().fill(&mut nonce_bytes);
+    let nonce = Nonce::from_slice(&nonce_bytes);
+    let mut plaintext = serde_cbor::to_vec(value)?;
+
+    cipher.encrypt_in_place(nonce, b"", &mut plaintext)?;
+    let ciphertext = plaintext;
+
+    // written to a temporary file which replaces the segment once synced, so that an interrupted
+    // flush leaves either the previous or the new segment rather than a truncated one
+    let store_path = path.join(name);
+    let tmp_path = path.join(format!("{}.tmp", name));
+    let mut file = File::create(&tmp_path)?;
+    file.write_all(&nonce_bytes)?;
+    file.write_all(&ciphertext)?;
+    file.sync_data()?;
+    drop(file);
+    std::fs::rename(&tmp_path, &store_path)?;
+    let written = ciphertext.len() + nonce_bytes.len();
+    info!("flushing {} bytes on {:?} took {}ms", written, &store_path, now.elapsed().as_millis());
+    Ok(written)
+}
+
+fn remove_legacy(name: &str, path: &Path) -> Result<(), Error> {
+    let legacy_path = path.join(name);
+    if legacy_path.exists() {
+        std::fs::remove_file(&legacy_path)?;
+    }
+    Ok(())
+}
+
 fn get_cipher(xpub: &ExtendedPubKey) -> Aes256GcmSiv {
     let mut enc_key_data = vec![];
     enc_key_data.extend(&xpub.public_key.to_bytes());
@@ -211,17 +518,43 @@ impl StoreMeta {
     ) -> Result<StoreMeta, Error> {
         let cipher = get_cipher(&xpub);
         let fallback_cipher = &fallback_xpub.and_then(|xpub| Some(get_cipher(&xpub)));
-        let mut cache =
+        let (mut cache, loaded_cache) =
             RawCache::new(path.as_ref(), &cipher, fallback_path, fallback_cipher.as_ref());
-        let mut store =
+        let (mut store, loaded_store) =
             RawStore::new(path.as_ref(), &cipher, fallback_path, fallback_cipher.as_ref());
         let path = path.as_ref().to_path_buf();
         if !path.exists() {
             std::fs::create_dir_all(&path)?;
         }
 
-        cache.accounts.entry(0).or_default();
-        store.accounts_settings.get_or_insert_with(|| Default::default());
+        let mut dirty = DirtySegments::default();
+        let (manifest, epoch, txs_fingerprints) = match loaded_cache {
+            Some((manifest, epoch)) => {
+                let fingerprints: HashMap<u32, TxsFingerprint> =
+                    cache.accounts.iter().map(|(n, a)| (*n, txs_fingerprint(&a.all_txs))).collect();
+                (manifest, epoch, fingerprints)
+            }
+            None => {
+                // not loaded from our segments, write them all on the next flush
+                dirty.cache_meta = true;
+                dirty.headers = true;
+                dirty.accounts = cache.accounts.keys().copied().collect();
+                (CacheManifest::default(), 0, HashMap::new())
+            }
+        };
+        if !loaded_store {
+            dirty.settings = true;
+            dirty.memos = true;
+        }
+
+        if !cache.accounts.contains_key(&0) {
+            cache.accounts.insert(0, Default::default());
+            dirty.accounts.insert(0);
+        }
+        if store.accounts_settings.is_none() {
+            store.accounts_settings = Some(Default::default());
+            dirty.settings = true;
+        }
 
         Ok(StoreMeta {
             cache,
@@ -229,49 +562,128 @@ impl StoreMeta {
             id,
             cipher,
             path,
+            dirty,
+            manifest,
+            epoch,
+            txs_fingerprints,
+            tx_lists: HashMap::new(),
         })
     }
 
-    fn flush_serializable<T: serde::Serialize>(&self, name: &str, value: &T) -> Result<(), Error> {
-        let now = Instant::now();
-        let mut nonce_bytes = [0u8; 12];
-        thread_rng().fill(&mut nonce_bytes);
-        let nonce = Nonce::from_slice(&nonce_bytes);
-        let mut plaintext = serde_cbor::to_vec(value)?;
-
-        self.cipher.encrypt_in_place(nonce, b"", &mut plaintext)?;
-        let ciphertext = plaintext;
-
-        let mut store_path = self.path.clone();
-        store_path.push(name);
-        //TODO should avoid rewriting if not changed? it involves saving plaintext (or struct hash)
-        // in the front of the file
-        let mut file = File::create(&store_path)?;
-        file.write(&nonce_bytes)?;
-        file.write(&ciphertext)?;
-        info!(
-            "flushing {} bytes on {:?} took {}ms",
-            ciphertext.len() + 16,
-            &store_path,
-            now.elapsed().as_millis()
-        );
-        Ok(())
+    /// write the settings and memos if changed, returning the number of bytes written
+    fn flush_store(&mut self) -> Result<usize, Error> {
+        let mut written = 0;
+        if self.dirty.memos {
+            written +=
+                write_encrypt(STORE_MEMOS, &self.path, &self.cipher, &(0u64, &self.store.memos))?;
+            self.dirty.memos = false;
+        }
+        if self.dirty.settings {
+            // written after the memos, its presence means both segments are
+            let settings = StoreSettingsRef {
+                settings: &self.store.settings,
+                accounts_settings: &self.store.accounts_settings,
+            };
+            written += write_encrypt(STORE_SETTINGS, &self.path, &self.cipher, &(0u64, settings))?;
+            self.dirty.settings = false;
+            remove_legacy(LEGACY_STORE, &self.path)?;
+        }
+        Ok(written)
     }
 
-    fn flush_store(&self) -> Result<(), Error> {
-        self.flush_serializable("store", &self.store)?;
-        Ok(())
-    }
+    /// write the segments of the cache changed since the last flush, then the manifest,
+    /// returning the number of bytes written
+    fn flush_cache(&mut self) -> Result<usize, Error> {
+        let epoch = self.epoch + 1;
+        let mut written = 0;
+
+        if self.dirty.headers {
+            written += write_encrypt(
+                CACHE_HEADERS,
+                &self.path,
+                &self.cipher,
+                &(epoch, &self.cache.headers),
+            )?;
+            self.manifest.headers = epoch;
+            self.dirty.headers = false;
+            self.dirty.cache_meta = true;
+        }
 
-    fn flush_cache(&self) -> Result<(), Error> {
-        self.flush_serializable("cache", &self.cache)?;
-        Ok(())
+        let mut dirty_accounts: Vec<u32> = self.dirty.accounts.iter().copied().collect();
+        dirty_accounts.sort();
+        for account_num in dirty_accounts {
+            let account = match self.cache.accounts.get(&account_num) {
+                Some(account) => account,
+                None => {
+                    self.dirty.accounts.remove(&account_num);
+                    continue;
+                }
+            };
+            let segment = AccountSegmentRef {
+                paths: &account.paths,
+                scripts: &account.scripts,
+                heights: &account.heights,
+                unblinded: &account.unblinded,
+                indexes: &account.indexes,
+            };
+            written += write_encrypt(
+                &account_segment_name(account_num),
+                &self.path,
+                &self.cipher,
+                &(epoch, segment),
+            )?;
+            let account_manifest = self.manifest.accounts.entry(account_num).or_default();
+            account_manifest.meta = epoch;
+            account_manifest.txs.resize(TX_SEGMENTS, 0);
+
+            let fingerprint = txs_fingerprint(&account.all_txs);
+            let previous = self.txs_fingerprints.get(&account_num);
+            let changed: Vec<bool> = (0..TX_SEGMENTS)
+                .map(|i| previous.map_or(true, |previous| previous[i] != fingerprint[i]))
+                .collect();
+            let mut segments: Vec<Vec<(&BETxid, &BETransactionEntry)>> = vec![vec![]; TX_SEGMENTS];
+            for (txid, tx) in account.all_txs.iter() {
+                let i = txs_segment(txid);
+                if changed[i] {
+                    segments[i].push((txid, tx));
+                }
+            }
+            for (i, txs) in segments.iter().enumerate().filter(|(i, _)| changed[*i]) {
+                written += write_encrypt(
+                    &txs_segment_name(account_num, i),
+                    &self.path,
+                    &self.cipher,
+                    &(epoch, txs),
+                )?;
+                account_manifest.txs[i] = epoch;
+            }
+            self.txs_fingerprints.insert(account_num, fingerprint);
+            self.dirty.accounts.remove(&account_num);
+            self.dirty.cache_meta = true;
+        }
+
+        if self.dirty.cache_meta {
+            let meta = CacheMetaRef {
+                manifest: &self.manifest,
+                txs_verif: &self.cache.txs_verif,
+                fee_estimates: &self.cache.fee_estimates,
+                tip: &self.cache.tip,
+                assets_last_modified: &self.cache.assets_last_modified,
+                icons_last_modified: &self.cache.icons_last_modified,
+                cross_validation_result: &self.cache.cross_validation_result,
+                accounts_recovered: self.cache.accounts_recovered,
+            };
+            written += write_encrypt(CACHE_META, &self.path, &self.cipher, &(epoch, meta))?;
+            self.epoch = epoch;
+            self.dirty.cache_meta = false;
+            remove_legacy(LEGACY_CACHE, &self.path)?;
+        }
+        Ok(written)
     }
 
-    pub fn flush(&self) -> Result<(), Error> {
-        self.flush_store()?;
-        self.flush_cache()?;
-        Ok(())
+    /// write the segments changed since the last flush, returning the number of bytes written
+    pub fn flush(&mut self) -> Result<usize, Error> {
+        Ok(self.flush_store()? + self.flush_cache()?)
     }
 
     fn read(&self, name: &str) -> Result<Option<Value>, Error> {
@@ -306,17 +718,87 @@ impl StoreMeta {
         self.cache.accounts.get(&account_num).ok_or_else(|| Error::InvalidSubaccount(account_num))
     }
 
+    /// marks the account as changed, so that it is written on the next flush
     pub fn account_cache_mut(&mut self, account_num: u32) -> Result<&mut RawAccountCache, Error> {
-        self.cache
+        let account = self
+            .cache
             .accounts
             .get_mut(&account_num)
-            .ok_or_else(|| Error::InvalidSubaccount(account_num))
+            .ok_or_else(|| Error::InvalidSubaccount(account_num))?;
+        self.dirty.accounts.insert(account_num);
+        Ok(account)
     }
 
     pub fn make_account_cache(&mut self, account_num: u32) -> &mut RawAccountCache {
+        self.dirty.accounts.insert(account_num);
         self.cache.accounts.entry(account_num).or_default()
     }
 
+    /// the transaction list of an account, if built
+    pub fn tx_list(&self, account_num: u32) -> Option<&TxList> {
+        self.tx_lists.get(&account_num).filter(|tx_list| tx_list.built)
+    }
+
+    /// the account cache with its transaction list, for updating the latter.
+    /// It is not persisted so does not mark the account to be flushed.
+    pub fn tx_list_mut(
+        &mut self,
+        account_num: u32,
+    ) -> Result<(&RawAccountCache, &mut TxList), Error> {
+        let account = self
+            .cache
+            .accounts
+            .get(&account_num)
+            .ok_or_else(|| Error::InvalidSubaccount(account_num))?;
+        Ok((account, self.tx_lists.entry(account_num).or_default()))
+    }
+
+    pub fn cache(&self) -> &RawCache {
+        &self.cache
+    }
+
+    pub fn insert_headers<I: IntoIterator<Item = (u32, BEBlockHeader)>>(&mut self, headers: I) {
+        for (height, header) in headers {
+            self.cache.headers.insert(height, header);
+            self.dirty.headers = true;
+        }
+    }
+
+    pub fn txs_verif_mut(&mut self) -> &mut HashMap<BETxid, SPVVerifyResult> {
+        self.dirty.cache_meta = true;
+        &mut self.cache.txs_verif
+    }
+
+    pub fn set_fee_estimates(&mut self, fee_estimates: Vec<FeeEstimate>) {
+        self.cache.fee_estimates = fee_estimates;
+        self.dirty.cache_meta = true;
+    }
+
+    pub fn set_tip(&mut self, tip: (u32, BEBlockHash)) {
+        self.cache.tip = tip;
+        self.dirty.cache_meta = true;
+    }
+
+    pub fn set_assets_last_modified(&mut self, last_modified: String) {
+        self.cache.assets_last_modified = last_modified;
+        self.dirty.cache_meta = true;
+    }
+
+    pub fn set_icons_last_modified(&mut self, last_modified: String) {
+        self.cache.icons_last_modified = last_modified;
+        self.dirty.cache_meta = true;
+    }
+
+    pub fn set_cross_validation_result(&mut self, result: CrossValidationResult) {
+        self.cache.cross_validation_result = Some(result);
+        self.dirty.cache_meta = true;
+    }
+
+    pub fn set_accounts_recovered(&mut self) {
+        self.cache.accounts_recovered = true;
+        self.dirty.cache_meta = true;
+    }
+
     pub fn account_nums(&self) -> HashSet<u32> {
         self.cache.accounts.keys().copied().collect()
     }
@@ -357,6 +839,7 @@ impl StoreMeta {
         // Coerced into a bitcoin::Txid to retain database compatibility
         let txid = txid.into_bitcoin();
         self.store.memos.insert(txid, memo.to_string());
+        self.dirty.memos = true;
         self.flush_store()?;
         Ok(())
     }
@@ -367,6 +850,7 @@ impl StoreMeta {
 
     pub fn insert_settings(&mut self, settings: Option<Settings>) -> Result<(), Error> {
         self.store.settings = settings;
+        self.dirty.settings = true;
         self.flush_store()?;
         Ok(())
     }
@@ -391,6 +875,7 @@ impl StoreMeta {
 
     pub fn set_account_settings(&mut self, account_num: u32, settings: AccountSettings) {
         self.store.accounts_settings.as_mut().unwrap().insert(account_num, settings);
+        self.dirty.settings = true;
     }
 
     pub fn spv_verification_status(&self, account_num: u32, txid: &BETxid) -> SPVVerifyResult {
@@ -412,9 +897,9 @@ impl StoreMeta {
         }
     }
 
-    pub fn export_cache(&self) -> Result<RawCache, Error> {
+    pub fn export_cache(&mut self) -> Result<RawCache, Error> {
         self.flush_cache()?;
-        RawCache::try_new(&self.path, &self.cipher)
+        Ok(RawCache::try_new_segments(&self.path, &self.cipher)?.0)
     }
 }
 
@@ -441,6 +926,7 @@ mod tests {
     use bitcoin::Network;
     use gdk_common::{be::BETxid, NetworkId};
     use std::str::FromStr;
+    use std::time::Duration;
     use tempdir::TempDir;
 
     #[test]
@@ -485,6 +971,132 @@ mod tests {
         assert_eq!(store.store.memos.get(txid_btc), Some(&"memo".to_string()));
     }
 
+    fn fake_tx(i: u32) -> (BETxid, BETransactionEntry) {
+        let tx = bitcoin::Transaction {
+            version: 2,
+            lock_time: i,
+            input: vec![bitcoin::TxIn {
+                previous_output: Default::default(),
+                script_sig: bitcoin::Script::new(),
+                sequence: 0xffffffff,
+                witness: vec![],
+            }],
+            output: vec![bitcoin::TxOut {
+                value: i as u64,
+                script_pubkey: bitcoin::Script::new(),
+            }],
+        };
+        (tx.txid().into_be(), BETransaction::Bitcoin(tx).into())
+    }
+
+    /// flush `num_txs` txs, then a single new one, returning the bytes written and time taken by
+    /// each flush
+    fn flush_txs(num_txs: u32) -> (usize, Duration, usize, Duration) {
+        let id = NetworkId::Bitcoin(Network::Testnet);
+        let mut dir = TempDir::new("unit_test").unwrap().into_path();
+        dir.push("store");
+        let xpub = ExtendedPubKey::from_str("tpubD97UxEEcrMpkE8yG3NQveraWveHzTAJx3KwPsUycx9ABfxRjMtiwfm6BtrY5yhF9yF2eyMg2hyDtGDYXx6gVLBox1m2Mq4u8zB2NXFhUZmm").unwrap();
+        let result;
+
+        let (new_txid, _) = fake_tx(num_txs);
+        {
+            let mut store = StoreMeta::new(&dir, xpub, None, None, id).unwrap();
+            let account = store.account_cache_mut(0).unwrap();
+            for i in 0..num_txs {
+                let (txid, tx) = fake_tx(i);
+                account.heights.insert(txid, Some(i));
+                account.all_txs.insert(txid, tx);
+            }
+
+            let now = Instant::now();
+            let full = store.flush().unwrap();
+            let full_elapsed = now.elapsed();
+
+            // nothing changed
+            assert_eq!(store.flush().unwrap(), 0);
+
+            // a new tx only rewrites its segment, the account and the manifest
+            let now = Instant::now();
+            let (txid, tx) = fake_tx(num_txs);
+            let account = store.account_cache_mut(0).unwrap();
+            account.heights.insert(txid, None);
+            account.all_txs.insert(txid, tx);
+            let incremental = store.flush().unwrap();
+            let incremental_elapsed = now.elapsed();
+            result = (full, full_elapsed, incremental, incremental_elapsed);
+            assert!(incremental > 0);
+            assert!(incremental < full / 2);
+
+            store.set_tip((1, BEBlockHash::default()));
+            assert!(store.flush().unwrap() < incremental);
+            store.insert_memo(new_txid, "memo").unwrap();
+            assert_eq!(store.flush().unwrap(), 0);
+        }
+
+        let store = StoreMeta::new(&dir, xpub, None, None, id).unwrap();
+        let account = store.account_cache(0).unwrap();
+        assert_eq!(account.all_txs.len(), num_txs as usize + 1);
+        assert_eq!(account.heights.get(&new_txid), Some(&None));
+        assert_eq!(store.cache().tip.0, 1);
+        assert_eq!(store.get_memo(&new_txid), Some(&"memo".to_string()));
+
+        // no temporary segment files are left behind
+        for entry in std::fs::read_dir(&dir).unwrap() {
+            assert!(!entry.unwrap().file_name().to_string_lossy().ends_with(".tmp"));
+        }
+        result
+    }
+
+    #[test]
+    fn test_flush_incremental() {
+        flush_txs(500);
+    }
+
+    #[test]
+    #[ignore] // benchmark, run with `cargo test -- --ignored test_flush_benchmark --nocapture`
+    fn test_flush_benchmark() {
+        let num_txs = 5000;
+        let (full, full_elapsed, incremental, incremental_elapsed) = flush_txs(num_txs);
+        println!(
+            "flushing {} txs: full {} bytes in {:?}, incremental {} bytes in {:?}",
+            num_txs, full, full_elapsed, incremental, incremental_elapsed
+        );
+    }
+
+    #[test]
+    fn test_db_legacy_files() {
+        let id = NetworkId::Bitcoin(Network::Testnet);
+        let mut dir = TempDir::new("unit_test").unwrap().into_path();
+        dir.push("store");
+        std::fs::create_dir_all(&dir).unwrap();
+        let xpub = ExtendedPubKey::from_str("tpubD97UxEEcrMpkE8yG3NQveraWveHzTAJx3KwPsUycx9ABfxRjMtiwfm6BtrY5yhF9yF2eyMg2hyDtGDYXx6gVLBox1m2Mq4u8zB2NXFhUZmm").unwrap();
+        let cipher = get_cipher(&xpub);
+        let (txid, tx) = fake_tx(0);
+
+        // whole cache and store in single files, as written by previous versions
+        let mut cache = RawCache::default();
+        cache.tip = (7, BEBlockHash::default());
+        cache.accounts.entry(0).or_default().all_txs.insert(txid, tx);
+        write_encrypt(LEGACY_CACHE, &dir, &cipher, &cache).unwrap();
+        let mut store = RawStore::default();
+        store.memos.insert(txid.into_bitcoin(), "memo".to_string());
+        write_encrypt(LEGACY_STORE, &dir, &cipher, &store).unwrap();
+
+        {
+            let store = StoreMeta::new(&dir, xpub, None, None, id).unwrap();
+            assert_eq!(store.cache().tip.0, 7);
+            assert!(store.account_cache(0).unwrap().all_txs.get(&txid).is_some());
+            assert_eq!(store.get_memo(&txid), Some(&"memo".to_string()));
+        }
+        assert!(!dir.join(LEGACY_CACHE).exists());
+        assert!(!dir.join(LEGACY_STORE).exists());
+
+        let store = StoreMeta::new(&dir, xpub, None, None, id).unwrap();
+        assert_eq!(store.cache().tip.0, 7);
+        assert!(store.account_cache(0).unwrap().all_txs.get(&txid).is_some());
+        assert_eq!(store.get_memo(&txid), Some(&"memo".to_string()));
+    }
+
     #[test]
     fn test_db_upgrade() {
         #[derive(Serialize, Deserialize)]
@@ -0,0 +1,266 @@
+use std::thread;
+
+use bitcoin::hashes::hex::ToHex;
+use bitcoin::secp256k1;
+use elements::confidential::{self, Asset, Nonce};
+use log::{info, trace};
+
+use gdk_common::be::Unblinded;
+use gdk_common::wally::{asset_blinding_key_to_ec_private_key, asset_unblind, MasterBlindingKey};
+
+use crate::error::Error;
+
+/// Maximum number of threads unblinding the outputs of a batch of transactions
+pub const UNBLIND_THREADS: usize = 4;
+
+/// Below this many outputs per thread, spawning threads costs more than it saves
+const MIN_OUTPUTS_PER_THREAD: usize = 16;
+
+/// Unblind `outputs` spreading them across up to `UNBLIND_THREADS` threads, so that the ECDH and
+/// rangeproof rewind of every output, which dominate the sync of a Liquid wallet, run in
+/// parallel. The result keeps the order of `outputs`, skipping the ones that cannot be unblinded.
+///
+/// No lock is held while unblinding: callers collect the outputs from the store, release it,
+/// and insert the result with a single write.
+/// libwally must be initialized, as gdk does at startup, before calling this.
+pub fn unblind_outputs(
+    master_blinding: &MasterBlindingKey,
+    outputs: Vec<(elements::OutPoint, elements::TxOut)>,
+) -> Vec<(elements::OutPoint, Unblinded)> {
+    let num_threads = (outputs.len() / MIN_OUTPUTS_PER_THREAD).max(1).min(UNBLIND_THREADS);
+    if num_threads == 1 {
+        return unblind_chunk(master_blinding, outputs);
+    }
+
+    let chunk_size = (outputs.len() + num_threads - 1) / num_threads;
+    let mut outputs = outputs.into_iter();
+    let handles: Vec<_> = (0..num_threads)
+        .map(|_| {
+            let chunk: Vec<_> = outputs.by_ref().take(chunk_size).collect();
+            let master_blinding = master_blinding.clone();
+            thread::spawn(move || unblind_chunk(&master_blinding, chunk))
+        })
+        .collect();
+    trace!("unblinding with {} threads", handles.len());
+
+    let mut unblinds = vec![];
+    for handle in handles {
+        unblinds.extend(handle.join().expect("unblinding thread panicked"));
+    }
+    unblinds
+}
+
+fn unblind_chunk(
+    master_blinding: &MasterBlindingKey,
+    outputs: Vec<(elements::OutPoint, elements::TxOut)>,
+) -> Vec<(elements::OutPoint, Unblinded)> {
+    outputs
+        .into_iter()
+        .filter_map(|(outpoint, output)| match unblind_output(master_blinding, &outpoint, &output) {
+            Ok(unblinded) => Some((outpoint, unblinded)),
+            Err(_) => {
+                info!("{} cannot unblind, ignoring (could be sender messed up with the blinding process)", outpoint);
+                None
+            }
+        })
+        .collect()
+}
+
+pub fn unblind_output(
+    master_blinding: &MasterBlindingKey,
+    outpoint: &elements::OutPoint,
+    output: &elements::TxOut,
+) -> Result<Unblinded, Error> {
+    match (output.asset, output.value, output.nonce) {
+        (
+            Asset::Confidential(_, _),
+            confidential::Value::Confidential(_, _),
+            Nonce::Confidential(_, _),
+        ) => {
+            let script = output.script_pubkey.clone();
+            let blinding_key = asset_blinding_key_to_ec_private_key(master_blinding, &script);
+            let rangeproof = output.witness.rangeproof.clone();
+            let value_commitment = elements::encode::serialize(&output.value);
+            let asset_commitment = elements::encode::serialize(&output.asset);
+            let nonce_commitment = elements::encode::serialize(&output.nonce);
+            trace!(
+                "commitments len {} {} {}",
+                value_commitment.len(),
+                asset_commitment.len(),
+                nonce_commitment.len()
+            );
+            let sender_pk = secp256k1::PublicKey::from_slice(&nonce_commitment).unwrap();
+
+            let (asset, abf, vbf, value) = asset_unblind(
+                sender_pk,
+                blinding_key,
+                rangeproof,
+                value_commitment,
+                script,
+                asset_commitment,
+            )?;
+
+            info!("Unblinded outpoint:{} asset:{} value:{}", outpoint, asset.to_hex(), value);
+
+            let unblinded = Unblinded {
+                asset,
+                value,
+                abf,
+                vbf,
+            };
+            Ok(unblinded)
+        }
+        (Asset::Explicit(asset_id), confidential::Value::Explicit(satoshi), _) => {
+            let unblinded = Unblinded {
+                asset: asset_id,
+                value: satoshi,
+                abf: [0u8; 32],
+                vbf: [0u8; 32],
+            };
+            Ok(unblinded)
+        }
+        _ => Err(Error::Generic("Unexpected asset/value/nonce".into())),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use bitcoin::hashes::Hash;
+    use elements::TxOutWitness;
+    use gdk_common::wally::{asset_generator_from_bytes, asset_rangeproof, asset_value_commitment};
+    use rand::{thread_rng, Rng};
+    use std::convert::TryInto;
+    use std::time::Instant;
+
+    /// A confidential output paying `value` of `asset` to the `i`-th script of the wallet
+    fn confidential_output(
+        master_blinding: &MasterBlindingKey,
+        asset: &elements::issuance::AssetId,
+        value: u64,
+        i: u32,
+    ) -> elements::TxOut {
+        let secp = secp256k1::Secp256k1::new();
+        let mut rng = thread_rng();
+
+        let mut script_bytes = vec![0x00, 0x14];
+        script_bytes.extend(&[0u8; 16]);
+        script_bytes.extend(&i.to_le_bytes());
+        let script_pubkey = elements::Script::from(script_bytes);
+
+        let blinding_key = asset_blinding_key_to_ec_private_key(master_blinding, &script_pubkey);
+        let blinding_pk = secp256k1::PublicKey::from_secret_key(&secp, &blinding_key);
+        let ephemeral_sk = secp256k1::SecretKey::new(&mut rng);
+        let ephemeral_pk = secp256k1::PublicKey::from_secret_key(&secp, &ephemeral_sk);
+
+        let abf: [u8; 32] = rng.gen();
+        let vbf: [u8; 32] = rng.gen();
+        let generator = asset_generator_from_bytes(asset, &abf);
+        let commitment = asset_value_commitment(value, vbf, generator);
+        let rangeproof = asset_rangeproof(
+            value,
+            blinding_pk,
+            ephemeral_sk,
+            asset,
+            abf,
+            vbf,
+            commitment,
+            &script_pubkey,
+            generator,
+            1,
+            0,
+            52,
+        );
+
+        let bytes = ephemeral_pk.serialize();
+        let byte32: [u8; 32] = bytes[1..].as_ref().try_into().unwrap();
+        elements::TxOut {
+            asset: generator,
+            value: commitment,
+            nonce: Nonce::Confidential(bytes[0], byte32),
+            script_pubkey,
+            witness: TxOutWitness {
+                rangeproof,
+                ..Default::default()
+            },
+        }
+    }
+
+    fn outpoint(i: u32) -> elements::OutPoint {
+        elements::OutPoint {
+            txid: elements::Txid::hash(&i.to_le_bytes()),
+            vout: i % 3,
+        }
+    }
+
+    #[test]
+    fn test_unblind_outputs() {
+        let master_blinding = MasterBlindingKey([7u8; 64]);
+        let other_blinding = MasterBlindingKey([8u8; 64]);
+        let asset = elements::issuance::AssetId::from_slice(&[1u8; 32]).unwrap();
+
+        let mut outputs = vec![];
+        for i in 0..50u32 {
+            // every tenth output is not blinded to us
+            let blinding = if i % 10 == 9 {
+                &other_blinding
+            } else {
+                &master_blinding
+            };
+            outputs.push((outpoint(i), confidential_output(blinding, &asset, 1000 + i as u64, i)));
+        }
+        let explicit = elements::TxOut {
+            asset: Asset::Explicit(asset),
+            value: confidential::Value::Explicit(42),
+            nonce: Nonce::Null,
+            script_pubkey: elements::Script::new(),
+            witness: TxOutWitness::default(),
+        };
+        outputs.push((outpoint(50), explicit));
+
+        let unblinds = unblind_outputs(&master_blinding, outputs);
+        let expected: Vec<u32> = (0..=50).filter(|i| i % 10 != 9).collect();
+        assert_eq!(unblinds.len(), expected.len());
+        for ((outpoint_, unblinded), i) in unblinds.iter().zip(expected) {
+            assert_eq!(*outpoint_, outpoint(i));
+            assert_eq!(unblinded.asset, asset);
+            assert_eq!(
+                unblinded.value,
+                if i == 50 {
+                    42
+                } else {
+                    1000 + i as u64
+                }
+            );
+        }
+    }
+
+    #[test]
+    #[ignore] // benchmark, run with `cargo test -- --ignored test_unblind_benchmark --nocapture`
+    fn test_unblind_benchmark() {
+        let master_blinding = MasterBlindingKey([7u8; 64]);
+        let asset = elements::issuance::AssetId::from_slice(&[1u8; 32]).unwrap();
+        let num_outputs = 2000;
+        let outputs: Vec<_> = (0..num_outputs)
+            .map(|i| (outpoint(i), confidential_output(&master_blinding, &asset, 1000, i)))
+            .collect();
+
+        let now = Instant::now();
+        let sequential = unblind_chunk(&master_blinding, outputs.clone());
+        let sequential_elapsed = now.elapsed();
+
+        let now = Instant::now();
+        let parallel = unblind_outputs(&master_blinding, outputs);
+        let parallel_elapsed = now.elapsed();
+
+        assert_eq!(sequential.len(), num_outputs as usize);
+        assert_eq!(parallel.len(), num_outputs as usize);
+        println!(
+            "unblinding {} outputs: sequential {}ms, {} threads {}ms",
+            num_outputs,
+            sequential_elapsed.as_millis(),
+            UNBLIND_THREADS,
+            parallel_elapsed.as_millis()
+        );
+    }
+}
@@ -38,6 +38,16 @@ GDK_API int GDKRUST_create_session(GDKRUST_session* session, const char* network
 
 GDK_API int GDKRUST_call_session(GDKRUST_session session, const char *method, const char *input, char** output);
 
+/**
+ * Call a session method with CBOR encoded input and output.
+ *
+ * :param output: Destination for the CBOR encoded result.
+ *|     Returned buffer should be freed using `GDKRUST_destroy_buffer`.
+ * :param output_len: Destination for the length of the result.
+ */
+GDK_API int GDKRUST_call_session_cbor(GDKRUST_session session, const char *method, const unsigned char *input,
+    size_t input_len, unsigned char** output, size_t* output_len);
+
 GDK_API int GDKRUST_spv_verify_tx(const char *input);
 
 #ifndef SWIG
@@ -53,6 +63,14 @@ GDK_API int GDKRUST_set_notification_handler(GDKRUST_session session, GDKRUST_no
  */
 GDK_API void GDKRUST_destroy_string(char* str);
 
+/**
+ * Free a buffer returned by the api.
+ *
+ * :param buf: The buffer to free.
+ * :param len: The length of the buffer.
+ */
+GDK_API void GDKRUST_destroy_buffer(unsigned char* buf, size_t len);
+
 /**
  * Free a session created by the api.
  *
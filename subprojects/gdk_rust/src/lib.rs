@@ -203,46 +203,108 @@ pub extern "C" fn GDKRUST_call_session(
     }
     let sess: &mut GdkSession = unsafe { &mut *(ptr as *mut GdkSession) };
 
-    if method == "exchange_rates" {
-        let rates = fetch_cached_exchange_rates(sess).unwrap_or_default();
-        let s = make_str(tickers_to_json(rates).to_string());
-        unsafe {
-            *output = s;
+    let (val, ret) = call_session(sess, &method, &input);
+    let s = make_str(val.to_string());
+    unsafe {
+        *output = s;
+    }
+    ret
+}
+
+/// As `GDKRUST_call_session`, but with input and output encoded as CBOR,
+/// avoiding text encoding and decoding of large payloads.
+/// The output buffer must be freed with `GDKRUST_destroy_buffer`.
+#[no_mangle]
+pub extern "C" fn GDKRUST_call_session_cbor(
+    ptr: *mut libc::c_void,
+    method: *const c_char,
+    input: *const u8,
+    input_len: usize,
+    output: *mut *mut u8,
+    output_len: *mut usize,
+) -> i32 {
+    let method = read_str(method);
+    if input.is_null() {
+        return GA_ERROR;
+    }
+    let input_bytes = unsafe { std::slice::from_raw_parts(input, input_len) };
+    let input: Value = match serde_cbor::from_slice(input_bytes) {
+        Ok(x) => x,
+        Err(err) => {
+            error!("error: {:?}", err);
+            return GA_ERROR;
         }
-        return GA_OK;
+    };
+
+    if ptr.is_null() {
+        return GA_ERROR;
     }
+    let sess: &mut GdkSession = unsafe { &mut *(ptr as *mut GdkSession) };
 
-    // Redact inputs containing private data
-    let methods_to_redact_in =
-        vec!["login", "register_user", "set_pin", "create_subaccount", "mnemonic_from_pin_data"];
-    let input_str = format!("{:?}", &input);
-    let input_redacted = if methods_to_redact_in.contains(&method.as_str())
-        || input_str.contains("pin")
-        || input_str.contains("mnemonic")
-        || input_str.contains("xprv")
-    {
-        "redacted".to_string()
-    } else {
-        input_str
+    let (val, ret) = call_session(sess, &method, &input);
+    let buf = match serde_cbor::to_vec(&val) {
+        Ok(buf) => buf.into_boxed_slice(),
+        Err(err) => {
+            error!("error: {:?}", err);
+            return GA_ERROR;
+        }
     };
+    unsafe {
+        *output_len = buf.len();
+        *output = Box::into_raw(buf) as *mut u8;
+    }
+    ret
+}
+
+fn call_session(sess: &mut GdkSession, method: &str, input: &Value) -> (Value, i32) {
+    if method == "exchange_rates" {
+        let rates = fetch_cached_exchange_rates(sess).unwrap_or_default();
+        return (tickers_to_json(rates), GA_OK);
+    }
+
+    // Payloads are only formatted if they will be logged, as they can be large
+    let log_payloads = log_enabled!(Level::Info);
+
+    if log_payloads {
+        // Redact inputs containing private data
+        let methods_to_redact_in = vec![
+            "login",
+            "register_user",
+            "set_pin",
+            "create_subaccount",
+            "mnemonic_from_pin_data",
+        ];
+        let input_str = format!("{:?}", &input);
+        let input_redacted = if methods_to_redact_in.contains(&method)
+            || input_str.contains("pin")
+            || input_str.contains("mnemonic")
+            || input_str.contains("xprv")
+        {
+            "redacted".to_string()
+        } else {
+            input_str
+        };
+        info!("GDKRUST_call_session handle_call {} input {:?}", method, input_redacted);
+    }
 
-    info!("GDKRUST_call_session handle_call {} input {:?}", method, input_redacted);
     let res = match sess.backend {
-        GdkBackend::Electrum(ref mut s) => handle_call(s, &method, &input),
+        GdkBackend::Electrum(ref mut s) => handle_call(s, method, input),
         // GdkSession::Rpc(ref s) => handle_call(s, method),
     };
 
-    let methods_to_redact_out = vec!["get_mnemonic", "mnemonic_from_pin_data"];
-    let mut output_redacted = if methods_to_redact_out.contains(&method.as_str()) {
-        "redacted".to_string()
-    } else {
-        format!("{:?}", res)
-    };
-    output_redacted.truncate(200);
-    info!("GDKRUST_call_session {} output {:?}", method, output_redacted);
+    if log_payloads {
+        let methods_to_redact_out = vec!["get_mnemonic", "mnemonic_from_pin_data"];
+        let mut output_redacted = if methods_to_redact_out.contains(&method) {
+            "redacted".to_string()
+        } else {
+            format!("{:?}", res)
+        };
+        output_redacted.truncate(200);
+        info!("GDKRUST_call_session {} output {:?}", method, output_redacted);
+    }
 
-    let (s, ret) = match res {
-        Ok(ref val) => (val.to_string(), GA_OK),
+    match res {
+        Ok(val) => (val, GA_OK),
         Err(ref e) => {
             let code = e.to_gdk_code();
             let desc = e.gdk_display();
@@ -253,14 +315,9 @@ pub extern "C" fn GDKRUST_call_session(
             };
 
             info!("rust error {}: {}", code, desc);
-            (json!({ "error": code, "message": desc }).to_string(), ret_val)
+            (json!({ "error": code, "message": desc }), ret_val)
         }
-    };
-    let s = make_str(s);
-    unsafe {
-        *output = s;
     }
-    ret
 }
 
 #[no_mangle]
@@ -442,6 +499,17 @@ pub extern "C" fn GDKRUST_destroy_string(ptr: *mut c_char) {
     }
 }
 
+#[no_mangle]
+pub extern "C" fn GDKRUST_destroy_buffer(ptr: *mut u8, len: usize) {
+    if ptr.is_null() {
+        return;
+    }
+    unsafe {
+        // retake the boxed slice and drop
+        let _ = Box::from_raw(std::slice::from_raw_parts_mut(ptr, len) as *mut [u8]);
+    }
+}
+
 #[no_mangle]
 pub extern "C" fn GDKRUST_destroy_session(ptr: *mut libc::c_void) {
     unsafe {
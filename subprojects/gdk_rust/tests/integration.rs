@@ -15,6 +15,7 @@ use gdk_electrum::{determine_electrum_url_from_net, spv, ElectrumSession};
 
 use log::info;
 use std::collections::HashMap;
+use std::sync::{Arc, Mutex};
 use std::{env, path};
 use tempdir::TempDir;
 
@@ -882,6 +883,7 @@ fn spv_cross_validate() {
 
         // Grab direct access to session1's HeadersChain
         let session1_chain = get_chain(&mut test_session1);
+        let session1_chain = session1_chain.lock().unwrap();
         assert_eq!(session1_chain.height(), 126);
 
         // Cross-validate session1's chain against session'2 electrum server
@@ -910,6 +912,7 @@ fn spv_cross_validate() {
 
         // Grab direct access to session1's HeadersChain
         let session1_chain = get_chain(&mut test_session1);
+        let session1_chain = session1_chain.lock().unwrap();
         assert_eq!(session1_chain.height(), 121);
 
         // Cross-validate session1's chain against session'2 electrum server
@@ -1054,11 +1057,11 @@ fn setup_session(is_liquid: bool, network_conf: impl FnOnce(&mut Network)) -> Te
     test_session::setup(is_liquid, debug, &electrs_exec, &node_exec, network_conf)
 }
 
-fn get_chain(test_session: &mut TestSession) -> HeadersChain {
+fn get_chain(test_session: &mut TestSession) -> Arc<Mutex<HeadersChain>> {
     test_session.stop();
     let mut path: path::PathBuf = test_session.session.data_root.as_str().into();
     path.push("headers_chain_regtest");
-    HeadersChain::new(path, bitcoin::Network::Regtest).unwrap()
+    HeadersChain::shared(path, bitcoin::Network::Regtest).unwrap()
 }
 
 fn assert_unwrap_invalid(result: spv::CrossValidationResult) -> spv::CrossValidationInvalid {
@@ -1019,7 +1019,7 @@ impl TestSession {
     pub fn get_spv_cross_validation(&self) -> Option<spv::CrossValidationResult> {
         let wallet = self.session.get_wallet().unwrap();
         let store = wallet.store.read().unwrap();
-        store.cache.cross_validation_result.clone()
+        store.cache().cross_validation_result.clone()
     }
 
     /// wait for the spv cross validation status to change
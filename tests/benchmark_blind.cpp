@@ -0,0 +1,59 @@
+#include "src/ga_tx.hpp"
+#include "src/network_parameters.hpp"
+#include "src/utils.hpp"
+#include <chrono>
+#include <iostream>
+
+using namespace ga::sdk;
+
+// Time blinding the outputs of Liquid payout transactions with many recipients.
+// The range and surjection proofs of every output dominate the cost.
+
+namespace {
+static const std::string ASSET_ID("6f0279e9ed041c3d710a9f57d0c02928416460c4b722ae3457a11eec381c526d");
+
+static double blind_tx(const network_parameters& net_params, size_t num_outputs)
+{
+    const auto input_abf = get_fast_random_bytes<32>();
+    const auto input_vbf = get_fast_random_bytes<32>();
+    nlohmann::json utxo = { { "asset_id", ASSET_ID }, { "assetblinder", b2h_rev(input_abf) },
+        { "amountblinder", b2h_rev(input_vbf) }, { "satoshi", 1000000 } };
+    nlohmann::json details = { { "used_utxos", nlohmann::json::array({ utxo }) },
+        { "transaction_outputs", nlohmann::json::array() } };
+
+    const auto asset_id = h2b_rev(ASSET_ID);
+    const std::vector<unsigned char> script(22, 0); // P2WPKH
+    auto tx = tx_init(0, 1, num_outputs);
+    std::vector<output_blinders> blinders;
+    for (size_t i = 0; i < num_outputs; ++i) {
+        const auto blinding_key = get_ephemeral_keypair();
+        const auto eph_keypair = get_ephemeral_keypair();
+        details["transaction_outputs"].push_back({ { "is_fee", false }, { "asset_id", ASSET_ID },
+            { "script", b2h(script) }, { "public_key", b2h(blinding_key.second) }, { "satoshi", 1000 },
+            { "eph_keypair_sec", b2h(eph_keypair.first) }, { "eph_keypair_pub", b2h(eph_keypair.second) } });
+
+        const auto abf = get_fast_random_bytes<32>();
+        const auto vbf = get_fast_random_bytes<32>();
+        const auto generator = asset_generator_from_bytes(asset_id, abf);
+        const auto value_commitment = asset_value_commitment(1000, vbf, generator);
+        blinders.emplace_back(output_blinders{ generator, value_commitment, abf, vbf });
+        tx_add_elements_raw_output(tx, script, generator, value_commitment, eph_keypair.second, {}, {});
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    blind_outputs(net_params, details, tx, blinders);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+} // namespace
+
+int main()
+{
+    const network_parameters net_params{ network_parameters::get("liquid") };
+    for (const size_t num_outputs : { 10u, 50u, 100u }) {
+        const double elapsed = blind_tx(net_params, num_outputs);
+        std::cout << num_outputs << " outputs: " << static_cast<uint64_t>(elapsed * 1000) << "ms, "
+                  << static_cast<uint64_t>(num_outputs / elapsed) << " outputs/s" << std::endl;
+    }
+    return 0;
+}
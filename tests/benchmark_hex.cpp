@@ -0,0 +1,60 @@
+#include "src/ga_wally.hpp"
+#include "src/utils.hpp"
+#include <chrono>
+#include <iostream>
+
+using namespace ga::sdk;
+
+// Compare the hex codecs against the libwally implementations for
+// txid, script and rangeproof/transaction sized inputs
+
+namespace {
+template <typename F> static double mb_per_second(size_t num_bytes, size_t iterations, F&& fn)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; ++i) {
+        fn();
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return num_bytes * iterations / elapsed.count() / (1024 * 1024);
+}
+} // namespace
+
+int main()
+{
+    for (const size_t num_bytes : { 32u, 1024u, 64u * 1024u }) {
+        std::vector<unsigned char> bytes(num_bytes);
+        get_fast_random_bytes(bytes.size(), bytes.data(), bytes.size());
+        const std::string hex = b2h(bytes);
+        GDK_RUNTIME_ASSERT(h2b(hex) == bytes);
+        GDK_RUNTIME_ASSERT(h2b_rev(b2h_rev(bytes)) == bytes);
+
+        std::string hex_buff(hex.size(), '\0');
+        std::vector<unsigned char> bytes_buff(bytes.size());
+        const size_t iterations = 64 * 1024 * 1024 / num_bytes;
+
+        const double wally_encode = mb_per_second(num_bytes, iterations, [&] {
+            char* p;
+            GDK_VERIFY(wally_hex_from_bytes(bytes.data(), bytes.size(), &p));
+            wally_free_string(p);
+        });
+        const double wally_decode = mb_per_second(num_bytes, iterations, [&] {
+            size_t written;
+            GDK_VERIFY(wally_hex_to_bytes(hex.c_str(), bytes_buff.data(), bytes_buff.size(), &written));
+        });
+        const double encode = mb_per_second(num_bytes, iterations, [&] { b2h(bytes); });
+        const double encode_rev = mb_per_second(num_bytes, iterations, [&] { b2h_rev(bytes); });
+        const double encode_buff
+            = mb_per_second(num_bytes, iterations, [&] { b2h(bytes, gsl::make_span(&hex_buff[0], hex_buff.size())); });
+        const double decode = mb_per_second(num_bytes, iterations, [&] { h2b(hex); });
+        const double decode_rev = mb_per_second(num_bytes, iterations, [&] { h2b_rev(hex); });
+        const double decode_buff = mb_per_second(num_bytes, iterations, [&] { h2b(hex, bytes_buff); });
+
+        std::cout << num_bytes << " bytes (MB/s):" << std::endl
+                  << "  encode: wally " << wally_encode << ", b2h " << encode << ", b2h_rev " << encode_rev
+                  << ", b2h (buffer) " << encode_buff << std::endl
+                  << "  decode: wally " << wally_decode << ", h2b " << decode << ", h2b_rev " << decode_rev
+                  << ", h2b (buffer) " << decode_buff << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,112 @@
+#include "src/assertion.hpp"
+#include "src/containers.hpp"
+#include "src/ga_wally.hpp"
+#include "src/network_parameters.hpp"
+#include "src/transaction_utils.hpp"
+#include "src/utils.hpp"
+#include <chrono>
+#include <iostream>
+
+using namespace ga::sdk;
+
+// Time parsing many recipients from per-recipient addressees as compared to
+// payouts parsed in bulk, then adding their outputs and tracking the tx size.
+// This is a micro-benchmark of those steps only: create_ga_transaction_impl
+// needs a logged in session for UTXOs, fees and change, so the fee loop here
+// is a simplified stand in and the timings are not those of create_transaction.
+
+namespace {
+static const amount DUST_THRESHOLD(546);
+static const size_t FEE_LOOP_ITERATIONS = 4;
+
+static std::vector<std::string> make_addresses(const network_parameters& net_params, size_t num_outputs)
+{
+    std::vector<std::string> addresses;
+    for (size_t i = 0; i < num_outputs; ++i) {
+        std::vector<unsigned char> addr_bytes{ net_params.btc_version() };
+        const auto hash160 = get_fast_random_bytes<HASH160_LEN>();
+        addr_bytes.insert(addr_bytes.end(), hash160.begin(), hash160.end());
+        addresses.emplace_back(base58check_from_bytes(addr_bytes));
+    }
+    return addresses;
+}
+
+static wally_tx_ptr make_tx(size_t num_outputs)
+{
+    auto tx = tx_init(0, 1, num_outputs + 1);
+    const std::vector<unsigned char> txhash(WALLY_TXHASH_LEN, 1);
+    tx_add_raw_input(tx, txhash, 0, 0xFFFFFFFD, std::vector<unsigned char>(107, 0)); // P2PKH
+    return tx;
+}
+
+// Add the recipients outputs, then update the size and fee info as a fixed
+// number of inputs are added, approximating create_transaction's fee loop
+static void build_tx(
+    const network_parameters& net_params, const std::vector<tx_payout>& payouts, nlohmann::json& result)
+{
+    auto tx = make_tx(payouts.size());
+    tx_size_tracker size_tracker;
+    for (const auto& payout : payouts) {
+        add_tx_output(net_params, tx, payout.script, payout.satoshi, payout.asset_id);
+    }
+    const std::vector<unsigned char> txhash(WALLY_TXHASH_LEN, 2);
+    for (size_t i = 0; i < FEE_LOOP_ITERATIONS; ++i) {
+        tx_add_raw_input(tx, txhash, i, 0xFFFFFFFD, std::vector<unsigned char>(107, 0));
+        update_tx_info(net_params, tx, size_tracker, result);
+    }
+    update_tx_size_info(net_params, tx, result);
+}
+
+static double build_from_addressees(const network_parameters& net_params, const std::vector<std::string>& addresses)
+{
+    nlohmann::json result;
+    for (const auto& address : addresses) {
+        result["addressees"].push_back({ { "address", address }, { "satoshi", 100000 } });
+    }
+    // As session.convert_amount does, with a fiat rate set
+    const auto convert_amount = [](const nlohmann::json& amount_json) {
+        return amount::convert(amount_json, "USD", "30000.00");
+    };
+
+    const auto start = std::chrono::steady_clock::now();
+    for (auto& addressee : result["addressees"]) {
+        validate_tx_addressee(net_params, result, addressee);
+    }
+    std::vector<tx_payout> payouts;
+    payouts.reserve(addresses.size());
+    for (auto& addressee : result["addressees"]) {
+        payouts.emplace_back(parse_tx_addressee(net_params, DUST_THRESHOLD, convert_amount, result, addressee));
+    }
+    build_tx(net_params, payouts, result);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    GDK_RUNTIME_ASSERT(json_get_value(result, "error").empty());
+    return elapsed.count();
+}
+
+static double build_from_payouts(const network_parameters& net_params, const std::vector<std::string>& addresses)
+{
+    nlohmann::json result;
+    for (const auto& address : addresses) {
+        result["payouts"].push_back({ { "address", address }, { "satoshi", 100000 } });
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    build_tx(net_params, parse_tx_payouts(net_params, DUST_THRESHOLD, result), result);
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    GDK_RUNTIME_ASSERT(json_get_value(result, "error").empty());
+    return elapsed.count();
+}
+} // namespace
+
+int main()
+{
+    const network_parameters net_params{ network_parameters::get("testnet") };
+    for (const size_t num_outputs : { 100u, 500u, 1000u }) {
+        const auto addresses = make_addresses(net_params, num_outputs);
+        const double addressees_elapsed = build_from_addressees(net_params, addresses);
+        const double payouts_elapsed = build_from_payouts(net_params, addresses);
+        std::cout << num_outputs << " outputs: addressees " << static_cast<uint64_t>(addressees_elapsed * 1000000)
+                  << "us, payouts " << static_cast<uint64_t>(payouts_elapsed * 1000000) << "us" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "src/utils.hpp"
+#include <chrono>
+#include <iostream>
+
+using namespace ga::sdk;
+
+// Compare the cost of generating the random values that blinding needs for
+// each output of a Liquid tx, from the strong mixing path and from the
+// per-thread fast path. Each blinded output requires an abf, a vbf, an
+// ephemeral key and a surjection proof seed. Only the random generation is
+// timed here; benchmark_blind times blinding itself.
+
+namespace {
+using rng_fn = void (*)(std::size_t, void*, std::size_t);
+
+static double output_randomness(rng_fn rng, size_t num_txs, size_t num_outputs)
+{
+    std::array<unsigned char, 32> buff;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t tx = 0; tx < num_txs; ++tx) {
+        for (size_t i = 0; i < num_outputs; ++i) {
+            rng(buff.size(), buff.data(), buff.size()); // abf
+            rng(buff.size(), buff.data(), buff.size()); // vbf
+            do {
+                rng(buff.size(), buff.data(), buff.size()); // ephemeral key
+            } while (!ec_private_key_verify(buff));
+            rng(buff.size(), buff.data(), buff.size()); // surjection proof seed
+        }
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return num_txs * num_outputs / elapsed.count();
+}
+} // namespace
+
+int main()
+{
+    constexpr size_t num_txs = 100;
+    for (const size_t num_outputs : { 10u, 100u, 1000u }) {
+        const double strong = output_randomness(get_random_bytes, num_txs, num_outputs);
+        const double fast = output_randomness(get_fast_random_bytes, num_txs, num_outputs);
+        std::cout << num_outputs << " outputs: strong " << static_cast<uint64_t>(strong) << " outputs/s, fast "
+                  << static_cast<uint64_t>(fast) << " outputs/s (" << fast / strong << "x)" << std::endl;
+    }
+    return 0;
+}
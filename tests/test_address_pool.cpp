@@ -0,0 +1,131 @@
+#include "src/address_pool.hpp"
+#include "src/assertion.hpp"
+#include <stdio.h>
+#include <string>
+
+// Test the receive address pools hand out addresses in the order they were
+// fetched, request refills at the right time, and discard addresses which
+// became invalid while being fetched.
+
+using namespace ga::sdk;
+
+namespace {
+static const uint32_t POOL_SIZE = 4;
+static const address_pool::key_t P2WSH_KEY{ 1, "p2wsh" };
+static const address_pool::key_t CSV_KEY{ 1, "csv" };
+
+static nlohmann::json make_addresses(const address_pool::key_t& key, uint32_t first, uint32_t count)
+{
+    nlohmann::json addresses = nlohmann::json::array();
+    for (uint32_t pointer = first; pointer < first + count; ++pointer) {
+        addresses.push_back(
+            { { "subaccount", key.first }, { "address_type", key.second }, { "pointer", pointer } });
+    }
+    return addresses;
+}
+
+static uint32_t take_pointer(address_pool& pool, const address_pool::key_t& key, uint32_t& refill_count)
+{
+    const auto address = pool.take(key, POOL_SIZE, refill_count);
+    GDK_RUNTIME_ASSERT(address.at("address_type") == key.second);
+    return address.at("pointer");
+}
+
+static void test_take_and_refill()
+{
+    address_pool pool;
+    uint32_t refill_count = 1;
+
+    // An empty pool returns nothing and starts a refill of the whole pool
+    GDK_RUNTIME_ASSERT(pool.take(P2WSH_KEY, POOL_SIZE, refill_count).is_null() && refill_count == POOL_SIZE);
+
+    // Other callers finding the pool empty while it is refilled don't refill it too
+    GDK_RUNTIME_ASSERT(pool.take(P2WSH_KEY, POOL_SIZE, refill_count).is_null() && refill_count == 0);
+
+    // Addresses are handed out in the order they were added
+    pool.refill_done(P2WSH_KEY);
+    pool.add(P2WSH_KEY, make_addresses(P2WSH_KEY, 1, POOL_SIZE), pool.epoch(P2WSH_KEY));
+    GDK_RUNTIME_ASSERT(pool.size(P2WSH_KEY) == POOL_SIZE && pool.size(CSV_KEY) == 0);
+    GDK_RUNTIME_ASSERT(take_pointer(pool, P2WSH_KEY, refill_count) == 1 && refill_count == 0);
+
+    // Falling to half the pool size starts a refill to top it back up
+    GDK_RUNTIME_ASSERT(take_pointer(pool, P2WSH_KEY, refill_count) == 2 && refill_count == POOL_SIZE / 2);
+
+    // Only one refill runs at a time
+    GDK_RUNTIME_ASSERT(take_pointer(pool, P2WSH_KEY, refill_count) == 3 && refill_count == 0);
+
+    // Refilled addresses follow those already pooled
+    const uint64_t epoch = pool.epoch(P2WSH_KEY);
+    pool.refill_done(P2WSH_KEY);
+    pool.add(P2WSH_KEY, make_addresses(P2WSH_KEY, 5, POOL_SIZE / 2), epoch);
+    GDK_RUNTIME_ASSERT(pool.size(P2WSH_KEY) == 3);
+
+    // Once the refill is done, another can start
+    GDK_RUNTIME_ASSERT(take_pointer(pool, P2WSH_KEY, refill_count) == 4 && refill_count == POOL_SIZE / 2);
+    GDK_RUNTIME_ASSERT(take_pointer(pool, P2WSH_KEY, refill_count) == 5 && refill_count == 0);
+    GDK_RUNTIME_ASSERT(take_pointer(pool, P2WSH_KEY, refill_count) == 6 && refill_count == 0);
+    GDK_RUNTIME_ASSERT(pool.take(P2WSH_KEY, POOL_SIZE, refill_count).is_null() && refill_count == 0);
+}
+
+static void test_clear()
+{
+    address_pool pool;
+    uint32_t refill_count;
+    pool.add(P2WSH_KEY, make_addresses(P2WSH_KEY, 1, POOL_SIZE), pool.epoch(P2WSH_KEY));
+    pool.add(CSV_KEY, make_addresses(CSV_KEY, 1, POOL_SIZE), pool.epoch(CSV_KEY));
+
+    // Clearing one address type leaves the others pooled and able to refill
+    const uint64_t p2wsh_epoch = pool.epoch(P2WSH_KEY);
+    const uint64_t csv_epoch = pool.epoch(CSV_KEY);
+    pool.clear("csv");
+    GDK_RUNTIME_ASSERT(pool.size(CSV_KEY) == 0 && pool.size(P2WSH_KEY) == POOL_SIZE);
+    GDK_RUNTIME_ASSERT(pool.epoch(P2WSH_KEY) == p2wsh_epoch && pool.epoch(CSV_KEY) != csv_epoch);
+    GDK_RUNTIME_ASSERT(take_pointer(pool, P2WSH_KEY, refill_count) == 1);
+
+    // Addresses fetched before their pool was cleared are discarded
+    pool.add(CSV_KEY, make_addresses(CSV_KEY, 5, 1), csv_epoch);
+    GDK_RUNTIME_ASSERT(pool.size(CSV_KEY) == 0);
+    pool.add(P2WSH_KEY, make_addresses(P2WSH_KEY, 5, 1), p2wsh_epoch);
+    GDK_RUNTIME_ASSERT(pool.size(P2WSH_KEY) == POOL_SIZE);
+
+    // Clearing everything invalidates all in-flight fetches
+    const uint64_t epoch = pool.epoch(P2WSH_KEY);
+    pool.clear();
+    GDK_RUNTIME_ASSERT(pool.size(P2WSH_KEY) == 0 && pool.get_all().empty());
+    pool.add(P2WSH_KEY, make_addresses(P2WSH_KEY, 6, 1), epoch);
+    GDK_RUNTIME_ASSERT(pool.size(P2WSH_KEY) == 0);
+    pool.add(CSV_KEY, make_addresses(CSV_KEY, 6, 1), csv_epoch);
+    GDK_RUNTIME_ASSERT(pool.size(CSV_KEY) == 0);
+}
+
+static void test_save_and_restore()
+{
+    address_pool pool;
+    uint32_t refill_count;
+    pool.add(P2WSH_KEY, make_addresses(P2WSH_KEY, 1, POOL_SIZE), pool.epoch(P2WSH_KEY));
+    pool.add(CSV_KEY, make_addresses(CSV_KEY, 1, 1), pool.epoch(CSV_KEY));
+    GDK_RUNTIME_ASSERT(take_pointer(pool, CSV_KEY, refill_count) == 1);
+
+    // Only non-empty pools are saved
+    const auto saved = pool.get_all();
+    GDK_RUNTIME_ASSERT(saved.size() == 1);
+
+    // Restored addresses are handed out before any fetched since
+    address_pool restored;
+    restored.add(P2WSH_KEY, make_addresses(P2WSH_KEY, 5, 1), restored.epoch(P2WSH_KEY));
+    restored.restore(nlohmann::json::from_msgpack(nlohmann::json::to_msgpack(saved)));
+    GDK_RUNTIME_ASSERT(restored.size(P2WSH_KEY) == POOL_SIZE + 1 && restored.size(CSV_KEY) == 0);
+    for (uint32_t pointer = 1; pointer <= POOL_SIZE + 1; ++pointer) {
+        GDK_RUNTIME_ASSERT(take_pointer(restored, P2WSH_KEY, refill_count) == pointer);
+    }
+}
+} // namespace
+
+int main()
+{
+    test_take_and_refill();
+    test_clear();
+    test_save_and_restore();
+    printf("address pool ok\n");
+    return 0;
+}
@@ -0,0 +1,254 @@
+#include "src/amount.hpp"
+#include "src/assertion.hpp"
+#include "src/boost_wrapper.hpp"
+#include "src/exception.hpp"
+#include "src/ga_strings.hpp"
+#include "include/wally_wrapper.h"
+#include <nlohmann/json.hpp>
+#include <random>
+#include <stdio.h>
+
+// Differential test of amount::convert against a reference implementation
+// using multiprecision decimal arithmetic throughout.
+
+using namespace ga::sdk;
+
+namespace {
+using btc_type = boost::multiprecision::number<boost::multiprecision::cpp_dec_float<8>>;
+using fiat_type = boost::multiprecision::number<boost::multiprecision::cpp_dec_float<2>>;
+using conversion_type = boost::multiprecision::number<boost::multiprecision::cpp_dec_float<15>>;
+
+static const int64_t SATOSHI_MAX = static_cast<int64_t>(WALLY_BTC_MAX) * WALLY_SATOSHI_PER_BTC;
+
+template <typename T> static std::string fmt(const T& fiat, size_t dp = 2)
+{
+    return fiat_type(fiat).str(dp, std::ios_base::fixed | std::ios_base::showpoint);
+}
+
+static nlohmann::json reference_convert(
+    const nlohmann::json& amount_json, const std::string& fiat_currency, const std::string& fiat_rate)
+{
+    const conversion_type COIN_VALUE_DECIMAL("100000000");
+    const conversion_type COIN_VALUE_DECIMAL_MBTC("100000");
+    const conversion_type COIN_VALUE_DECIMAL_UBTC("100");
+
+    const auto satoshi_p = amount_json.find("satoshi");
+    const auto btc_p = amount_json.find("btc");
+    const auto mbtc_p = amount_json.find("mbtc");
+    const auto ubtc_p = amount_json.find("ubtc");
+    const auto bits_p = amount_json.find("bits");
+    const auto sats_p = amount_json.find("sats");
+    const auto fiat_p = amount_json.find("fiat");
+    const bool have_asset_info = amount_json.contains("asset_info");
+    const auto asset_json = amount_json.value("asset_info", nlohmann::json::object());
+    const auto precision = asset_json.value("precision", 0);
+    const auto asset_id = asset_json.value("asset_id", "");
+    const auto asset_p = amount_json.find(asset_id);
+    const auto end_p = amount_json.end();
+    const int key_count = (satoshi_p != end_p) + (btc_p != end_p) + (mbtc_p != end_p) + (ubtc_p != end_p)
+        + (bits_p != end_p) + (sats_p != end_p) + (fiat_p != end_p) + (asset_p != end_p);
+
+    if (key_count != 1) {
+        throw user_error(res::id_no_amount_specified);
+    }
+
+    const std::string old_fiat_rate = amount_json.value("fiat_rate", std::string());
+    const std::string& fiat_rate_used(fiat_rate.empty() ? old_fiat_rate : fiat_rate);
+    const std::string old_fiat_ccy = amount_json.value("fiat_currency", std::string());
+    const std::string& fiat_ccy_used(fiat_currency.empty() ? old_fiat_ccy : fiat_currency);
+    const bool is_current = !fiat_rate.empty() && !fiat_currency.empty();
+
+    const conversion_type COIN_VALUE_WITH_PRECISION(std::pow(10, precision));
+    int64_t satoshi;
+
+    if (satoshi_p != end_p) {
+        satoshi = *satoshi_p;
+    } else if (btc_p != end_p) {
+        const std::string btc_str = *btc_p;
+        satoshi = (conversion_type(btc_str) * COIN_VALUE_DECIMAL).convert_to<amount::value_type>();
+    } else if (mbtc_p != end_p) {
+        const std::string mbtc_str = *mbtc_p;
+        satoshi = (conversion_type(mbtc_str) * COIN_VALUE_DECIMAL_MBTC).convert_to<amount::value_type>();
+    } else if (ubtc_p != end_p || bits_p != end_p) {
+        const std::string ubtc_str = *(ubtc_p == end_p ? bits_p : ubtc_p);
+        satoshi = (conversion_type(ubtc_str) * COIN_VALUE_DECIMAL_UBTC).convert_to<amount::value_type>();
+    } else if (sats_p != end_p) {
+        const std::string sats_str = *sats_p;
+        satoshi = (conversion_type(sats_str)).convert_to<amount::value_type>();
+    } else if (asset_p != end_p) {
+        const std::string asset_str = *asset_p;
+        satoshi = (conversion_type(asset_str) * COIN_VALUE_WITH_PRECISION).convert_to<amount::value_type>();
+    } else {
+        if (fiat_rate_used.empty()) {
+            throw user_error(res::id_your_favourite_exchange_rate_is);
+        }
+        const std::string fiat_str = *fiat_p;
+        const conversion_type btc_decimal = conversion_type(fiat_str) / conversion_type(fiat_rate_used);
+        satoshi = (btc_type(btc_decimal) * COIN_VALUE_DECIMAL).convert_to<amount::value_type>();
+    }
+    if (satoshi < 0) {
+        throw user_error(res::id_invalid_amount);
+    }
+    if (asset_p == end_p && satoshi > SATOSHI_MAX) {
+        throw user_error(res::id_invalid_amount);
+    }
+
+    const conversion_type satoshi_conv = conversion_type(satoshi);
+    const std::string btc = fmt(btc_type(satoshi_conv / COIN_VALUE_DECIMAL), 8);
+    const std::string mbtc = fmt(btc_type(satoshi_conv / COIN_VALUE_DECIMAL_MBTC), 5);
+    const std::string ubtc = fmt(btc_type(satoshi_conv / COIN_VALUE_DECIMAL_UBTC), 2);
+    const std::string sats = std::to_string(satoshi);
+
+    nlohmann::json result = { { "satoshi", satoshi }, { "btc", btc }, { "mbtc", mbtc }, { "ubtc", ubtc },
+        { "bits", ubtc }, { "sats", sats }, { "fiat", nullptr }, { "fiat_currency", fiat_ccy_used },
+        { "fiat_rate", nullptr }, { "is_current", is_current } };
+
+    if (!fiat_rate_used.empty()) {
+        result["fiat_rate"] = fiat_rate_used;
+        result["fiat"]
+            = fmt(fiat_type(conversion_type(fiat_rate_used) * conversion_type(satoshi) / COIN_VALUE_DECIMAL));
+    }
+
+    if (have_asset_info) {
+        if (precision == 0) {
+            result[asset_id] = sats;
+        } else {
+            result[asset_id] = fmt(btc_type(satoshi_conv / COIN_VALUE_WITH_PRECISION), precision);
+        }
+    }
+    return result;
+}
+
+static std::mt19937_64 rng(12345);
+
+static uint64_t random_uint(uint64_t max) { return std::uniform_int_distribution<uint64_t>(0, max)(rng); }
+
+// A random value, biased towards small values and boundaries
+static int64_t random_satoshi(bool is_asset)
+{
+    const int64_t max = is_asset ? std::numeric_limits<int64_t>::max() : SATOSHI_MAX;
+    switch (random_uint(5)) {
+    case 0:
+        return random_uint(1000);
+    case 1:
+        return max - static_cast<int64_t>(random_uint(1000));
+    case 2:
+        return random_uint(max);
+    default:
+        return std::min<int64_t>(max, random_uint(std::pow(10, random_uint(16))));
+    }
+}
+
+static std::string random_digits(size_t n)
+{
+    std::string s;
+    for (size_t i = 0; i < n; ++i) {
+        s.push_back('0' + random_uint(9));
+    }
+    return s;
+}
+
+// A random decimal string, occasionally in a form the integer code rejects
+static std::string random_decimal()
+{
+    static const std::vector<std::string> unusual = { "", ".", "1.", ".5", "-1", "-0.5", "+1", "1e-3", "1E8", " 1",
+        "1 ", "0x10", "abc", "1.2.3", "0.000000000000000000001", "99999999999999999999", "123456789.123456789123" };
+    if (random_uint(20) == 0) {
+        return unusual[random_uint(unusual.size() - 1)];
+    }
+    std::string s = random_digits(random_uint(1) ? 1 + random_uint(4) : 1 + random_uint(12));
+    const auto dp = random_uint(3) ? random_uint(10) : random_uint(22);
+    if (dp) {
+        s += "." + random_digits(dp);
+    }
+    return s;
+}
+
+static std::string random_rate()
+{
+    switch (random_uint(7)) {
+    case 0:
+        return std::string();
+    case 1:
+        return random_decimal();
+    default:
+        return std::to_string(random_uint(100000)) + "." + random_digits(random_uint(8));
+    }
+}
+
+static nlohmann::json random_amount()
+{
+    static const std::vector<std::string> keys = { "satoshi", "btc", "mbtc", "ubtc", "bits", "sats", "fiat" };
+    nlohmann::json amount_json;
+    const bool is_asset = random_uint(4) == 0;
+    if (is_asset) {
+        const int precision = random_uint(10) ? random_uint(8) : 19 + random_uint(2);
+        amount_json["asset_info"] = { { "asset_id", "asset" }, { "precision", precision } };
+    }
+    const auto& key = is_asset && random_uint(1) ? std::string("asset") : keys[random_uint(keys.size() - 1)];
+    if (key == "satoshi") {
+        const int64_t satoshi = random_satoshi(is_asset);
+        amount_json[key] = random_uint(100) ? satoshi : -satoshi;
+    } else {
+        amount_json[key] = random_decimal();
+    }
+    if (random_uint(3) == 0) {
+        amount_json["fiat_rate"] = random_rate();
+        amount_json["fiat_currency"] = "EUR";
+    }
+    return amount_json;
+}
+
+static nlohmann::json try_convert(bool reference, const nlohmann::json& amount_json, const std::string& fiat_rate)
+{
+    const std::string fiat_currency = fiat_rate.empty() ? std::string() : "USD";
+    try {
+        if (reference) {
+            return reference_convert(amount_json, fiat_currency, fiat_rate);
+        }
+        return amount::convert(amount_json, fiat_currency, fiat_rate);
+    } catch (const std::exception& e) {
+        return { { "error", e.what() } };
+    }
+}
+} // namespace
+
+int main()
+{
+    size_t num_errors = 0;
+    for (size_t i = 0; i < 200000; ++i) {
+        const auto amount_json = random_amount();
+        const auto fiat_rate = random_rate();
+        const auto expected = try_convert(true, amount_json, fiat_rate);
+        const auto actual = try_convert(false, amount_json, fiat_rate);
+        if (actual != expected) {
+            printf("input: %s rate: '%s'\nexpected: %s\nactual:   %s\n", amount_json.dump().c_str(),
+                fiat_rate.c_str(), expected.dump().c_str(), actual.dump().c_str());
+        }
+        GDK_RUNTIME_ASSERT(actual == expected);
+        num_errors += expected.contains("error");
+    }
+
+    // Converting selected denominations must match the full conversion
+    nlohmann::json amounts = nlohmann::json::array();
+    std::vector<nlohmann::json> results;
+    for (size_t i = 0; i < 1000; ++i) {
+        amounts.push_back({ { "satoshi", random_satoshi(false) } });
+        results.push_back(reference_convert(amounts.back(), "USD", "12345.67"));
+    }
+    nlohmann::json details = { { "satoshi", nlohmann::json::array() }, { "denominations", { "btc", "fiat", "sats" } } };
+    for (const auto& amount_json : amounts) {
+        details["satoshi"].push_back(amount_json["satoshi"]);
+    }
+    const auto converted = amount::convert_amounts(details, "USD", "12345.67");
+    GDK_RUNTIME_ASSERT(converted["fiat_rate"] == "12345.67" && converted["is_current"] == true);
+    GDK_RUNTIME_ASSERT(converted["amounts"].size() == amounts.size());
+    for (size_t i = 0; i < amounts.size(); ++i) {
+        const auto& c = converted["amounts"][i];
+        GDK_RUNTIME_ASSERT(c.size() == 3 && c["btc"] == results[i]["btc"] && c["fiat"] == results[i]["fiat"]
+            && c["sats"] == results[i]["sats"]);
+    }
+
+    printf("%zu of 200000 inputs correctly failed to convert\n", num_errors);
+    return 0;
+}
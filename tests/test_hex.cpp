@@ -0,0 +1,141 @@
+#include "src/assertion.hpp"
+#include "src/ga_wally.hpp"
+#include "src/hex.hpp"
+#include "src/utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Test the hex codecs against the libwally implementations, for every length
+// up to several vector blocks so that all block/tail splits are covered.
+
+using namespace ga::sdk;
+
+namespace {
+static const size_t MAX_LEN = 4 * 32 + 1; // Longer than multiple blocks for any vector size
+
+static std::string wally_encode(const std::vector<unsigned char>& bytes)
+{
+    if (bytes.empty()) {
+        return std::string(); // Avoid passing wally a null buffer
+    }
+    char* p;
+    GDK_VERIFY(wally_hex_from_bytes(bytes.data(), bytes.size(), &p));
+    std::string ret(p);
+    wally_free_string(p);
+    return ret;
+}
+
+// Returns true if wally accepts hex, setting bytes to the decoded result
+static bool wally_decode(const std::string& hex, std::vector<unsigned char>& bytes)
+{
+    bytes.resize(hex.size() / 2 + 1); // wally requires a non-empty buffer
+    size_t written;
+    if (wally_hex_to_bytes(hex.c_str(), bytes.data(), bytes.size(), &written) != WALLY_OK) {
+        return false;
+    }
+    bytes.resize(written);
+    return true;
+}
+
+static bool h2b_throws(const std::string& hex)
+{
+    try {
+        h2b(hex);
+    } catch (const std::exception&) {
+        return true;
+    }
+    return false;
+}
+
+static void test_round_trip(const std::vector<unsigned char>& bytes)
+{
+    const std::vector<unsigned char> reversed(bytes.rbegin(), bytes.rend());
+    const std::string hex = wally_encode(bytes);
+    GDK_RUNTIME_ASSERT(b2h(bytes) == hex);
+    GDK_RUNTIME_ASSERT(b2h_rev(reversed) == hex);
+
+    std::vector<char> hex_buff(bytes.size() * 2, 'x');
+    b2h(bytes, hex_buff);
+    GDK_RUNTIME_ASSERT(std::string(hex_buff.begin(), hex_buff.end()) == hex);
+
+    std::string upper = hex;
+    std::transform(upper.begin(), upper.end(), upper.begin(), [](char c) { return std::toupper(c); });
+
+    std::vector<unsigned char> decoded(bytes.size());
+    for (const auto& h : { hex, upper }) {
+        GDK_RUNTIME_ASSERT(hex_decode(h.data(), h.size(), decoded.data(), false) && decoded == bytes);
+        GDK_RUNTIME_ASSERT(hex_decode(h.data(), h.size(), decoded.data(), true) && decoded == reversed);
+        if (!bytes.empty()) {
+            std::vector<unsigned char> wally_bytes;
+            GDK_RUNTIME_ASSERT(wally_decode(h, wally_bytes) && wally_bytes == bytes);
+            GDK_RUNTIME_ASSERT(h2b(h) == bytes && h2b_rev(h) == reversed);
+        }
+    }
+}
+
+static void test_invalid(size_t len)
+{
+    const auto bytes = [len] {
+        std::vector<unsigned char> bytes(len);
+        get_fast_random_bytes(bytes.size(), bytes.data(), bytes.size());
+        return bytes;
+    }();
+    const std::string hex = b2h(bytes);
+    std::vector<unsigned char> decoded(len);
+
+    // Every invalid character must be detected, at any position
+    const std::string invalid_chars("gG /:@`~\x7f\x80\xff");
+    for (size_t pos = 0; pos < hex.size(); ++pos) {
+        for (const char c : invalid_chars) {
+            std::string bad = hex;
+            bad[pos] = c;
+            std::vector<unsigned char> wally_bytes;
+            GDK_RUNTIME_ASSERT(!wally_decode(bad, wally_bytes));
+            GDK_RUNTIME_ASSERT(!hex_decode(bad.data(), bad.size(), decoded.data(), false));
+            GDK_RUNTIME_ASSERT(!hex_decode(bad.data(), bad.size(), decoded.data(), true));
+            GDK_RUNTIME_ASSERT(h2b_throws(bad));
+        }
+    }
+
+    // Odd length input is rejected
+    const std::string odd = hex + "a";
+    std::vector<unsigned char> wally_bytes;
+    GDK_RUNTIME_ASSERT(!wally_decode(odd, wally_bytes));
+    GDK_RUNTIME_ASSERT(h2b_throws(odd));
+    GDK_RUNTIME_ASSERT(!validate_hex(odd, len));
+}
+} // namespace
+
+int main()
+{
+    // Empty input encodes to an empty string; decoding it is an error, as it
+    // was when decoding with wally
+    GDK_RUNTIME_ASSERT(b2h(std::vector<unsigned char>()).empty());
+    GDK_RUNTIME_ASSERT(h2b_throws(std::string()));
+    GDK_RUNTIME_ASSERT(hex_decode("", 0, nullptr, false));
+
+    for (size_t len = 0; len <= MAX_LEN; ++len) {
+        // All zeros and all ones check the extremes of each nibble
+        test_round_trip(std::vector<unsigned char>(len, 0));
+        test_round_trip(std::vector<unsigned char>(len, 0xff));
+        for (size_t i = 0; i < 8; ++i) {
+            std::vector<unsigned char> bytes(len);
+            get_fast_random_bytes(bytes.size(), bytes.data(), bytes.size());
+            test_round_trip(bytes);
+        }
+        test_invalid(len);
+    }
+
+    // Every byte value round trips
+    std::vector<unsigned char> all_bytes(256);
+    for (size_t i = 0; i < all_bytes.size(); ++i) {
+        all_bytes[i] = static_cast<unsigned char>(i);
+    }
+    test_round_trip(all_bytes);
+
+    printf("hex codec ok\n");
+    return 0;
+}
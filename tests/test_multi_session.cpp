@@ -1,14 +1,45 @@
 #include "src/network_parameters.hpp"
 #include "src/session.hpp"
 #include <assert.h>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string>
+#include <vector>
 
-int main()
+// Connect a number of sessions in one process and report the time taken and
+// the number of threads used. Usage: test_multi_session [num_sessions] [shared]
+// If "shared" is given, sessions share the process-wide executor.
+
+namespace {
+static int num_threads()
+{
+    // Linux only, returns -1 elsewhere
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 8, "Threads:") == 0) {
+            return std::stoi(line.substr(8));
+        }
+    }
+    return -1;
+}
+} // namespace
+
+int main(int argc, char** argv)
 {
+    const size_t num_sessions = argc > 1 ? std::stoul(argv[1]) : 2;
+    const bool shared = argc > 2 && std::string(argv[2]) == "shared";
+
     nlohmann::json init_config;
     init_config["datadir"] = ".";
+    if (shared) {
+        init_config["executor"] = { { "shared", true } };
+    }
 
     nlohmann::json net_params;
     net_params["log_level"] = "debug";
@@ -16,11 +47,25 @@ int main()
     // net_params["proxy"] = "localhost:9050";
     net_params["name"] = "testnet";
 
+    // Count threads before init, which starts the shared executor's threads
+    const int initial_threads = num_threads();
     ga::sdk::init(init_config);
     {
-        ga::sdk::session session;
-        session.connect(net_params);
-        ga::sdk::session session2;
-        session2.connect(net_params);
+        const auto start = std::chrono::steady_clock::now();
+
+        std::vector<std::unique_ptr<ga::sdk::session>> sessions;
+        for (size_t i = 0; i < num_sessions; ++i) {
+            sessions.emplace_back(new ga::sdk::session());
+            sessions.back()->connect(net_params);
+        }
+        const std::chrono::duration<double> connect_time = std::chrono::steady_clock::now() - start;
+        const int connected_threads = num_threads();
+
+        sessions.clear();
+        const std::chrono::duration<double> total_time = std::chrono::steady_clock::now() - start;
+
+        std::cout << num_sessions << " sessions (" << (shared ? "shared" : "per-session") << " executor): connect "
+                  << connect_time.count() << "s, destroy " << (total_time - connect_time).count() << "s, "
+                  << connected_threads - initial_threads << " extra threads" << std::endl;
     }
 }
@@ -0,0 +1,122 @@
+#include "src/assertion.hpp"
+#include "src/notifications.hpp"
+#include <atomic>
+#include <nlohmann/json.hpp>
+#include <thread>
+#include <vector>
+
+// Tests for tx notification deduplication and batched notification delivery
+
+using namespace ga::sdk;
+
+namespace {
+static nlohmann::json tx_notification(const std::string& txhash, const std::string& value)
+{
+    return { { "subaccounts", { 0u, 1u } }, { "txhash", txhash }, { "value", value } };
+}
+
+static nlohmann::json event(const std::string& name, uint32_t n) { return { { "event", name }, { name, n } }; }
+
+static void test_tx_notification_filter()
+{
+    using clock = tx_notification_filter::clock;
+    tx_notification_filter filter(std::chrono::seconds(60), 3);
+    const auto t0 = clock::now();
+
+    GDK_RUNTIME_ASSERT(filter.insert(tx_notification("aa", "-5"), t0));
+    GDK_RUNTIME_ASSERT(!filter.insert(tx_notification("aa", "-5"), t0));
+    GDK_RUNTIME_ASSERT(filter.insert(tx_notification("aa", "5"), t0)); // Different value
+    auto other_subaccounts = tx_notification("aa", "-5");
+    other_subaccounts["subaccounts"] = { 1u };
+    GDK_RUNTIME_ASSERT(filter.insert(other_subaccounts, t0));
+
+    // Entries expire after the window
+    GDK_RUNTIME_ASSERT(filter.insert(tx_notification("aa", "-5"), t0 + std::chrono::seconds(61)));
+
+    // The oldest entries are evicted once full
+    for (const auto& txhash : { "bb", "cc", "dd" }) {
+        GDK_RUNTIME_ASSERT(filter.insert(tx_notification(txhash, "1"), t0 + std::chrono::seconds(62)));
+    }
+    GDK_RUNTIME_ASSERT(filter.insert(tx_notification("aa", "-5"), t0 + std::chrono::seconds(62)));
+
+    filter.clear();
+    GDK_RUNTIME_ASSERT(filter.insert(tx_notification("dd", "1"), t0 + std::chrono::seconds(62)));
+}
+
+static void test_notification_queue_coalescing()
+{
+    notification_queue queue(4);
+
+    GDK_RUNTIME_ASSERT(queue.push(event("block", 1))); // Caller must deliver
+    GDK_RUNTIME_ASSERT(!queue.push(event("transaction", 1))); // Already delivering
+    GDK_RUNTIME_ASSERT(!queue.push(event("block", 2))); // Supersedes block 1
+    GDK_RUNTIME_ASSERT(!queue.push(event("ticker", 1)));
+
+    auto batch = queue.pop_batch();
+    const nlohmann::json expected = { event("transaction", 1), event("block", 2), event("ticker", 1) };
+    GDK_RUNTIME_ASSERT(batch["notifications"] == expected);
+    GDK_RUNTIME_ASSERT(batch["coalesced"] == 1 && batch["dropped"] == 0);
+
+    // Empty queue ends delivery, so the next push must deliver again
+    GDK_RUNTIME_ASSERT(queue.pop_batch().is_null());
+    GDK_RUNTIME_ASSERT(queue.push(event("transaction", 2)));
+
+    // The oldest notifications are dropped once full
+    for (uint32_t i = 3; i < 8; ++i) {
+        GDK_RUNTIME_ASSERT(!queue.push(event("transaction", i)));
+    }
+    batch = queue.pop_batch();
+    GDK_RUNTIME_ASSERT(batch["notifications"].size() == 4);
+    GDK_RUNTIME_ASSERT(batch["notifications"][0] == event("transaction", 4));
+    GDK_RUNTIME_ASSERT(batch["coalesced"] == 0 && batch["dropped"] == 2);
+    GDK_RUNTIME_ASSERT(queue.pop_batch().is_null());
+}
+
+static void test_notification_queue_concurrent()
+{
+    // Many producers, with whichever finds the queue idle delivering.
+    // Every notification must be delivered exactly once, in order per producer
+    constexpr uint32_t num_threads = 8;
+    constexpr uint32_t num_per_thread = 10000;
+    notification_queue queue(num_threads * num_per_thread);
+    std::atomic<uint32_t> delivering{ 0 };
+    std::vector<uint32_t> last_seen(num_threads, 0);
+    std::atomic<uint32_t> delivered{ 0 };
+
+    auto producer = [&](uint32_t id) {
+        for (uint32_t i = 1; i <= num_per_thread; ++i) {
+            if (!queue.push({ { "event", "transaction" }, { "id", id }, { "n", i } })) {
+                continue;
+            }
+            for (auto batch = queue.pop_batch(); !batch.is_null(); batch = queue.pop_batch()) {
+                GDK_RUNTIME_ASSERT(++delivering == 1); // Only one deliverer at a time
+                for (const auto& n : batch["notifications"]) {
+                    const uint32_t from = n["id"];
+                    const uint32_t seq = n["n"];
+                    GDK_RUNTIME_ASSERT(seq == last_seen[from] + 1);
+                    last_seen[from] = seq;
+                    ++delivered;
+                }
+                --delivering;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (uint32_t id = 0; id < num_threads; ++id) {
+        threads.emplace_back(producer, id);
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    GDK_RUNTIME_ASSERT(delivered == num_threads * num_per_thread);
+}
+} // namespace
+
+int main()
+{
+    test_tx_notification_filter();
+    test_notification_queue_coalescing();
+    test_notification_queue_concurrent();
+    return 0;
+}
@@ -0,0 +1,131 @@
+#include "src/assertion.hpp"
+#include "src/executor.hpp"
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <cstdint>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Test parallel_for splits its items into non-overlapping ranges covering
+// every item, runs small workloads on the calling thread, and rethrows
+// exceptions thrown by any of its calls.
+
+using namespace ga::sdk;
+
+namespace {
+using range_t = std::pair<size_t, size_t>;
+
+static std::vector<range_t> run(size_t n, size_t min_per_thread, size_t throw_at = SIZE_MAX)
+{
+    std::mutex mutex;
+    std::vector<range_t> ranges;
+    const auto caller_id = std::this_thread::get_id();
+    parallel_for(n, min_per_thread, [&](size_t begin, size_t end) {
+        {
+            std::lock_guard<std::mutex> _(mutex);
+            ranges.emplace_back(begin, end);
+        }
+        // The first range is always run by the calling thread
+        GDK_RUNTIME_ASSERT((begin == 0) == (std::this_thread::get_id() == caller_id));
+        if (throw_at >= begin && throw_at < end) {
+            throw std::runtime_error("item " + std::to_string(throw_at));
+        }
+    });
+    std::sort(ranges.begin(), ranges.end());
+    return ranges;
+}
+
+// Check the ranges are non-empty and cover [0, n) exactly once
+static void check_coverage(const std::vector<range_t>& ranges, size_t n)
+{
+    size_t next = 0;
+    for (const auto& range : ranges) {
+        GDK_RUNTIME_ASSERT(range.first == next && range.second > range.first);
+        next = range.second;
+    }
+    GDK_RUNTIME_ASSERT(next == n);
+}
+
+static void test_single_thread()
+{
+    // No items: fn is never called
+    GDK_RUNTIME_ASSERT(run(0, 1).empty());
+    GDK_RUNTIME_ASSERT(run(0, 32).empty());
+
+    // Fewer than 2 threads worth of items: one call on the calling thread
+    for (size_t n = 1; n < 64; ++n) {
+        const auto ranges = run(n, 32);
+        GDK_RUNTIME_ASSERT(ranges.size() == 1 && ranges[0] == range_t(0, n));
+    }
+
+    // min_per_thread must be non-zero
+    bool threw = false;
+    try {
+        run(10, 0);
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    GDK_RUNTIME_ASSERT(threw);
+}
+
+static void test_partitioning()
+{
+    const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t min_per_thread : { 1, 2, 3, 32 }) {
+        // Cover counts around every split, including those not evenly divisible
+        for (size_t n = 1; n <= 4 * max_threads * min_per_thread + 1; ++n) {
+            const auto ranges = run(n, min_per_thread);
+            check_coverage(ranges, n);
+            GDK_RUNTIME_ASSERT(ranges.size() <= std::max<size_t>(1, std::min(max_threads, n / min_per_thread)));
+        }
+    }
+}
+
+static void test_exceptions()
+{
+    const size_t max_threads = std::max(1u, std::thread::hardware_concurrency());
+    const size_t n = max_threads * 4;
+    for (size_t throw_at : { size_t(0), n / 2, n - 1 }) {
+        std::string what;
+        try {
+            run(n, 1, throw_at);
+        } catch (const std::runtime_error& e) {
+            what = e.what();
+        }
+        // The exception from the call processing throw_at is rethrown,
+        // whichever thread it was thrown from
+        GDK_RUNTIME_ASSERT(what == "item " + std::to_string(throw_at));
+    }
+
+    // All calls complete before the exception is rethrown
+    std::mutex mutex;
+    std::vector<range_t> ranges;
+    try {
+        parallel_for(n, 1, [&](size_t begin, size_t end) {
+            {
+                std::lock_guard<std::mutex> _(mutex);
+                ranges.emplace_back(begin, end);
+            }
+            if (begin != 0) {
+                throw std::runtime_error("worker");
+            }
+        });
+    } catch (const std::runtime_error&) {
+    }
+    std::sort(ranges.begin(), ranges.end());
+    check_coverage(ranges, n);
+}
+} // namespace
+
+int main()
+{
+    test_single_thread();
+    test_partitioning();
+    test_exceptions();
+    printf("parallel_for ok\n");
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include "src/assertion.hpp"
+#include "src/ga_wally.hpp"
+#include "src/network_parameters.hpp"
+#include "src/script_cache.hpp"
+#include "src/transaction_utils.hpp"
+#include "src/xpub_hdkey.hpp"
+#include <array>
+#include <stdio.h>
+#include <vector>
+
+// Test the multisig script cache returns the same scripts as deriving them
+// directly, keeps entries for different UTXOs apart, and drops entries when
+// invalidated.
+
+using namespace ga::sdk;
+
+namespace {
+static const std::string CHAIN_CODE(std::string(63, '0') + "1");
+static const std::string USER_PUBKEY("0279be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798");
+static const std::string RECOVERY_PUBKEY("02c6047f9441ed7d6d3045406e95c07cd85c778e4b8cef3ca7abac09b95c709ee5");
+
+static nlohmann::json make_utxo(uint32_t subaccount, uint32_t pointer, script_type type, uint32_t subtype = 0)
+{
+    nlohmann::json utxo = { { "subaccount", subaccount }, { "pointer", pointer }, { "script_type", type } };
+    if (type == script_type::ga_p2sh_p2wsh_csv_fortified_out) {
+        utxo["subtype"] = subtype;
+    }
+    return utxo;
+}
+
+static script_cache::entry make_dummy_entry(unsigned char id) { return script_cache::entry{ { id }, {} }; }
+
+static bool has_dummy_entry(const network_parameters& net_params, script_cache& cache, const nlohmann::json& utxo,
+    unsigned char id)
+{
+    const auto cached = cache.find(net_params, utxo);
+    return cached && cached->script == std::vector<unsigned char>{ id };
+}
+
+static void test_keys(const network_parameters& net_params)
+{
+    script_cache cache;
+    const uint32_t csv_blocks = net_params.csv_buckets().at(0);
+    const auto base = make_utxo(1, 5, script_type::ga_p2sh_p2wsh_fortified_out);
+
+    // Each differing component of the key identifies a separate entry
+    const std::vector<nlohmann::json> utxos{ base, make_utxo(2, 5, script_type::ga_p2sh_p2wsh_fortified_out),
+        make_utxo(1, 6, script_type::ga_p2sh_p2wsh_fortified_out),
+        make_utxo(1, 5, script_type::ga_p2sh_fortified_out),
+        make_utxo(1, 5, script_type::ga_p2sh_p2wsh_csv_fortified_out, csv_blocks) };
+    for (unsigned char i = 0; i < utxos.size(); ++i) {
+        GDK_RUNTIME_ASSERT(cache.find(net_params, utxos[i]) == nullptr);
+        cache.insert(net_params, utxos[i], make_dummy_entry(i));
+    }
+    GDK_RUNTIME_ASSERT(cache.size() == utxos.size());
+    for (unsigned char i = 0; i < utxos.size(); ++i) {
+        GDK_RUNTIME_ASSERT(has_dummy_entry(net_params, cache, utxos[i], i));
+    }
+
+    // A missing subaccount is the main account, and other fields are ignored
+    auto main_account = base;
+    main_account.erase("subaccount");
+    GDK_RUNTIME_ASSERT(cache.find(net_params, main_account) == nullptr);
+    main_account["subaccount"] = 0;
+    cache.insert(net_params, main_account, make_dummy_entry(9));
+    main_account.erase("subaccount");
+    main_account["txhash"] = std::string(64, '0');
+    GDK_RUNTIME_ASSERT(has_dummy_entry(net_params, cache, main_account, 9));
+
+    // Invalidating a subaccount leaves the others cached
+    const uint64_t generation = cache.generation();
+    cache.invalidate(1);
+    GDK_RUNTIME_ASSERT(cache.generation() != generation);
+    GDK_RUNTIME_ASSERT(cache.size() == 2);
+    GDK_RUNTIME_ASSERT(cache.find(net_params, base) == nullptr);
+    GDK_RUNTIME_ASSERT(has_dummy_entry(net_params, cache, utxos[1], 1));
+    GDK_RUNTIME_ASSERT(has_dummy_entry(net_params, cache, main_account, 9));
+
+    // Including the highest possible subaccount
+    const auto last = make_utxo(0xffffffff, 5, script_type::ga_p2sh_p2wsh_fortified_out);
+    cache.insert(net_params, last, make_dummy_entry(10));
+    cache.invalidate(0xffffffff);
+    GDK_RUNTIME_ASSERT(cache.find(net_params, last) == nullptr && cache.size() == 2);
+
+    cache.clear();
+    GDK_RUNTIME_ASSERT(cache.size() == 0 && cache.find(net_params, utxos[1]) == nullptr);
+}
+
+static void test_limit(const network_parameters& net_params)
+{
+    // Reaching the size limit starts the cache again
+    script_cache cache(3);
+    for (uint32_t pointer = 1; pointer <= 4; ++pointer) {
+        const auto utxo = make_utxo(0, pointer, script_type::ga_p2sh_p2wsh_fortified_out);
+        cache.insert(net_params, utxo, make_dummy_entry(static_cast<unsigned char>(pointer)));
+    }
+    GDK_RUNTIME_ASSERT(cache.size() == 1);
+    const auto last = make_utxo(0, 4, script_type::ga_p2sh_p2wsh_fortified_out);
+    GDK_RUNTIME_ASSERT(has_dummy_entry(net_params, cache, last, 4));
+}
+
+static void test_scripts(const network_parameters& net_params)
+{
+    std::array<uint32_t, 32> gait_path;
+    for (size_t i = 0; i < gait_path.size(); ++i) {
+        gait_path[i] = static_cast<uint32_t>(i);
+    }
+    ga_pubkeys pubkeys(net_params, gait_path);
+    ga_user_pubkeys usr_pubkeys(net_params, make_xpub(CHAIN_CODE, USER_PUBKEY));
+    ga_user_pubkeys recovery_pubkeys(net_params);
+    usr_pubkeys.add_subaccount(1, make_xpub(CHAIN_CODE, USER_PUBKEY));
+    usr_pubkeys.add_subaccount(2, make_xpub(CHAIN_CODE, USER_PUBKEY));
+    recovery_pubkeys.add_subaccount(2, make_xpub(CHAIN_CODE, RECOVERY_PUBKEY)); // Subaccount 2 is 2of3
+
+    script_cache cache;
+    const uint32_t csv_blocks = net_params.csv_buckets().at(0);
+    nlohmann::json utxos = nlohmann::json::array();
+    for (uint32_t subaccount = 0; subaccount <= 2; ++subaccount) {
+        for (uint32_t pointer = 1; pointer <= 3; ++pointer) {
+            utxos.push_back(make_utxo(subaccount, pointer, script_type::ga_p2sh_fortified_out));
+            utxos.push_back(make_utxo(subaccount, pointer, script_type::ga_p2sh_p2wsh_fortified_out));
+            if (subaccount != 2) {
+                utxos.push_back(
+                    make_utxo(subaccount, pointer, script_type::ga_p2sh_p2wsh_csv_fortified_out, csv_blocks));
+            }
+        }
+    }
+
+    // Cached scripts match those derived directly, and each is computed once
+    for (const auto& utxo : utxos) {
+        GDK_RUNTIME_ASSERT(cache.find(net_params, utxo) == nullptr);
+        const auto& e = cache.get(net_params, pubkeys, usr_pubkeys, recovery_pubkeys, utxo);
+        const auto expected = output_script_from_utxo(net_params, pubkeys, usr_pubkeys, recovery_pubkeys, utxo);
+        GDK_RUNTIME_ASSERT(e.script == expected);
+        GDK_RUNTIME_ASSERT(e.pubkeys.size() == (utxo.at("subaccount") == 2 ? 3u : 2u));
+        GDK_RUNTIME_ASSERT(cache.find(net_params, utxo) == &e);
+        GDK_RUNTIME_ASSERT(&cache.get(net_params, pubkeys, usr_pubkeys, recovery_pubkeys, utxo) == &e);
+    }
+    GDK_RUNTIME_ASSERT(cache.size() == utxos.size());
+
+    // Filling derives the same scripts, skipping UTXOs that aren't multisig
+    script_cache filled;
+    auto fill_utxos = utxos;
+    fill_utxos.push_back(make_utxo(0, 1, script_type::ga_pubkey_hash_out));
+    fill_utxos.push_back(nlohmann::json{ { "txhash", std::string(64, '0') } });
+    filled.fill(net_params, pubkeys, usr_pubkeys, recovery_pubkeys, fill_utxos);
+    GDK_RUNTIME_ASSERT(filled.size() == utxos.size());
+    for (const auto& utxo : utxos) {
+        GDK_RUNTIME_ASSERT(filled.find(net_params, utxo)->script == cache.find(net_params, utxo)->script);
+    }
+}
+} // namespace
+
+int main()
+{
+    const network_parameters net_params{ network_parameters::get("testnet") };
+    test_keys(net_params);
+    test_limit(net_params);
+    test_scripts(net_params);
+    printf("script cache ok\n");
+    return 0;
+}
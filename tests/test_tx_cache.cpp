@@ -0,0 +1,62 @@
+#include "src/assertion.hpp"
+#include "src/tx_cache.hpp"
+#include <stdio.h>
+#include <string>
+
+// Test the raw tx cache evicts the least recently used txs to stay within
+// its size limit.
+
+using namespace ga::sdk;
+
+namespace {
+static std::string txhash(size_t i) { return std::string(63, '0') + std::to_string(i % 10); }
+
+static std::string tx_hex(size_t i) { return std::string(100, static_cast<char>('a' + i % 6)); }
+
+static bool is_cached(raw_tx_cache& cache, size_t i)
+{
+    const auto cached = cache.find(txhash(i));
+    GDK_RUNTIME_ASSERT(!cached || *cached == tx_hex(i));
+    return cached != nullptr;
+}
+} // namespace
+
+int main()
+{
+    raw_tx_cache cache(500); // Room for 5 txs
+
+    for (size_t i = 0; i < 5; ++i) {
+        cache.insert(txhash(i), tx_hex(i));
+    }
+    GDK_RUNTIME_ASSERT(cache.size() == 5 && cache.bytes() == 500);
+    for (size_t i = 0; i < 5; ++i) {
+        GDK_RUNTIME_ASSERT(is_cached(cache, i));
+    }
+
+    // Using tx 0 makes tx 1 the least recently used, so it is evicted first
+    GDK_RUNTIME_ASSERT(is_cached(cache, 0));
+    cache.insert(txhash(5), tx_hex(5));
+    GDK_RUNTIME_ASSERT(cache.size() == 5 && cache.bytes() == 500);
+    GDK_RUNTIME_ASSERT(!is_cached(cache, 1));
+    GDK_RUNTIME_ASSERT(is_cached(cache, 0) && is_cached(cache, 5));
+
+    // Re-inserting a cached tx doesn't duplicate it
+    cache.insert(txhash(2), tx_hex(2));
+    GDK_RUNTIME_ASSERT(cache.size() == 5 && cache.bytes() == 500);
+
+    // A larger tx evicts as many as needed, in least recently used order
+    cache.insert(txhash(6), std::string(250, 'f'));
+    GDK_RUNTIME_ASSERT(cache.size() == 3 && cache.bytes() == 450);
+    GDK_RUNTIME_ASSERT(!is_cached(cache, 3) && !is_cached(cache, 4) && !is_cached(cache, 0));
+    GDK_RUNTIME_ASSERT(is_cached(cache, 5) && is_cached(cache, 2));
+
+    // A tx larger than the cache is not cached
+    cache.insert(txhash(7), std::string(501, 'f'));
+    GDK_RUNTIME_ASSERT(!is_cached(cache, 7) && cache.size() == 3);
+
+    cache.clear();
+    GDK_RUNTIME_ASSERT(cache.size() == 0 && cache.bytes() == 0 && !is_cached(cache, 5));
+
+    printf("raw tx cache ok\n");
+    return 0;
+}
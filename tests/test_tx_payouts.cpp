@@ -0,0 +1,167 @@
+#include "src/assertion.hpp"
+#include "src/containers.hpp"
+#include "src/exception.hpp"
+#include "src/ga_strings.hpp"
+#include "src/ga_wally.hpp"
+#include "src/network_parameters.hpp"
+#include "src/transaction_utils.hpp"
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Test parsing and validating payouts for create_transaction: the scripts,
+// amounts and asset ids of each payout, the addressees set from them, and
+// the errors set for invalid payouts.
+
+using namespace ga::sdk;
+
+namespace {
+static const amount DUST_THRESHOLD(546);
+static const std::string P2WPKH_SCRIPT("0014ba5c4f6a2ba8b7f5c3f0a1b4bd0cb7a5e1f3cdd4");
+static const std::string PUBKEY("0279be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798");
+static const std::string ASSET_A(64, 'a');
+static const std::string ASSET_B(64, 'b');
+
+static std::string make_address(const network_parameters& net_params, unsigned char version, unsigned char fill)
+{
+    std::vector<unsigned char> addr_bytes{ version };
+    addr_bytes.insert(addr_bytes.end(), HASH160_LEN, fill);
+    const auto address = base58check_from_bytes(addr_bytes);
+    if (!net_params.is_liquid()) {
+        return address;
+    }
+    return confidential_addr_from_addr(address, net_params.blinded_prefix(), h2b(PUBKEY));
+}
+
+static std::vector<tx_payout> parse(
+    const network_parameters& net_params, nlohmann::json& result, const nlohmann::json& payouts)
+{
+    result["payouts"] = payouts;
+    return parse_tx_payouts(net_params, DUST_THRESHOLD, result);
+}
+
+static std::string parse_error(const network_parameters& net_params, const nlohmann::json& payouts)
+{
+    nlohmann::json result;
+    const auto parsed = parse(net_params, result, payouts);
+    GDK_RUNTIME_ASSERT(parsed.size() == payouts.size());
+    GDK_RUNTIME_ASSERT(result.at("addressees").size() == payouts.size());
+    for (const auto& payout : parsed) {
+        GDK_RUNTIME_ASSERT(!payout.script.empty()); // Invalid payouts get a dummy script
+    }
+    return json_get_value(result, "error");
+}
+
+static bool throws_user_error(const network_parameters& net_params, const nlohmann::json& payouts)
+{
+    try {
+        nlohmann::json result;
+        parse(net_params, result, payouts);
+    } catch (const user_error&) {
+        return true;
+    }
+    return false;
+}
+
+static void test_btc()
+{
+    const network_parameters net_params{ network_parameters::get("testnet") };
+    const auto p2pkh = make_address(net_params, net_params.btc_version(), 1);
+    const auto p2sh = make_address(net_params, net_params.btc_p2sh_version(), 2);
+
+    // Address and script payouts
+    nlohmann::json result;
+    const auto payouts = parse(net_params, result,
+        { { { "address", p2pkh }, { "satoshi", 1000 } }, { { "script", P2WPKH_SCRIPT }, { "satoshi", 2000 } },
+            { { "address", p2sh }, { "satoshi", 546 } } });
+    GDK_RUNTIME_ASSERT(json_get_value(result, "error").empty());
+    GDK_RUNTIME_ASSERT(payouts.size() == 3);
+    GDK_RUNTIME_ASSERT(payouts[0].address == p2pkh && payouts[0].satoshi == 1000);
+    GDK_RUNTIME_ASSERT(scriptpubkey_get_type(payouts[0].script) == WALLY_SCRIPT_TYPE_P2PKH);
+    GDK_RUNTIME_ASSERT(payouts[1].address.empty() && payouts[1].satoshi == 2000);
+    GDK_RUNTIME_ASSERT(payouts[1].script == h2b(P2WPKH_SCRIPT));
+    GDK_RUNTIME_ASSERT(scriptpubkey_get_type(payouts[2].script) == WALLY_SCRIPT_TYPE_P2SH);
+    for (const auto& payout : payouts) {
+        GDK_RUNTIME_ASSERT(payout.asset_id == "btc");
+    }
+    const auto& addressees = result.at("addressees");
+    GDK_RUNTIME_ASSERT(addressees.size() == 3);
+    GDK_RUNTIME_ASSERT(addressees[0] == nlohmann::json({ { "address", p2pkh }, { "satoshi", 1000 } }));
+    GDK_RUNTIME_ASSERT(addressees[1].at("script") == P2WPKH_SCRIPT && addressees[1].at("address") == "");
+
+    // Exactly one of address or script must be given
+    const auto both = nlohmann::json{ { "address", p2pkh }, { "script", P2WPKH_SCRIPT }, { "satoshi", 1000 } };
+    GDK_RUNTIME_ASSERT(parse_error(net_params, { both }) == res::id_invalid_address);
+    GDK_RUNTIME_ASSERT(parse_error(net_params, { { { "satoshi", 1000 } } }) == res::id_invalid_address);
+
+    // Scripts must be valid hex of a recognized output type
+    for (const auto& script : { "", "zz", "00", "51", "6a04deadbeef" }) {
+        const auto payout = nlohmann::json{ { "script", script }, { "satoshi", 1000 } };
+        GDK_RUNTIME_ASSERT(parse_error(net_params, { payout }) == res::id_invalid_address);
+    }
+    GDK_RUNTIME_ASSERT(parse_error(net_params, { { { "address", "notanaddress" }, { "satoshi", 1000 } } })
+        == res::id_invalid_address);
+
+    // Amounts must be non-negative integer satoshi above the dust threshold
+    for (const auto& satoshi : nlohmann::json{ -1, 1000.5, "1000", nullptr, 545 }) {
+        const auto payout = nlohmann::json{ { "address", p2pkh }, { "satoshi", satoshi } };
+        GDK_RUNTIME_ASSERT(parse_error(net_params, { payout }) == res::id_invalid_amount);
+    }
+    GDK_RUNTIME_ASSERT(parse_error(net_params, { { { "address", p2pkh } } }) == res::id_invalid_amount);
+
+    // Dust is allowed when sending all, as the amount is computed later
+    result = { { "send_all", true } };
+    parse(net_params, result, { { { "address", p2pkh }, { "satoshi", 0 } } });
+    GDK_RUNTIME_ASSERT(json_get_value(result, "error").empty());
+
+    // Assets cannot be used on Bitcoin
+    GDK_RUNTIME_ASSERT(
+        throws_user_error(net_params, { { { "address", p2pkh }, { "satoshi", 1000 }, { "asset_id", ASSET_A } } }));
+}
+
+static void test_liquid()
+{
+    const network_parameters net_params{ network_parameters::get("liquid") };
+    const auto address_1 = make_address(net_params, net_params.btc_p2sh_version(), 1);
+    const auto address_2 = make_address(net_params, net_params.btc_p2sh_version(), 2);
+    auto payout = [](const std::string& address, const std::string& asset_id) {
+        return nlohmann::json{ { "address", address }, { "satoshi", 1000 }, { "asset_id", asset_id } };
+    };
+
+    // Asset ids are carried over to following payouts only while unchanged
+    nlohmann::json result;
+    const auto payouts = parse(net_params, result,
+        { payout(address_1, ASSET_A), payout(address_2, ASSET_A), payout(address_1, ASSET_B),
+            payout(address_2, ASSET_A) });
+    GDK_RUNTIME_ASSERT(json_get_value(result, "error").empty());
+    const std::vector<std::string> expected{ ASSET_A, ASSET_A, ASSET_B, ASSET_A };
+    for (size_t i = 0; i < payouts.size(); ++i) {
+        GDK_RUNTIME_ASSERT(payouts[i].asset_id == expected[i]);
+        GDK_RUNTIME_ASSERT(result["addressees"][i].at("asset_id") == expected[i]);
+        GDK_RUNTIME_ASSERT(scriptpubkey_get_type(payouts[i].script) == WALLY_SCRIPT_TYPE_P2SH);
+    }
+
+    // An invalid or missing asset id is caught even after valid ones
+    GDK_RUNTIME_ASSERT(throws_user_error(net_params, { payout(address_1, ASSET_A), payout(address_2, "ab") }));
+    GDK_RUNTIME_ASSERT(throws_user_error(
+        net_params, { payout(address_1, ASSET_A), { { "address", address_2 }, { "satoshi", 1000 } } }));
+
+    // Scripts can't be blinded to, so are not allowed
+    const auto script_payout
+        = nlohmann::json{ { "script", P2WPKH_SCRIPT }, { "satoshi", 1000 }, { "asset_id", ASSET_A } };
+    GDK_RUNTIME_ASSERT(parse_error(net_params, { script_payout }) == res::id_nonconfidential_addresses_not);
+
+    // Nor can unconfidential addresses
+    const auto unconfidential = confidential_addr_to_addr(address_1, net_params.blinded_prefix());
+    GDK_RUNTIME_ASSERT(
+        parse_error(net_params, { payout(unconfidential, ASSET_A) }) == res::id_nonconfidential_addresses_not);
+}
+} // namespace
+
+int main()
+{
+    test_btc();
+    test_liquid();
+    printf("tx payouts ok\n");
+    return 0;
+}
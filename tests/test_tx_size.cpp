@@ -0,0 +1,81 @@
+#include "src/assertion.hpp"
+#include "src/ga_wally.hpp"
+#include "src/transaction_utils.hpp"
+#include <random>
+#include <stdio.h>
+#include <vector>
+
+// Randomized consistency test for incremental tx size tracking: after every
+// input or output added to a BTC tx, the length and weight from
+// tx_size_tracker must match those computed by wally from the whole tx.
+
+using namespace ga::sdk;
+
+namespace {
+static std::mt19937 rng(12345);
+
+static uint32_t random_uint(uint32_t max) { return std::uniform_int_distribution<uint32_t>(0, max)(rng); }
+
+static std::vector<unsigned char> random_script(uint32_t max_len)
+{
+    return std::vector<unsigned char>(random_uint(max_len), 0x51);
+}
+
+static void add_input(const wally_tx_ptr& tx)
+{
+    const std::vector<unsigned char> txhash(WALLY_TXHASH_LEN, 1);
+    if (random_uint(1) == 0) {
+        // Segwit, with a dummy multisig witness as create_transaction adds
+        auto wit = tx_witness_stack_init(4);
+        tx_witness_stack_add_dummy(wit, WALLY_TX_DUMMY_NULL);
+        tx_witness_stack_add_dummy(wit, WALLY_TX_DUMMY_SIG);
+        tx_witness_stack_add_dummy(wit, WALLY_TX_DUMMY_SIG_LOW_R);
+        tx_witness_stack_add(wit, random_script(300));
+        tx_add_raw_input(tx, txhash, 0, 0xFFFFFFFD, random_script(40), wit);
+    } else {
+        tx_add_raw_input(tx, txhash, 0, 0xFFFFFFFD, random_script(300));
+    }
+}
+
+static void check(const wally_tx_ptr& tx, tx_size_tracker& tracker)
+{
+    tracker.update(tx);
+    GDK_RUNTIME_ASSERT(tracker.length() == tx_get_length(tx, WALLY_TX_FLAG_USE_WITNESS));
+    GDK_RUNTIME_ASSERT(tracker.weight() == tx_get_weight(tx));
+    GDK_RUNTIME_ASSERT(tracker.vsize() == tx_get_vsize(tx));
+}
+} // namespace
+
+int main()
+{
+    for (size_t i = 0; i < 20; ++i) {
+        auto tx = tx_init(0, 8, 8);
+        tx_size_tracker tracker;
+        add_input(tx);
+        check(tx, tracker);
+        // Enough inputs and outputs for multi-byte input/output counts
+        for (size_t j = 0; j < 300; ++j) {
+            if (random_uint(3) == 0) {
+                tx_add_raw_output(tx, random_uint(100000), random_script(300));
+            } else {
+                add_input(tx);
+            }
+            check(tx, tracker);
+        }
+        // Reordering outputs does not change the size
+        if (tx->num_outputs > 1) {
+            std::swap(tx->outputs[0], tx->outputs[tx->num_outputs - 1]);
+            check(tx, tracker);
+        }
+    }
+
+    // Without any witness, no segwit marker is serialized
+    auto tx = tx_init(0, 1, 1);
+    tx_size_tracker tracker;
+    tx_add_raw_input(tx, std::vector<unsigned char>(WALLY_TXHASH_LEN, 1), 0, 0, random_script(100));
+    tx_add_raw_output(tx, 1000, random_script(30));
+    check(tx, tracker);
+
+    printf("tx size tracking ok\n");
+    return 0;
+}
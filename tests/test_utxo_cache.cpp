@@ -0,0 +1,199 @@
+#include "src/assertion.hpp"
+#include "src/utxo_cache.hpp"
+#include <algorithm>
+#include <map>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <stdio.h>
+#include <tuple>
+
+// Randomized consistency test for incremental UTXO cache updates: after
+// every new transaction, the cached UTXOs updated with apply_utxo_delta
+// must match what a full refetch from the server would return.
+
+using namespace ga::sdk;
+
+namespace {
+static std::mt19937 rng(12345);
+
+static uint32_t random_uint(uint32_t max) { return std::uniform_int_distribution<uint32_t>(0, max)(rng); }
+
+struct model_wallet {
+    std::map<utxo_ref_t, nlohmann::json> utxos; // Ground truth
+    uint32_t block_height = 1;
+    uint32_t next_tx = 0;
+
+    std::string new_txhash()
+    {
+        char buf[65];
+        snprintf(buf, sizeof(buf), "%064x", ++next_tx);
+        return buf;
+    }
+
+    nlohmann::json make_utxo(const std::string& txhash, uint32_t pt_idx, uint32_t height) const
+    {
+        const std::string asset = random_uint(3) == 0 ? "asset_b" : "asset_a";
+        return { { "txhash", txhash }, { "pt_idx", pt_idx }, { "block_height", height }, { "asset_id", asset },
+            { "satoshi", 1 + random_uint(100000) } };
+    }
+
+    // Equivalent of txs.get_all_unspent_outputs + process_unspent_outputs
+    nlohmann::json full_refetch(uint32_t num_confs) const
+    {
+        nlohmann::json asset_utxos = nlohmann::json::object();
+        for (const auto& u : utxos) {
+            if (num_confs == 0 || u.second["block_height"] != 0) {
+                asset_utxos[u.second["asset_id"].get<std::string>()].push_back(u.second);
+            }
+        }
+        sort_asset_utxos(asset_utxos);
+        return asset_utxos;
+    }
+};
+
+// Server ordering of UTXOs with the same sort key is unspecified
+static nlohmann::json canonical(nlohmann::json asset_utxos)
+{
+    for (auto& utxos : asset_utxos) {
+        std::sort(utxos.begin(), utxos.end(), [](const nlohmann::json& lhs, const nlohmann::json& rhs) {
+            const auto key = [](const nlohmann::json& u) {
+                const uint32_t height = u["block_height"];
+                return std::make_tuple(height == 0 ? 0xffffffff : height, u["txhash"].get<std::string>(),
+                    u["pt_idx"].get<uint32_t>());
+            };
+            return key(lhs) < key(rhs);
+        });
+    }
+    return asset_utxos;
+}
+
+static void check_sorted(const nlohmann::json& asset_utxos)
+{
+    for (const auto& utxos : asset_utxos) {
+        uint32_t last = 0;
+        bool seen_unconfirmed = false;
+        for (const auto& u : utxos) {
+            const uint32_t height = u["block_height"];
+            GDK_RUNTIME_ASSERT(!seen_unconfirmed || height == 0);
+            seen_unconfirmed |= height == 0;
+            GDK_RUNTIME_ASSERT(height == 0 || height >= last);
+            last = height;
+        }
+    }
+}
+// Check the conversion of tx list endpoints into UTXOs and spent outputs
+static void test_utxos_from_tx_endpoints()
+{
+    const nlohmann::json tx = { { "txhash", "aa" }, { "block_height", 100 },
+        { "eps",
+            {
+                // Spent from subaccount 1
+                { { "is_output", false }, { "is_relevant", true }, { "subaccount", 1 }, { "prevtxhash", "bb" },
+                    { "previdx", 3 } },
+                // Spent from another subaccount
+                { { "is_output", false }, { "is_relevant", true }, { "subaccount", 2 }, { "prevtxhash", "cc" },
+                    { "previdx", 0 } },
+                // Created for subaccount 1
+                { { "id", 7 }, { "is_credit", true }, { "is_output", true }, { "is_relevant", true },
+                    { "ad", "addr" }, { "subaccount", 1 }, { "pubkey_pointer", 42 }, { "pt_idx", 0 },
+                    { "satoshi", 1000 } },
+                // Created for subaccount 1, without a pointer
+                { { "is_output", true }, { "is_relevant", true }, { "subaccount", 1 }, { "pubkey_pointer", nullptr },
+                    { "pt_idx", 1 }, { "satoshi", 2000 } },
+                // Not ours
+                { { "is_output", true }, { "is_relevant", false }, { "subaccount", 1 }, { "pt_idx", 2 } },
+            } } };
+
+    std::vector<utxo_ref_t> spent;
+    const auto created = utxos_from_tx_endpoints(tx, 1, spent);
+    GDK_RUNTIME_ASSERT(spent.size() == 1 && spent[0] == utxo_ref_t("bb", 3));
+    GDK_RUNTIME_ASSERT(created.size() == 2);
+
+    const nlohmann::json expected = { { "subaccount", 1 }, { "pointer", 42 }, { "pt_idx", 0 }, { "satoshi", 1000 },
+        { "txhash", "aa" }, { "block_height", 100 } };
+    GDK_RUNTIME_ASSERT(created[0] == expected);
+    GDK_RUNTIME_ASSERT(created[1]["pointer"] == 0 && created[1]["pt_idx"] == 1);
+    GDK_RUNTIME_ASSERT(!created[1].contains("pubkey_pointer") && !created[1].contains("is_output"));
+
+    // Unconfirmed txs have no block height; subaccount 0 may be omitted
+    const nlohmann::json unconfirmed
+        = { { "txhash", "dd" }, { "eps", { { { "is_output", true }, { "is_relevant", true }, { "pt_idx", 0 } } } } };
+    spent.clear();
+    const auto created_unconfirmed = utxos_from_tx_endpoints(unconfirmed, 0, spent);
+    GDK_RUNTIME_ASSERT(spent.empty() && created_unconfirmed.size() == 1);
+    GDK_RUNTIME_ASSERT(created_unconfirmed[0]["block_height"] == 0 && created_unconfirmed[0]["subaccount"] == 0);
+    GDK_RUNTIME_ASSERT(created_unconfirmed[0]["pointer"] == 0);
+}
+} // namespace
+
+int main()
+{
+    test_utxos_from_tx_endpoints();
+
+    model_wallet wallet;
+    nlohmann::json cache[2] = { wallet.full_refetch(0), wallet.full_refetch(1) };
+    size_t applied = 0, refetched = 0;
+
+    for (size_t i = 0; i < 5000; ++i) {
+        const uint32_t op = random_uint(9);
+        std::vector<utxo_ref_t> spent;
+        nlohmann::json created_list = nlohmann::json::array();
+
+        if (op == 0) {
+            // A block confirms all unconfirmed UTXOs. The server notifies
+            // each confirmed tx again, this time with a block height
+            ++wallet.block_height;
+            for (auto& u : wallet.utxos) {
+                if (u.second["block_height"] == 0) {
+                    u.second["block_height"] = wallet.block_height;
+                    created_list.push_back(u.second);
+                }
+            }
+        } else if (op == 1 && !wallet.utxos.empty()) {
+            // A notification for a tx we have already applied
+            created_list.push_back(std::next(wallet.utxos.begin(), random_uint(wallet.utxos.size() - 1))->second);
+        } else if (op == 2) {
+            // A tx spending an output we don't know about (e.g. a replacement)
+            spent.emplace_back(wallet.new_txhash(), 0);
+        } else {
+            // A new tx spending some of our UTXOs and creating new ones
+            for (auto p = wallet.utxos.begin(); p != wallet.utxos.end();) {
+                if (random_uint(7) == 0) {
+                    spent.push_back(p->first);
+                    p = wallet.utxos.erase(p);
+                } else {
+                    ++p;
+                }
+            }
+            const auto txhash = wallet.new_txhash();
+            const uint32_t num_outputs = random_uint(3);
+            for (uint32_t vout = 0; vout < num_outputs; ++vout) {
+                auto utxo = wallet.make_utxo(txhash, vout, 0);
+                wallet.utxos.emplace(utxo_ref_t{ txhash, vout }, utxo);
+                created_list.push_back(utxo);
+            }
+        }
+
+        nlohmann::json created = nlohmann::json::object();
+        for (const auto& u : created_list) {
+            created[u["asset_id"].get<std::string>()].push_back(u);
+        }
+
+        for (const uint32_t num_confs : { 0u, 1u }) {
+            const auto expected = wallet.full_refetch(num_confs);
+            if (apply_utxo_delta(cache[num_confs], num_confs, spent, created)) {
+                GDK_RUNTIME_ASSERT(canonical(cache[num_confs]) == canonical(expected));
+                check_sorted(cache[num_confs]);
+                ++applied;
+            } else {
+                cache[num_confs] = expected;
+                ++refetched;
+            }
+        }
+    }
+
+    // Most txs should be applied incrementally
+    GDK_RUNTIME_ASSERT(applied > refetched * 2);
+    printf("applied %zu, refetched %zu\n", applied, refetched);
+    return 0;
+}
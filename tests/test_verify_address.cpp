@@ -0,0 +1,169 @@
+#include "src/assertion.hpp"
+#include "src/executor.hpp"
+#include "src/ga_wally.hpp"
+#include "src/memory.hpp"
+#include "src/network_parameters.hpp"
+#include "src/transaction_utils.hpp"
+#include "src/xpub_hdkey.hpp"
+#include <functional>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+// Test verifying server generated addresses against locally derived scripts,
+// in parallel batches as when fetching or listing addresses.
+
+using namespace ga::sdk;
+
+namespace {
+using scripts_t = std::vector<std::vector<unsigned char>>;
+
+static const size_t NUM_ADDRESSES = 200;
+static const size_t MIN_ADDRESSES_PER_THREAD = 32;
+static const std::string CHAIN_CODE(std::string(63, '0') + "1");
+static const std::string GA_PUBKEY("0279be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798");
+static const std::string USER_PUBKEY("02c6047f9441ed7d6d3045406e95c07cd85c778e4b8cef3ca7abac09b95c709ee5");
+
+static script_type get_script_type(const std::string& addr_type)
+{
+    if (addr_type == address_type::p2sh) {
+        return script_type::ga_p2sh_fortified_out;
+    }
+    if (addr_type == address_type::p2wsh) {
+        return script_type::ga_p2sh_p2wsh_fortified_out;
+    }
+    return script_type::ga_p2sh_p2wsh_csv_fortified_out;
+}
+
+// Make an address as returned by the server, along with its locally derived script
+static nlohmann::json make_address(const network_parameters& net_params, const std::string& addr_type,
+    uint32_t pointer, uint32_t csv_blocks, scripts_t& scripts)
+{
+    const xpub_hdkey ga(net_params.is_main_net(), make_xpub(CHAIN_CODE, GA_PUBKEY));
+    const xpub_hdkey user(net_params.is_main_net(), make_xpub(CHAIN_CODE, USER_PUBKEY));
+    const script_type type = get_script_type(addr_type);
+    const uint32_t subtype = addr_type == address_type::csv ? csv_blocks : 0;
+    const auto script
+        = output_script(net_params, ga.derive(pointer), user.derive(pointer), empty_span(), type, subtype);
+    scripts.emplace_back(script);
+    return { { "address_type", addr_type }, { "script_type", type }, { "pointer", pointer },
+        { "script", b2h(script) } };
+}
+
+static void verify_batch(const network_parameters& net_params, nlohmann::json& addresses, const scripts_t* scripts,
+    bool is_historic, uint32_t csv_blocks, const std::vector<uint32_t>& csv_buckets)
+{
+    parallel_for(addresses.size(), MIN_ADDRESSES_PER_THREAD, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const auto user_script = scripts ? &scripts->at(i) : nullptr;
+            verify_address(net_params, addresses[i], user_script, is_historic, csv_blocks, csv_buckets);
+        }
+    });
+}
+
+static bool throws(const std::function<void()>& fn)
+{
+    try {
+        fn();
+    } catch (const std::exception&) {
+        return true;
+    }
+    return false;
+}
+
+static void test_btc()
+{
+    const network_parameters net_params{ network_parameters::get("testnet") };
+    const auto& csv_buckets = net_params.csv_buckets();
+    const uint32_t csv_blocks = csv_buckets.at(0);
+    const std::vector<std::string> addr_types{ address_type::p2sh, address_type::p2wsh, address_type::csv };
+
+    scripts_t scripts;
+    nlohmann::json addresses = nlohmann::json::array();
+    for (uint32_t pointer = 1; pointer <= NUM_ADDRESSES; ++pointer) {
+        const auto& addr_type = addr_types[pointer % addr_types.size()];
+        addresses.push_back(make_address(net_params, addr_type, pointer, csv_blocks, scripts));
+    }
+
+    // New addresses are verified and given their address
+    auto verified = addresses;
+    verify_batch(net_params, verified, &scripts, false, csv_blocks, {});
+    for (size_t i = 0; i < NUM_ADDRESSES; ++i) {
+        const std::string addr_type = verified[i].at("address_type");
+        GDK_RUNTIME_ASSERT(verified[i].at("script") == b2h(scripts[i]));
+        GDK_RUNTIME_ASSERT(verified[i].at("address") == get_address_from_script(net_params, scripts[i], addr_type));
+        GDK_RUNTIME_ASSERT(!verified[i].contains("blinding_script"));
+    }
+
+    // Addresses without scripts are given the locally derived script, and
+    // any address given must match it
+    auto unscripted = verified;
+    for (auto& address : unscripted) {
+        address.erase("script");
+    }
+    verify_batch(net_params, unscripted, &scripts, true, csv_blocks, csv_buckets);
+    GDK_RUNTIME_ASSERT(unscripted == verified);
+
+    // A single mismatched script or address fails the batch, whichever thread verifies it
+    for (size_t i : { size_t(0), NUM_ADDRESSES / 2, NUM_ADDRESSES - 1 }) {
+        auto bad_script = addresses;
+        bad_script[i]["script"] = b2h(scripts[(i + 1) % NUM_ADDRESSES]);
+        GDK_RUNTIME_ASSERT(throws([&] { verify_batch(net_params, bad_script, &scripts, false, csv_blocks, {}); }));
+
+        auto bad_address = verified;
+        bad_address[i]["address"] = verified[(i + 1) % NUM_ADDRESSES]["address"];
+        GDK_RUNTIME_ASSERT(throws([&] { verify_batch(net_params, bad_address, &scripts, false, csv_blocks, {}); }));
+    }
+
+    // New csv addresses must use the current csv blocks, historic ones any known bucket
+    auto csv = addresses;
+    const uint32_t other_csv_blocks = csv_buckets.at(1);
+    GDK_RUNTIME_ASSERT(throws([&] { verify_batch(net_params, csv, &scripts, false, other_csv_blocks, {}); }));
+    csv = addresses;
+    verify_batch(net_params, csv, &scripts, true, other_csv_blocks, csv_buckets);
+    csv = addresses;
+    const std::vector<uint32_t> other_buckets{ other_csv_blocks };
+    GDK_RUNTIME_ASSERT(throws([&] { verify_batch(net_params, csv, &scripts, true, other_csv_blocks, other_buckets); }));
+
+    // Watch only sessions can't derive scripts, so take the servers address
+    auto watch_only = addresses;
+    watch_only[0]["address"] = verified[1]["address"];
+    verify_batch(net_params, watch_only, nullptr, false, csv_blocks, {});
+    GDK_RUNTIME_ASSERT(watch_only == verified);
+}
+
+static void test_liquid()
+{
+    const network_parameters net_params{ network_parameters::get("liquid") };
+    const uint32_t csv_blocks = net_params.csv_buckets().at(0);
+
+    scripts_t scripts;
+    nlohmann::json addresses = nlohmann::json::array();
+    for (uint32_t pointer = 1; pointer <= NUM_ADDRESSES; ++pointer) {
+        const auto& addr_type = pointer % 2 ? address_type::p2wsh : address_type::csv;
+        addresses.push_back(make_address(net_params, addr_type, pointer, csv_blocks, scripts));
+    }
+
+    // Liquid addresses are given the script to derive their blinding key from
+    verify_batch(net_params, addresses, &scripts, false, csv_blocks, {});
+    for (size_t i = 0; i < NUM_ADDRESSES; ++i) {
+        const auto witness_program = witness_program_from_bytes(scripts[i], WALLY_SCRIPT_SHA256);
+        const auto blinding_script = scriptpubkey_p2sh_from_hash160(hash160(witness_program));
+        GDK_RUNTIME_ASSERT(addresses[i].at("blinding_script") == b2h(blinding_script));
+    }
+
+    // Only segwit addresses are supported
+    scripts.clear();
+    nlohmann::json p2sh = nlohmann::json::array();
+    p2sh.push_back(make_address(net_params, address_type::p2sh, 1, csv_blocks, scripts));
+    GDK_RUNTIME_ASSERT(throws([&] { verify_batch(net_params, p2sh, &scripts, false, csv_blocks, {}); }));
+}
+} // namespace
+
+int main()
+{
+    test_btc();
+    test_liquid();
+    printf("verify address ok\n");
+    return 0;
+}